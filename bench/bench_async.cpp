@@ -0,0 +1,78 @@
+// Synchronous stepping vs AsyncVecEnv double-buffering, with agent
+// inference simulated by a fixed busy-wait on the main thread.
+// Build: mingw32-make bench   Run: build/bench_async [threads] [pin: 0/1]
+
+#include "AsyncVecEnv.h"
+#include "PerfCounters.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using Sim = Simulation<Board<20, 20>, ClassicRules>;
+
+static const int GAMES_PER_SLOT = 512;
+static const int INFERENCE_MICROS = 400;
+static const int BATCHES = 2000;
+
+// Reads every shard of the slot (one per NUMA node on a pinned pool)
+static void FakeInference(const AsyncVecEnv<Sim, uint8_t>& env, int slot, Direction* actions) {
+    auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(INFERENCE_MICROS);
+    uint32_t h = 0;
+    for (int shard = 0; shard < env.Shards(); shard++) {
+        const uint8_t* observations = env.GetObservations(slot, shard);
+        for (int i = 0; i < env.GetShardSize(shard); i++) {
+            h = h * 31 + observations[(size_t)i * OBS_CHANNEL_COUNT * 400];
+            actions[env.GetShardBegin(shard) + i] = static_cast<Direction>((h >> 7) & 3);
+        }
+    }
+    while (std::chrono::steady_clock::now() < until) {
+    }
+}
+
+static double Seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    int threads = argc > 1 ? std::atoi(argv[1]) : (int)std::thread::hardware_concurrency();
+    if (threads < 1) threads = 1;
+    ThreadPool pool(threads, argc > 2 && std::atoi(argv[2]) != 0);
+    AsyncVecEnv<Sim, uint8_t> env(pool, GAMES_PER_SLOT, 1);
+    std::vector<Direction> actions[2] = {std::vector<Direction>(GAMES_PER_SLOT, RIGHT),
+                                         std::vector<Direction>(GAMES_PER_SLOT, RIGHT)};
+
+    // Synchronous: step, then infer, one after the other
+    auto start = std::chrono::steady_clock::now();
+    for (int k = 0; k < BATCHES; k++) {
+        int slot = k & 1;
+        env.StepAsync(slot, actions[slot].data());
+        env.StepWait(slot);
+        FakeInference(env, slot, actions[slot].data());
+    }
+    double syncSeconds = Seconds(start);
+
+    // Async: inference on one slot overlaps stepping of the other
+    start = std::chrono::steady_clock::now();
+    for (int k = 0; k < BATCHES; k++) {
+        int slot = k & 1;
+        env.StepWait(slot);
+        FakeInference(env, slot, actions[slot].data());
+        env.StepAsync(slot, actions[slot].data());
+    }
+    env.StepWait(0);
+    env.StepWait(1);
+    double asyncSeconds = Seconds(start);
+
+    double steps = (double)BATCHES * GAMES_PER_SLOT;
+    printf("threads %d, %d games/slot in %d shard(s), %d us inference per batch\n", threads, GAMES_PER_SLOT,
+           env.Shards(), INFERENCE_MICROS);
+    printf("sync   %8.2f Msteps/s  %8.1f us/batch\n", steps / syncSeconds / 1e6, syncSeconds * 1e6 / BATCHES);
+    printf("async  %8.2f Msteps/s  %8.1f us/batch\n", steps / asyncSeconds / 1e6, asyncSeconds * 1e6 / BATCHES);
+    printf("overlap gain %.2fx\n", syncSeconds / asyncSeconds);
+#ifdef SNAKE_PERF_COUNTERS
+    PerfRegions::Report(stdout);
+#endif
+    return 0;
+}
@@ -0,0 +1,171 @@
+// Scalar Simulation stepping vs BatchSimulation lockstep lanes, after a
+// check that every lane matches a scalar Simulation tick for tick.
+// Build: mingw32-make bench   Run: build/bench_batch [lockstep ticks]
+//
+// Measured on one shared core: about 1.6x scalar at x8 and 1.9x at x16
+// with AVX-512 (gathers and scatters), about 1.5x with AVX2 (gathers,
+// scalar stores). Without either the column loops run one lane at a time
+// and the batch is no faster than the scalar loop.
+
+#include "BatchSimulation.h"
+#include "PerfCounters.h"
+#include "Simulation.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using Sim = Simulation<Board<40, 30>>;
+
+static Direction NextAction(uint32_t& state, Direction current) {
+    state = state * 1664525u + 1013904223u;
+    if ((state >> 29) != 0) return current;
+    return static_cast<Direction>((state >> 27) & 3);
+}
+
+static double Seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Steers clear of walls and the body so games live long enough to collect
+// power-ups, but drives straight through itself while invincible
+static Direction SafeAction(uint32_t& state, const Sim& game) {
+    state = state * 1664525u + 1013904223u;
+    const Board<40, 30>& board = game.GetBoard();
+    int head = game.GetHeadCell();
+    bool invincible = game.HasActivePowerUp(INVINCIBILITY);
+    for (int i = 0; i < 4; i++) {
+        Direction dir = i == 0 && (state >> 29) != 0 ? game.GetDirection()
+                                                     : static_cast<Direction>(((state >> 27) + i) & 3);
+        int x = board.X(head) + (dir == RIGHT) - (dir == LEFT);
+        int y = board.Y(head) + (dir == DOWN) - (dir == UP);
+        if (x < 0 || x >= board.Width() || y < 0 || y >= board.Height()) continue;
+        if (invincible || !board.Test(board.Index(x, y))) return dir;
+    }
+    return game.GetDirection();
+}
+
+// Runs every lane next to a scalar game with the same seed and actions;
+// lanes restart with a fresh seed on death or divergence
+template <int LANES>
+static uint64_t Lockstep(uint64_t steps, uint64_t& invincibleTicks) {
+    static BatchSimulation<40, 30, LANES> batch;
+    std::vector<Sim> games(LANES);
+    uint32_t agent = 777;
+    uint64_t seed = 1000;
+    uint64_t divergences = 0;
+    Direction actions[LANES];
+
+    for (int lane = 0; lane < LANES; lane++) {
+        batch.ResetLane(lane, seed);
+        games[lane].Reset(seed++);
+    }
+    for (uint64_t t = 0; t < steps; t++) {
+        for (int lane = 0; lane < LANES; lane++) {
+            actions[lane] = SafeAction(agent, games[lane]);
+            invincibleTicks += games[lane].HasActivePowerUp(INVINCIBILITY);
+        }
+        batch.Step(actions);
+        for (int lane = 0; lane < LANES; lane++) {
+            Sim& game = games[lane];
+            game.Step(actions[lane]);
+            bool same = batch.IsAlive(lane) == game.IsAlive() && batch.GetScore(lane) == game.GetScore() &&
+                        batch.GetLength(lane) == game.GetLength() && batch.GetDirection(lane) == game.GetDirection() &&
+                        batch.GetFoodCell(lane) == game.GetFoodCell() &&
+                        batch.GetPowerUpCell(lane) == game.GetPowerUpCell() &&
+                        (!game.IsAlive() || batch.GetHeadCell(lane) == game.GetHeadCell());
+            // The cell a tail left is where an overlap miscount would show;
+            // the whole board is compared now and then
+            int tail = game.GetLastRemovedTail();
+            same = same && (tail < 0 || batch.IsOccupied(lane, tail) == game.GetBoard().Test(tail));
+            for (int cell = 0; same && t % 64 == 0 && cell < game.GetBoard().Cells(); cell++) {
+                same = batch.IsOccupied(lane, cell) == game.GetBoard().Test(cell);
+            }
+            divergences += !same;
+            if (!game.IsAlive() || !same) {
+                batch.ResetLane(lane, seed);
+                game.Reset(seed++);
+            }
+        }
+    }
+    return divergences;
+}
+
+template <int LANES>
+static double RunScalar(uint64_t steps) {
+    std::vector<Sim> games(LANES);
+    uint32_t agent = 12345;
+    uint64_t seed = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t t = 0; t < steps; t++) {
+        for (int lane = 0; lane < LANES; lane++) {
+            if (!games[lane].Step(NextAction(agent, games[lane].GetDirection()))) {
+                games[lane].Reset(seed++);
+            }
+        }
+    }
+    return steps * LANES / Seconds(start) / 1e6;
+}
+
+template <int LANES>
+static double RunBatch(uint64_t steps) {
+    static BatchSimulation<40, 30, LANES> batch;
+    uint32_t agent = 12345;
+    uint64_t seed = 0;
+    Direction actions[LANES];
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t t = 0; t < steps; t++) {
+        for (int lane = 0; lane < LANES; lane++) {
+            actions[lane] = NextAction(agent, batch.GetDirection(lane));
+        }
+        uint32_t aliveMask = batch.Step(actions);
+        for (int lane = 0; lane < LANES; lane++) {
+            if (!((aliveMask >> lane) & 1)) batch.ResetLane(lane, seed++);
+        }
+    }
+    return steps * LANES / Seconds(start) / 1e6;
+}
+
+// Best of a few alternating runs, so a noisy neighbour on a shared host
+// does not decide the ratio
+template <int LANES>
+static void Compare(uint64_t steps) {
+    double scalar = 0.0;
+    double batch = 0.0;
+    for (int run = 0; run < 3; run++) {
+        scalar = std::max(scalar, RunScalar<LANES>(steps));
+        batch = std::max(batch, RunBatch<LANES>(steps));
+    }
+    printf("scalar  x%-2d  %8.2f Mticks/s\n", LANES, scalar);
+    printf("batch   x%-2d  %8.2f Mticks/s  (%.2fx scalar)\n", LANES, batch, batch / scalar);
+}
+
+int main(int argc, char** argv) {
+    uint64_t lockstepTicks = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+#if defined(__AVX512F__)
+    printf("gather: AVX-512 (16 lanes per gather and scatter)\n");
+#elif defined(__AVX2__)
+    printf("gather: AVX2 (8 lanes per gather, scalar stores)\n");
+#else
+    printf("gather: scalar (build with -mavx2 or -march=native)\n");
+#endif
+
+    uint64_t invincible8 = 0;
+    uint64_t invincible16 = 0;
+    uint64_t divergences = Lockstep<8>(lockstepTicks, invincible8) + Lockstep<16>(lockstepTicks, invincible16);
+    printf("check:  x8 and x16 lanes vs Simulation, %llu lane ticks (%llu invincible), %llu divergences\n",
+           (unsigned long long)(lockstepTicks * 24), (unsigned long long)(invincible8 + invincible16),
+           (unsigned long long)divergences);
+    if (divergences > 0) return 1;
+
+    const uint64_t steps = 1000000;
+    Compare<8>(steps);
+    Compare<16>(steps / 2);
+#ifdef SNAKE_PERF_COUNTERS
+    PerfRegions::Report(stdout);
+#endif
+    return 0;
+}
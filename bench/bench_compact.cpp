@@ -0,0 +1,118 @@
+// One million concurrent 20x20 games packed into a single arena, after a
+// lockstep check of the record against Simulation<Board<20,20>>.
+// Build: mingw32-make bench   Run: build/bench_compact [games] [ticks] [lockstep ticks]
+
+#include "CompactGame.h"
+#include "PerfCounters.h"
+#include "Simulation.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using Game = CompactGame<20, 20>;
+using Sim = Simulation<Board<20, 20>, ClassicRules>;
+
+static bool SameState(const Game& game, const Sim& sim) {
+    if (game.IsAlive() != sim.IsAlive()) return false;
+    if (!game.IsAlive()) return true;
+    if (game.score != sim.GetScore() || game.head != sim.GetHeadCell() || game.GetLength() != sim.GetLength() ||
+        (game.food == Game::NONE ? -1 : game.food) != sim.GetFoodCell() ||
+        (game.powerUp == Game::NONE ? -1 : game.powerUp) != sim.GetPowerUpCell()) return false;
+    for (int cell = 0; cell < Game::CELLS; cell++) {
+        if (game.Test(cell) != sim.GetBoard().Test(cell)) return false;
+    }
+    return true;
+}
+
+// Both start from the same seed and get the same actions. Every 40 ticks
+// both grow and turn invincible for a while, so that random play runs
+// through its own body and exercises the overlap bookkeeping of PopTail.
+static uint64_t Lockstep(uint64_t ticks, uint64_t& invincibleTicks) {
+    Game game;
+    Sim sim;
+    SimulationKeyframe frame;
+    std::vector<int> cells;
+    uint64_t seed = 1;
+    uint32_t agent = 777;
+    uint64_t divergences = 0;
+    game.Reset(seed);
+    sim.Reset(seed);
+
+    for (uint64_t t = 0; t < ticks; t++) {
+        if (game.tick % 40 == 39) {
+            int growth = Game::CELLS - game.GetLength();
+            growth = growth < 8 ? growth : 8;
+            game.activeTicks[INVINCIBILITY] = Sim::POWERUP_DURATION_TICKS;
+            game.pendingGrowth += growth;
+            sim.SaveKeyframe(frame, cells);
+            frame.activeTicks[INVINCIBILITY] = Sim::POWERUP_DURATION_TICKS;
+            frame.pendingGrowth += growth;
+            if (!sim.LoadKeyframe(frame, cells.data())) divergences++;
+        }
+        invincibleTicks += game.activeTicks[INVINCIBILITY] > 0;
+
+        agent = agent * 1664525u + 1013904223u;
+        Direction action = (agent >> 30) ? game.GetDirection() : static_cast<Direction>((agent >> 27) & 3);
+        game.Step(action);
+        sim.Step(action);
+
+        bool same = SameState(game, sim);
+        divergences += !same;
+        if (!game.IsAlive() || !sim.IsAlive() || !same) {
+            seed++;
+            game.Reset(seed);
+            sim.Reset(seed);
+        }
+    }
+    return divergences;
+}
+
+int main(int argc, char** argv) {
+    size_t games = argc > 1 ? (size_t)std::atoll(argv[1]) : 1000000;
+    int ticks = argc > 2 ? std::atoi(argv[2]) : 100;
+    uint64_t lockstepTicks = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 2000000;
+
+    uint64_t invincibleTicks = 0;
+    uint64_t divergences = Lockstep(lockstepTicks, invincibleTicks);
+    printf("check:  %llu ticks in lockstep with Simulation (%llu invincible), %llu divergences\n",
+           (unsigned long long)lockstepTicks, (unsigned long long)invincibleTicks,
+           (unsigned long long)divergences);
+
+    auto start = std::chrono::steady_clock::now();
+    CompactArena<20, 20> arena(games, 1);
+    double setup = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    size_t simulationBytes = sizeof(Simulation<Board<20, 20>>) + 20 * 20 * sizeof(int);
+    printf("record: %zu bytes/game (Simulation<Board<20,20>>: %zu bytes incl. body ring)\n",
+           CompactArena<20, 20>::RecordBytes(), simulationBytes);
+    printf("arena:  %zu games, %.1f MB, created in %.2f s\n",
+           arena.Size(), arena.FootprintBytes() / (1024.0 * 1024.0), setup);
+
+    std::vector<Direction> actions(games, RIGHT);
+    uint32_t agent = 12345;
+    size_t deaths = 0;
+
+    PerfCounters& counters = PerfCounters::ForThread();
+    PerfSample before = counters.Read();
+    start = std::chrono::steady_clock::now();
+    for (int t = 0; t < ticks; t++) {
+        for (size_t i = 0; i < games; i++) {
+            agent = agent * 1664525u + 1013904223u;
+            Direction current = arena.Get(i).GetDirection();
+            actions[i] = (agent >> 29) ? current : static_cast<Direction>((agent >> 27) & 3);
+        }
+        deaths += arena.StepRange(0, games, actions.data());
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    PerfSample after = counters.Read();
+
+    printf("step:   %d ticks x %zu games, %.2f Mticks/s, %zu deaths (auto-reset)\n",
+           ticks, games, ticks * (double)games / seconds / 1e6, deaths);
+    if (counters.IsAvailable()) {
+        printf("        ");
+        PerfCounters::PrintPer(stdout, after - before, (uint64_t)ticks * games, "tick");
+        printf("\n");
+    }
+    return divergences == 0 ? 0 : 1;
+}
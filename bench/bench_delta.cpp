@@ -0,0 +1,144 @@
+// Tick-server state diffs on a crowded shared board: bytes and encode cost
+// per tick against a full snapshot every tick, then a spectator stream
+// (diffs + periodic keyframes) decoded from the start and checked against
+// the world.
+// Build: mingw32-make bench   Run: build/bench_delta [snakes] [ticks] [keyframe interval]
+
+#include "WorldView.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static double Seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Keeps going unless the next cell is a wall or a body, turns now and then
+static void Steer(SnakeWorld& world, int id, uint32_t& rng) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+
+    const DynamicBoard& board = world.GetBoard();
+    int head = world.GetHeadCell(id);
+    Direction dir = world.GetDirection(id);
+    int ahead = board.Neighbor(head, dir);
+    if (ahead >= 0 && !world.IsOccupied(ahead) && (rng & 31) != 0) return;
+
+    Direction turns[2];
+    turns[0] = dir == UP || dir == DOWN ? LEFT : UP;
+    turns[1] = dir == UP || dir == DOWN ? RIGHT : DOWN;
+    int first = (rng >> 8) & 1;
+    for (int i = 0; i < 2; i++) {
+        Direction turn = turns[first ^ i];
+        int next = board.Neighbor(head, turn);
+        if (next >= 0 && !world.IsOccupied(next)) {
+            world.SetDirection(id, turn);
+            return;
+        }
+    }
+}
+
+static bool ViewMatches(const WorldView& view, const SnakeWorld& world) {
+    if (view.GetTick() != (uint32_t)world.GetTick() || view.GetPowerUpCell() != world.GetPowerUpCell()) return false;
+    for (int i = 0; i < world.GetFoodCount(); i++) {
+        if (view.GetFoodCell(i) != world.GetFoodCell(i)) return false;
+    }
+    for (int id = 0; id < world.GetMaxSnakes(); id++) {
+        if (view.IsActive(id) != world.IsActive(id)) return false;
+        if (!world.IsActive(id)) continue;
+        if (view.IsAlive(id) != world.IsAlive(id) || view.GetScore(id) != world.GetScore(id) ||
+            view.GetBodySize(id) != world.GetBodySize(id)) return false;
+        for (int i = 0; i < world.GetBodySize(id); i++) {
+            if (view.GetBodyCell(id, i) != world.GetBodyCell(id, i)) return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    int snakes = argc > 1 ? std::atoi(argv[1]) : 400;
+    int ticks = argc > 2 ? std::atoi(argv[2]) : 5000;
+    uint32_t keyframeInterval = argc > 3 ? (uint32_t)std::atoi(argv[3]) : 100;
+
+    SnakeWorld world(128, 128, snakes, 64, 7);
+    for (int i = 0; i < snakes; i++) {
+        world.AddSnake();
+    }
+
+    WorldDeltaEncoder encoder(snakes);
+    WorldStreamWriter stream(snakes, keyframeInterval);
+    WorldView live(snakes);
+    std::vector<uint8_t> delta(TICK_MAX_DATAGRAM);
+    std::vector<uint8_t> full(1 << 20);
+    std::vector<uint8_t> recording;
+    uint32_t rng = 2463534242u;
+
+    double encodeSeconds = 0.0;
+    double fullSeconds = 0.0;
+    uint64_t deltaBytes = 0;
+    uint64_t fullBytes = 0;
+    uint64_t lengthSum = 0;
+    uint64_t aliveSum = 0;
+    int mismatchedTicks = 0;
+
+    for (int t = 0; t < ticks; t++) {
+        for (int id = 0; id < snakes; id++) {
+            if (world.IsAlive(id)) Steer(world, id, rng);
+        }
+        world.Step();
+
+        auto start = std::chrono::steady_clock::now();
+        size_t size = encoder.EncodeDelta(world, delta.data(), delta.size());
+        encodeSeconds += Seconds(start);
+        deltaBytes += size;
+
+        start = std::chrono::steady_clock::now();
+        int nextSnake = 0;
+        size_t fullSize = EncodeWorldKeyframe(world, nextSnake, 0, full.data(), full.size());
+        fullSeconds += Seconds(start);
+        fullBytes += fullSize;
+
+        // The first delta starts from an empty world; sync the view on it
+        if (t == 0) {
+            live.ApplyKeyframe(full.data(), fullSize);
+        } else {
+            live.ApplyDelta(delta.data(), size);
+        }
+        mismatchedTicks += !ViewMatches(live, world);
+
+        stream.Append(world, recording);
+        for (int id = 0; id < snakes; id++) {
+            aliveSum += world.IsAlive(id);
+            lengthSum += world.GetBodySize(id);
+        }
+    }
+
+    printf("world:  %d snakes on 128x128, %d ticks, %.0f alive, %.1f cells long on average\n", snakes, ticks,
+           (double)aliveSum / ticks, aliveSum ? (double)lengthSum / aliveSum : 0.0);
+    printf("delta:  %.0f B/tick, %.2f us/tick to encode\n", (double)deltaBytes / ticks, encodeSeconds * 1e6 / ticks);
+    printf("full:   %.0f B/tick, %.2f us/tick to encode (%.1fx the delta)\n", (double)fullBytes / ticks,
+           fullSeconds * 1e6 / ticks, deltaBytes ? (double)fullBytes / deltaBytes : 0.0);
+    printf("live:   %d of %d ticks differ from the world after applying deltas\n", mismatchedTicks, ticks);
+
+    // A spectator joining at the start of the recording syncs on the first
+    // keyframe and replays every diff after it in place
+    WorldView spectator(snakes);
+    const uint8_t* cursor = recording.data();
+    const uint8_t* end = cursor + recording.size();
+    auto start = std::chrono::steady_clock::now();
+    int frames = 0;
+    while (spectator.ApplyFrame(cursor, end)) {
+        frames++;
+    }
+    double decodeSeconds = Seconds(start);
+    bool matches = ViewMatches(spectator, world);
+
+    printf("stream: %.1f KB (%.0f B/tick with a keyframe every %u ticks), %d frames, %.2f us/tick to decode\n",
+           recording.size() / 1024.0, (double)recording.size() / ticks, keyframeInterval, frames,
+           decodeSeconds * 1e6 / ticks);
+    printf("        final state %s, %llu keyframe mismatches\n", matches ? "matches" : "DIFFERS",
+           (unsigned long long)spectator.GetKeyframeMismatches());
+    return mismatchedTicks == 0 && matches && spectator.GetKeyframeMismatches() == 0 ? 0 : 1;
+}
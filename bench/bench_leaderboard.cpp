@@ -0,0 +1,63 @@
+// Concurrent score submission into the leaderboard's lock-free skiplist.
+// Build: mingw32-make bench   Run: build/bench_leaderboard [threads] [scores per thread]
+
+#include "Leaderboard.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+int main(int argc, char** argv) {
+    int threads = argc > 1 ? std::atoi(argv[1]) : (int)std::thread::hardware_concurrency();
+    int perThread = argc > 2 ? std::atoi(argv[2]) : 200000;
+    if (threads < 1) threads = 1;
+
+    Leaderboard board((uint32_t)(threads * perThread));
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&board, t, perThread]() {
+            char name[LEADERBOARD_NAME_LENGTH];
+            std::snprintf(name, sizeof(name), "bench%d", t);
+            uint32_t state = 2463534242u + (uint32_t)t * 7919u;
+            for (int i = 0; i < perThread; i++) {
+                state ^= state << 13;
+                state ^= state >> 17;
+                state ^= state << 5;
+                board.Submit(name, (int32_t)(state % 5000) * 10);
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // The bottom level must come out fully ordered with every submission on it
+    std::vector<LeaderboardEntry> all(board.Size());
+    int listed = board.Top(all.data(), (int)all.size());
+    bool ordered = listed == threads * perThread;
+    for (int i = 1; i < listed && ordered; i++) {
+        ordered = all[i - 1].score >= all[i].score;
+    }
+
+    printf("submit: %d threads x %d scores, %.2f M/s, %s\n", threads, perThread,
+           threads * (double)perThread / seconds / 1e6, ordered ? "ordered" : "ORDER BROKEN");
+
+    LeaderboardEntry top[10];
+    int count = board.Top(top, 10);
+    printf("top:    %d (best %d by %s), rank of 25000: %u of %u\n",
+           count, count ? top[0].score : 0, count ? top[0].player : "-", board.Rank(25000), board.Size());
+
+    start = std::chrono::steady_clock::now();
+    const int queries = 1000000;
+    uint64_t rankSum = 0;
+    for (int i = 0; i < queries; i++) {
+        rankSum += board.Rank((i % 5000) * 10);
+    }
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("rank:   %.1f ns/query (checksum %llu)\n", seconds * 1e9 / queries, (unsigned long long)rankSum);
+    return ordered ? 0 : 1;
+}
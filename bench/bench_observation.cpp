@@ -0,0 +1,275 @@
+// Checks what an agent sees against naive references, then times it.
+// Every tick of every game is compared with a from-scratch rebuild:
+// ObservationWriter's incremental planes, EgocentricWriter's rotated
+// window and features, and VecEnv's batched action masks.
+// The references rotate and wrap with plain vector arithmetic and
+// modulo, and they find masks by stepping a copy of the game. So a
+// regression in the stride tables, the edge wrapping or the tail
+// bookkeeping shows up here as a count instead of as a worse agent.
+// Build: mingw32-make bench   Run: build/bench_observation [games] [ticks] [check ticks]
+
+#include "EgocentricObservation.h"
+#include "Simulation.h"
+#include "VecEnv.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using CheckBoard = Board<16, 12>;
+
+static uint32_t NextRandom(uint32_t& rng) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+// Heads for the power-up while one is out, so invincible games run
+// through their own bodies; otherwise chases food, with random turns
+template <typename SimT>
+static Direction ChasePolicy(const SimT& sim, uint32_t& rng) {
+    unsigned mask = sim.GetActionMask();
+    if ((NextRandom(rng) & 31) == 0) return static_cast<Direction>((rng >> 8) & 3);
+
+    const auto& board = sim.GetBoard();
+    int head = sim.GetHeadCell();
+    int target = sim.GetPowerUpCell() >= 0 ? sim.GetPowerUpCell() : sim.GetFoodCell();
+    if (target < 0) target = head;
+    int dx = board.X(target) - board.X(head);
+    int dy = board.Y(target) - board.Y(head);
+
+    Direction preferred[4] = {dx > 0 ? RIGHT : LEFT, dy > 0 ? DOWN : UP,
+                              dx > 0 ? LEFT : RIGHT, dy > 0 ? UP : DOWN};
+    for (Direction dir : preferred) {
+        if ((mask >> (4 + dir)) & 1) return dir;
+    }
+    return sim.GetDirection();
+}
+
+// Forward unit vector per Direction; "right" is it turned clockwise
+// (screen y points down), "back" is its negation
+static const int FORWARD_X[4] = {0, 0, -1, 1};
+static const int FORWARD_Y[4] = {-1, 1, 0, 0};
+
+// Nearest copy of an offset on a torus; an exact half keeps its sign
+static int NearestOffset(int delta, int extent) {
+    int best = delta;
+    if (std::abs(delta - extent) < std::abs(best)) best = delta - extent;
+    if (std::abs(delta + extent) < std::abs(best)) best = delta + extent;
+    return best;
+}
+
+template <typename SimT>
+static void ReferenceEgocentric(const SimT& sim, int size, float* planes, float* features) {
+    const auto& board = sim.GetBoard();
+    int width = board.Width();
+    int height = board.Height();
+    int half = size / 2;
+    Direction dir = sim.GetDirection();
+    int fx = FORWARD_X[dir], fy = FORWARD_Y[dir];
+    int rx = -fy, ry = fx;
+    int headX = board.X(sim.GetHeadCell());
+    int headY = board.Y(sim.GetHeadCell());
+
+    for (int row = 0; row < size; row++) {
+        for (int col = 0; col < size; col++) {
+            int right = col - half;
+            int back = row - half;
+            int x = headX + right * rx - back * fx;
+            int y = headY + right * ry - back * fy;
+            if (SimT::WRAPS) {
+                x = ((x % width) + width) % width;
+                y = ((y % height) + height) % height;
+            }
+            bool inside = x >= 0 && x < width && y >= 0 && y < height;
+            int cell = inside ? board.Index(x, y) : -1;
+            int i = row * size + col;
+            planes[EGO_BODY * size * size + i] = inside && board.Test(cell);
+            planes[EGO_WALL * size * size + i] = !inside;
+            planes[EGO_FOOD * size * size + i] = inside && cell == sim.GetFoodCell();
+            planes[EGO_POWERUP * size * size + i] = inside && cell == sim.GetPowerUpCell();
+        }
+    }
+
+    float boardSize = (float)(width > height ? width : height);
+    int food = sim.GetFoodCell();
+    features[EGO_FOOD_FORWARD] = 0.0f;
+    features[EGO_FOOD_RIGHT] = 0.0f;
+    features[EGO_FOOD_DISTANCE] = 0.0f;
+    if (food >= 0) {
+        int dx = board.X(food) - headX;
+        int dy = board.Y(food) - headY;
+        if (SimT::WRAPS) {
+            dx = NearestOffset(dx, width);
+            dy = NearestOffset(dy, height);
+        }
+        int forward = dx * fx + dy * fy;
+        int right = dx * rx + dy * ry;
+        features[EGO_FOOD_FORWARD] = forward / boardSize;
+        features[EGO_FOOD_RIGHT] = right / boardSize;
+        features[EGO_FOOD_DISTANCE] = (float)(std::abs(forward) + std::abs(right)) / (width + height);
+    }
+    features[EGO_LENGTH] = (float)sim.GetLength() / board.Cells();
+    for (int type = 0; type < POWERUP_TYPE_COUNT; type++) {
+        features[EGO_TIMER_SPEED + type] =
+            (float)sim.GetPowerUpTicksRemaining(static_cast<PowerUpType>(type)) / SimT::POWERUP_DURATION_TICKS;
+    }
+}
+
+template <typename SimT>
+static void ReferencePlanes(const SimT& sim, float* planes) {
+    int cells = sim.GetBoard().Cells();
+    for (int i = 0; i < OBS_CHANNEL_COUNT * cells; i++) planes[i] = 0.0f;
+
+    for (int cell = 0; cell < cells; cell++) {
+        planes[OBS_BODY * cells + cell] = sim.GetBoard().Test(cell);
+    }
+    int head = sim.GetHeadCell();
+    planes[OBS_HEAD * cells + head] = 1.0f;
+    for (int type = 0; type < POWERUP_TYPE_COUNT; type++) {
+        planes[(OBS_TIMER_SPEED + type) * cells + head] =
+            (float)sim.GetPowerUpTicksRemaining(static_cast<PowerUpType>(type)) / SimT::POWERUP_DURATION_TICKS;
+    }
+    if (sim.GetFoodCell() >= 0) planes[OBS_FOOD * cells + sim.GetFoodCell()] = 1.0f;
+    if (sim.GetPowerUpCell() >= 0) {
+        planes[(OBS_POWERUP_SPEED + sim.GetPowerUpType()) * cells + sim.GetPowerUpCell()] = 1.0f;
+    }
+}
+
+// A move is safe if a copy of the game survives it
+template <typename SimT>
+static void ReferenceMask(const SimT& sim, uint8_t* legal, uint8_t* safe) {
+    for (int d = 0; d < 4; d++) {
+        legal[d] = (sim.GetDirection() ^ d) != 1;
+        SimT copy = sim;
+        safe[d] = legal[d] && copy.Step(static_cast<Direction>(d));
+    }
+}
+
+struct Mismatches {
+    uint64_t planes = 0;
+    uint64_t egocentric = 0;
+    uint64_t masks = 0;
+    uint64_t overlapTicks = 0;  // game-ticks with the snake through itself
+
+    uint64_t Total() const { return planes + egocentric + masks; }
+};
+
+template <typename SimT>
+static Mismatches Check(const char* name, int size, int games, int ticks) {
+    size_t stride = (size_t)OBS_CHANNEL_COUNT * CheckBoard().Cells();
+    std::vector<float> planes(games * stride);
+    VecEnv<SimT, float> env(games, 2024, planes.data());
+    EgocentricWriter<SimT, float> ego(size);
+
+    std::vector<float> egoPlanes(games * ego.PlaneStride());
+    std::vector<float> features(games * EGO_FEATURE_COUNT);
+    std::vector<uint8_t> legal(games * 4), safe(games * 4);
+    std::vector<float> refPlanes(stride), refEgo(ego.PlaneStride());
+    float refFeatures[EGO_FEATURE_COUNT];
+    uint8_t refLegal[4], refSafe[4];
+
+    std::vector<Direction> actions(games, RIGHT);
+    std::vector<float> rewards(games);
+    std::vector<uint8_t> dones(games);
+    SimulationKeyframe frame;
+    std::vector<int> cells;
+    uint32_t rng = 99;
+    Mismatches found;
+
+    for (int t = 0; t < ticks; t++) {
+        env.WriteEgocentric(ego, egoPlanes.data(), features.data());
+        env.WriteActionMasks(legal.data(), safe.data());
+
+        for (int i = 0; i < games; i++) {
+            const SimT& sim = env.GetGame(i);
+            sim.SaveKeyframe(frame, cells);
+            found.overlapTicks += frame.overlaps > 0;
+
+            ReferencePlanes(sim, refPlanes.data());
+            for (size_t k = 0; k < stride; k++) {
+                found.planes += planes[i * stride + k] != refPlanes[k];
+            }
+
+            ReferenceEgocentric(sim, size, refEgo.data(), refFeatures);
+            for (size_t k = 0; k < ego.PlaneStride(); k++) {
+                found.egocentric += egoPlanes[i * ego.PlaneStride() + k] != refEgo[k];
+            }
+            for (int k = 0; k < EGO_FEATURE_COUNT; k++) {
+                found.egocentric += features[i * EGO_FEATURE_COUNT + k] != refFeatures[k];
+            }
+
+            ReferenceMask(sim, refLegal, refSafe);
+            for (int d = 0; d < 4; d++) {
+                found.masks += legal[i * 4 + d] != refLegal[d] || safe[i * 4 + d] != refSafe[d];
+            }
+
+            actions[i] = ChasePolicy(sim, rng);
+        }
+        env.Step(actions.data(), rewards.data(), dones.data());
+    }
+
+    printf("check:  %-8s K=%-2d %d games x %d ticks (%llu overlapping): %llu plane, %llu egocentric, "
+           "%llu mask mismatches\n",
+           name, size, games, ticks, (unsigned long long)found.overlapTicks,
+           (unsigned long long)found.planes, (unsigned long long)found.egocentric,
+           (unsigned long long)found.masks);
+    return found;
+}
+
+static double Seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    int games = argc > 1 ? std::atoi(argv[1]) : 1024;
+    int ticks = argc > 2 ? std::atoi(argv[2]) : 500;
+    int checkTicks = argc > 3 ? std::atoi(argv[3]) : 2000;
+
+    // K=15 is wider than the board is tall: wrapped rows meet themselves
+    uint64_t mismatches = 0;
+    mismatches += Check<Simulation<CheckBoard, ClassicRules>>("classic", 11, 32, checkTicks).Total();
+    mismatches += Check<Simulation<CheckBoard, WrapRules>>("wrap", 7, 32, checkTicks).Total();
+    mismatches += Check<Simulation<CheckBoard, WrapRules>>("wrap", 15, 32, checkTicks).Total();
+    mismatches += Check<Simulation<CheckBoard, PureWrapRules>>("purewrap", 9, 32, checkTicks).Total();
+    mismatches += Check<Simulation<CheckBoard, BounceRules>>("bounce", 11, 32, checkTicks).Total();
+
+    // Cost per game on the classic board: planes are updated inside Step
+    using Sim = ClassicSimulation;
+    const int size = 11;
+    std::vector<uint8_t> planes(games * (size_t)OBS_CHANNEL_COUNT * Sim().GetBoard().Cells());
+    VecEnv<Sim, uint8_t> env(games, 7, planes.data());
+    EgocentricWriter<Sim, uint8_t> ego(size);
+    std::vector<uint8_t> egoPlanes(games * ego.PlaneStride());
+    std::vector<float> features(games * EGO_FEATURE_COUNT);
+    std::vector<uint8_t> legal(games * 4), safe(games * 4);
+    std::vector<Direction> actions(games, RIGHT);
+    std::vector<float> rewards(games);
+    std::vector<uint8_t> dones(games);
+    uint32_t rng = 5;
+    double stepSeconds = 0.0, egoSeconds = 0.0, maskSeconds = 0.0;
+
+    for (int t = 0; t < ticks; t++) {
+        for (int i = 0; i < games; i++) {
+            actions[i] = ChasePolicy(env.GetGame(i), rng);
+        }
+        auto start = std::chrono::steady_clock::now();
+        env.Step(actions.data(), rewards.data(), dones.data());
+        stepSeconds += Seconds(start);
+
+        start = std::chrono::steady_clock::now();
+        env.WriteEgocentric(ego, egoPlanes.data(), features.data());
+        egoSeconds += Seconds(start);
+
+        start = std::chrono::steady_clock::now();
+        env.WriteActionMasks(legal.data(), safe.data());
+        maskSeconds += Seconds(start);
+    }
+
+    double perGame = 1e9 / ((double)games * ticks);
+    printf("time:   %d games x %d ticks on 40x30: step + planes %.1f ns, egocentric K=%d %.1f ns, "
+           "masks %.1f ns per game\n",
+           games, ticks, stepSeconds * perGame, size, egoSeconds * perGame, maskSeconds * perGame);
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,158 @@
+// Replay container: size against the raw one-byte-per-tick log, open and
+// seek cost, and a round trip through the verifier, for a million-tick
+// full-board game and a batch of short greedy games.
+// Build: mingw32-make bench   Run: build/bench_replay [ticks] [keep.snkp]
+
+#include "ReplayFile.h"
+#include "ReplayVerifier.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using Sim = TournamentSimulation;
+
+static double Seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Hamiltonian cycle: boustrophedon over columns 1..W-1, back up column 0.
+// Never dies, so the snake ends up filling the board.
+static Direction CyclePolicy(const Sim& sim) {
+    const auto& board = sim.GetBoard();
+    int x = board.X(sim.GetHeadCell());
+    int y = board.Y(sim.GetHeadCell());
+    if (x == 0) return y > 0 ? UP : RIGHT;
+    if (y % 2 == 0) return x == board.Width() - 1 ? DOWN : RIGHT;
+    if (x == 1) return y == board.Height() - 1 ? LEFT : DOWN;
+    return LEFT;
+}
+
+static Direction GreedyPolicy(const Sim& sim, uint32_t& rng) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+
+    unsigned mask = sim.GetActionMask();
+    if ((rng & 63) == 0) return static_cast<Direction>((rng >> 8) & 3);
+
+    const auto& board = sim.GetBoard();
+    int head = sim.GetHeadCell();
+    int food = sim.GetFoodCell() >= 0 ? sim.GetFoodCell() : head;
+    int dx = board.X(food) - board.X(head);
+    int dy = board.Y(food) - board.Y(head);
+
+    Direction preferred[4] = {dx > 0 ? RIGHT : LEFT, dy > 0 ? DOWN : UP,
+                              dx > 0 ? LEFT : RIGHT, dy > 0 ? UP : DOWN};
+    for (Direction dir : preferred) {
+        if ((mask >> (4 + dir)) & 1) return dir;
+    }
+    return sim.GetDirection();
+}
+
+static bool CheckRoundTrip(const ReplayReader& reader) {
+    Replay replay;
+    Sim sim;
+    return reader.ReadReplay(replay) && ReplayVerifier<Sim>::Verify(sim, replay) == REPLAY_OK;
+}
+
+int main(int argc, char** argv) {
+    uint64_t ticks = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    // A second argument keeps the long game for the replay viewer
+    const char* keepPath = argc > 2 ? argv[2] : nullptr;
+    const char* path = "bench_replay.snkp";
+    const uint32_t interval = 4096;
+
+    Sim sim;
+    ReplayWriter<Sim> writer(sim, interval);
+    auto start = std::chrono::steady_clock::now();
+    writer.Begin(7, "cycle");
+    while (sim.GetTick() < ticks && writer.Step(CyclePolicy(sim))) {
+    }
+    double recordSeconds = Seconds(start);
+    if (!writer.Save(path) || (keepPath && !writer.Save(keepPath))) {
+        printf("cannot write %s\n", path);
+        return 1;
+    }
+
+    ReplayReader reader;
+    start = std::chrono::steady_clock::now();
+    bool opened = reader.Open(path);
+    double openSeconds = Seconds(start);
+    if (!opened) {
+        printf("cannot read %s back\n", path);
+        return 1;
+    }
+    const ReplayFileHeader& header = reader.GetHeader();
+    printf("cycle game: %llu ticks, length %d, %u keyframes\n", (unsigned long long)header.tickCount,
+           sim.GetLength(), header.keyframeCount);
+    printf("  raw log %10llu bytes   file %8zu bytes (inputs %llu)   %.0fx smaller\n",
+           (unsigned long long)header.tickCount, reader.GetFileSize(), (unsigned long long)header.inputBytes,
+           (double)header.tickCount / reader.GetFileSize());
+    printf("  record %.2f s, open %.1f us, verifier round trip %s\n", recordSeconds, openSeconds * 1e6,
+           CheckRoundTrip(reader) ? "ok" : "FAILED");
+
+    // Random seeks, checked against one straight playthrough
+    const int seeks = 200;
+    std::vector<uint64_t> targets(seeks);
+    uint32_t rng = 0x9E3779B9;
+    for (uint64_t& target : targets) {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        target = rng % (header.tickCount + 1);
+    }
+    std::sort(targets.begin(), targets.end());
+
+    std::vector<uint64_t> expected(seeks);
+    ReplayPlayer<Sim> reference(reader);
+    reference.Seek(0);
+    for (int i = 0; i < seeks; i++) {
+        while (reference.GetTick() < targets[i] && reference.Step()) {
+        }
+        expected[i] = HashState(reference.GetSimulation());
+    }
+    bool finalOk = HashState(reference.GetSimulation()) == header.stateHash || targets.back() != header.tickCount;
+
+    ReplayPlayer<Sim> player(reader);
+    int mismatches = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = seeks - 1; i >= 0; i--) {
+        player.Seek(targets[i]);
+        mismatches += HashState(player.GetSimulation()) != expected[i];
+    }
+    double seekSeconds = Seconds(start);
+
+    start = std::chrono::steady_clock::now();
+    player.Seek(0);
+    while (player.Step()) {
+    }
+    double fullSeconds = Seconds(start);
+    finalOk = finalOk && HashState(player.GetSimulation()) == header.stateHash;
+
+    printf("  seek %.1f us avg (%d mismatches), replay from tick 0 %.1f ms, final hash %s\n",
+           seekSeconds / seeks * 1e6, mismatches, fullSeconds * 1e3, finalOk ? "ok" : "FAILED");
+
+    // Short games change direction far more often
+    const int games = 1000;
+    uint64_t rawBytes = 0;
+    uint64_t fileBytes = 0;
+    int failures = 0;
+    for (int game = 0; game < games; game++) {
+        uint32_t policyRng = (uint32_t)(game + 1) * 0x9E3779B9u | 1;
+        writer.Begin(100 + game, "greedy");
+        while (sim.GetTick() < ticks && writer.Step(GreedyPolicy(sim, policyRng))) {
+        }
+        rawBytes += sim.GetTick();
+        fileBytes += writer.GetEncodedBytes();
+        if (game % 100 == 0) {
+            failures += !writer.Save(path) || !reader.Open(path) || !CheckRoundTrip(reader);
+        }
+    }
+    printf("greedy games: %d, raw log %llu bytes, files %llu bytes (%.1fx), round trip failures %d\n", games,
+           (unsigned long long)rawBytes, (unsigned long long)fileBytes, (double)rawBytes / fileBytes, failures);
+
+    reader.Close();
+    std::remove(path);
+    return mismatches == 0 && finalOk && failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,73 @@
+// Throughput of the policy-specialised Simulation variants.
+// Build: mingw32-make bench   Run: build/bench_rules
+// Built with -DSNAKE_PROFILE_ALLOCS it also aborts if the loop ever allocates.
+
+#include "AllocProfiler.h"
+#include "PerfCounters.h"
+#include "Simulation.h"
+#include <chrono>
+#include <cstdio>
+
+// Cheap deterministic agent: keeps going straight, turns 1 tick in 8
+static Direction NextAction(uint32_t& state, Direction current) {
+    state = state * 1664525u + 1013904223u;
+    if ((state >> 29) != 0) return current;
+    return static_cast<Direction>((state >> 27) & 3);
+}
+
+template <typename SimT>
+static void Run(const char* name, SimT sim, uint64_t targetTicks) {
+    uint32_t agent = 12345;
+    uint64_t ticks = 0;
+    uint64_t games = 0;
+    long long totalScore = 0;
+
+    PerfCounters& counters = PerfCounters::ForThread();
+    PerfSample before = counters.Read();
+    auto start = std::chrono::steady_clock::now();
+    {
+        // Steady state: stepping and resetting never touch the heap
+        ASSERT_NO_ALLOCS();
+        while (ticks < targetTicks) {
+            sim.Reset(games);
+            while (sim.Step(NextAction(agent, sim.GetDirection()))) {
+                ticks++;
+            }
+            totalScore += sim.GetScore();
+            games++;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    PerfSample after = counters.Read();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    printf("%-28s %8.2f Mticks/s  %7.1f ns/tick  %8llu games  avg score %.1f\n",
+           name, ticks / seconds / 1e6, seconds * 1e9 / ticks,
+           (unsigned long long)games, (double)totalScore / games);
+    if (counters.IsAvailable()) {
+        printf("%-28s ", "");
+        PerfCounters::PrintPer(stdout, after - before, ticks, "tick");
+        printf("\n");
+    }
+}
+
+int main() {
+    const uint64_t ticks = 20000000;
+
+    if (!PerfCounters::ForThread().IsAvailable()) {
+        printf("(hardware counters unavailable: no IPC / miss columns)\n");
+    }
+
+    Run("classic 40x30",          Simulation<Board<40, 30>, ClassicRules>(), ticks);
+    Run("classic 40x30 runtime",  Simulation<DynamicBoard, ClassicRules>(1, DynamicBoard(40, 30)), ticks);
+    Run("wrap 40x30",             Simulation<Board<40, 30>, WrapRules>(), ticks);
+    Run("bounce 40x30",           Simulation<Board<40, 30>, BounceRules>(), ticks);
+    Run("pure 40x30",             Simulation<Board<40, 30>, PureRules>(), ticks);
+    Run("pure wrap 64x64",        Simulation<Board<64, 64>, PureWrapRules>(), ticks);
+    Run("pure wrap 64x64 runtime", Simulation<DynamicBoard, PureWrapRules>(1, DynamicBoard(64, 64)), ticks);
+
+#ifdef SNAKE_PERF_COUNTERS
+    PerfRegions::Report(stdout);
+#endif
+    return 0;
+}
@@ -0,0 +1,203 @@
+// Giant-board snake bodies: RunLengthSnake against one cell per segment
+// (deque of cell ids plus an occupancy bitboard, as in Simulation) on a
+// 4096x4096 board. A random walk first checks that both agree on head,
+// tail, occupancy and self-collision every tick; then both grow to a long
+// snake sweeping the board row by row and are timed per tick.
+//
+// A 1M-cell snake in ~500 runs is 8 KB (plus one index node per run)
+// against 6 MB. Occupancy goes through the per-row/per-column interval
+// index, so a tick is a few map operations (~80 ns here) where the bitboard
+// answers in one load (~7 ns); a linear walk over the runs was ~2.5 us.
+// Build: mingw32-make bench   Run: build/bench_runlength [length] [ticks] [check ticks]
+
+#include "RunLengthSnake.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <vector>
+
+const int BOARD_SIZE = 4096;
+
+static double Seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Reference body: one cell id per segment, head at the front
+class CellSnake {
+private:
+    std::deque<int> body;
+    std::vector<uint64_t> bits;
+    Direction direction;
+    int pendingGrowth;
+
+    bool Test(int cell) const { return (bits[cell >> 6] >> (cell & 63)) & 1; }
+    void Set(int cell) { bits[cell >> 6] |= uint64_t(1) << (cell & 63); }
+    void Clear(int cell) { bits[cell >> 6] &= ~(uint64_t(1) << (cell & 63)); }
+
+public:
+    explicit CellSnake(GridCell start)
+        : bits((size_t)BOARD_SIZE * BOARD_SIZE / 64), direction(RIGHT), pendingGrowth(0) {
+        for (int i = 0; i < 3; i++) {
+            int cell = start.y * BOARD_SIZE + start.x - i;
+            body.push_back(cell);
+            Set(cell);
+        }
+    }
+
+    void SetDirection(Direction dir) {
+        if ((direction ^ dir) != 1) direction = dir;
+    }
+
+    // True if the head ran into the body
+    bool Move() {
+        int head = body.front();
+        int next = head + (direction == RIGHT) - (direction == LEFT) +
+                   ((direction == DOWN) - (direction == UP)) * BOARD_SIZE;
+        if (pendingGrowth > 0) {
+            pendingGrowth--;
+        } else {
+            Clear(body.back());
+            body.pop_back();
+        }
+        bool collided = Test(next);
+        body.push_front(next);
+        Set(next);
+        return collided;
+    }
+
+    void Grow() { pendingGrowth++; }
+    bool Occupies(GridCell cell) const { return Test(cell.y * BOARD_SIZE + cell.x); }
+    int GetHeadCell() const { return body.front(); }
+    int GetTailCell() const { return body.back(); }
+    size_t GetBytes() const { return body.size() * sizeof(int) + bits.size() * sizeof(uint64_t); }
+};
+
+static int CellId(GridCell cell) {
+    return cell.y * BOARD_SIZE + cell.x;
+}
+
+static bool InBounds(GridCell cell, Direction dir) {
+    int x = cell.x + (dir == RIGHT) - (dir == LEFT);
+    int y = cell.y + (dir == DOWN) - (dir == UP);
+    return x >= 0 && x < BOARD_SIZE && y >= 0 && y < BOARD_SIZE;
+}
+
+// Right along a row, one down, left along the next: two runs per row
+static Direction SweepDirection(GridCell head, Direction dir) {
+    if (dir == RIGHT && head.x == BOARD_SIZE - 1) return DOWN;
+    if (dir == LEFT && head.x == 0) return DOWN;
+    if (dir == DOWN) return head.x == 0 ? RIGHT : LEFT;
+    return dir;
+}
+
+static uint64_t Check(uint64_t ticks) {
+    GridCell start = {BOARD_SIZE / 2, BOARD_SIZE / 2};
+    RunLengthSnake runs(start);
+    CellSnake cells(start);
+    uint32_t rng = 2463534242u;
+    uint64_t mismatches = 0;
+    uint64_t collisions = 0;
+
+    for (uint64_t t = 0; t < ticks; t++) {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+
+        Direction dir = runs.GetDirection();
+        if ((rng & 7) == 0 || !InBounds(runs.GetHeadCell(), dir)) dir = static_cast<Direction>((rng >> 8) & 3);
+        if (!InBounds(runs.GetHeadCell(), dir) || (dir ^ runs.GetDirection()) == 1) dir = runs.GetDirection();
+        if (!InBounds(runs.GetHeadCell(), dir)) {
+            dir = runs.GetDirection() == UP || runs.GetDirection() == DOWN ? LEFT : UP;
+            if (!InBounds(runs.GetHeadCell(), dir)) dir = static_cast<Direction>(dir ^ 1);
+        }
+        if (t % 3 == 0) {
+            runs.Grow();
+            cells.Grow();
+        }
+        runs.SetDirection(dir);
+        cells.SetDirection(dir);
+        runs.Move();
+        bool collided = cells.Move();
+
+        // A probe next to the head hits the body about half the time
+        GridCell head = runs.GetHeadCell();
+        GridCell probe = {head.x + (int)((rng >> 12) % 9) - 4, head.y + (int)((rng >> 16) % 9) - 4};
+        bool probeInside = probe.x >= 0 && probe.x < BOARD_SIZE && probe.y >= 0 && probe.y < BOARD_SIZE;
+
+        bool same = runs.CheckSelfCollision() == collided && CellId(head) == cells.GetHeadCell() &&
+                    CellId(runs.GetTailCell()) == cells.GetTailCell() &&
+                    (!probeInside || runs.Occupies(probe) == cells.Occupies(probe));
+        mismatches += !same;
+        if (collided || !same) {
+            collisions += collided;
+            runs = RunLengthSnake(start);
+            cells = CellSnake(start);
+        }
+    }
+    printf("check:  %llu ticks of random walk, %llu self-collisions, %llu mismatches\n",
+           (unsigned long long)ticks, (unsigned long long)collisions, (unsigned long long)mismatches);
+    return mismatches;
+}
+
+template <typename SnakeT>
+static double TimeSweep(SnakeT& snake, GridCell& head, Direction& dir, uint64_t ticks) {
+    auto start = std::chrono::steady_clock::now();
+    bool collided = false;
+    for (uint64_t t = 0; t < ticks; t++) {
+        dir = SweepDirection(head, dir);
+        snake.SetDirection(dir);
+        head.x += (dir == RIGHT) - (dir == LEFT);
+        head.y += dir == DOWN;
+        collided |= snake.Move();
+    }
+    double seconds = Seconds(start);
+    if (collided) printf("sweep collided\n");
+    return seconds * 1e9 / ticks;
+}
+
+// RunLengthSnake reports collisions separately; this matches CellSnake::Move
+struct RunLengthMover {
+    RunLengthSnake& snake;
+    void SetDirection(Direction dir) { snake.SetDirection(dir); }
+    bool Move() {
+        snake.Move();
+        return snake.CheckSelfCollision();
+    }
+    void Grow() { snake.Grow(); }
+};
+
+int main(int argc, char** argv) {
+    int length = argc > 1 ? std::atoi(argv[1]) : 1 << 20;
+    uint64_t ticks = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 2000000;
+    uint64_t checkTicks = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 1000000;
+    if (Check(checkTicks) > 0) return 1;
+
+    GridCell start = {2, 0};
+    RunLengthSnake runSnake(start);
+    RunLengthMover runs = {runSnake};
+    CellSnake cells(start);
+
+    // Grow both to 'length' along the sweep, then time the same path
+    GridCell runHead = start;
+    GridCell cellHead = start;
+    Direction runDir = RIGHT;
+    Direction cellDir = RIGHT;
+    for (int i = 3; i < length; i++) {
+        runs.Grow();
+        cells.Grow();
+    }
+    double growRuns = TimeSweep(runs, runHead, runDir, (uint64_t)length);
+    double growCells = TimeSweep(cells, cellHead, cellDir, (uint64_t)length);
+    double runNanos = TimeSweep(runs, runHead, runDir, ticks);
+    double cellNanos = TimeSweep(cells, cellHead, cellDir, ticks);
+
+    size_t runBytes = runSnake.GetRuns().size() * sizeof(BodyRun);
+    printf("board:  %dx%d, snake %d cells in %zu runs\n", BOARD_SIZE, BOARD_SIZE, runSnake.GetLength(),
+           runSnake.GetRuns().size());
+    printf("runs:   %8.1f ns/tick (%.1f while growing), %8.1f KB body\n", runNanos, growRuns, runBytes / 1024.0);
+    printf("cells:  %8.1f ns/tick (%.1f while growing), %8.1f KB body + bitboard\n", cellNanos, growCells,
+           cells.GetBytes() / 1024.0);
+    return 0;
+}
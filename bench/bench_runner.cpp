@@ -0,0 +1,80 @@
+// Mixed-length episodes on the work-stealing pool: static shards vs small
+// stolen chunks, then pinned NUMA-aware workers with per-node throughput,
+// for 1..N threads.
+// Build: mingw32-make bench   Run: build/bench_runner [maxThreads]
+
+#include "CpuTopology.h"
+#include "ParallelRunner.h"
+#include "Simulation.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+using Sim = Simulation<Board<20, 20>, ClassicRules>;
+
+// Mostly survives (safe move closest to the food), but one tick in 256 makes
+// a random legal move, so episode lengths range from tens to many thousands
+static Direction MixedPolicy(const Sim& sim, uint32_t& rng) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+
+    unsigned mask = sim.GetActionMask();
+    if ((rng & 255) == 0) return static_cast<Direction>((rng >> 8) & 3);
+
+    const auto& board = sim.GetBoard();
+    int head = sim.GetHeadCell();
+    int food = sim.GetFoodCell() >= 0 ? sim.GetFoodCell() : head;
+    int dx = board.X(food) - board.X(head);
+    int dy = board.Y(food) - board.Y(head);
+
+    Direction preferred[4] = {dx > 0 ? RIGHT : LEFT, dy > 0 ? DOWN : UP,
+                              dx > 0 ? LEFT : RIGHT, dy > 0 ? UP : DOWN};
+    for (Direction dir : preferred) {
+        if ((mask >> (4 + dir)) & 1) return dir;
+    }
+    return sim.GetDirection();
+}
+
+static void Run(int threads, int episodes, bool staticShards, bool pinned) {
+    ThreadPool pool(threads, pinned);
+    ParallelRunner<Sim> runner(pool, Sim(), staticShards ? (episodes + threads - 1) / threads : 2, 200000);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<EpisodeResult> results = runner.RunEpisodes(episodes, 1, &MixedPolicy);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t ticks = 0;
+    uint64_t longest = 0;
+    for (const auto& result : results) {
+        ticks += result.ticks;
+        if (result.ticks > longest) longest = result.ticks;
+    }
+    printf("%-7s threads %2d  %8.2f Mticks/s  (%llu ticks, longest %llu, steals %llu)\n",
+           pinned ? "pinned" : staticShards ? "static" : "stolen", threads, ticks / seconds / 1e6,
+           (unsigned long long)ticks, (unsigned long long)longest,
+           (unsigned long long)pool.GetStealCount());
+
+    if (pinned) {
+        std::vector<uint64_t> nodeTicks = runner.GetNodeTicks();
+        for (size_t node = 0; node < nodeTicks.size(); node++) {
+            if (nodeTicks[node] == 0) continue;
+            printf("        node %zu     %8.2f Mticks/s\n", node, nodeTicks[node] / seconds / 1e6);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    int maxThreads = argc > 1 ? std::atoi(argv[1]) : (int)std::thread::hardware_concurrency();
+    if (maxThreads < 1) maxThreads = 1;
+    const int episodes = 2000;
+
+    printf("NUMA nodes: %d\n", CpuTopology::Get().NodeCount());
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        Run(threads, episodes, true, false);
+        Run(threads, episodes, false, false);
+        Run(threads, episodes, false, true);
+    }
+    return 0;
+}
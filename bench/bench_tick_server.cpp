@@ -0,0 +1,251 @@
+// Tick server under load: the server runs on its own thread, and N bots on
+// loopback join, steer at random and acknowledge every tick. A few of them
+// keep a full WorldView and ask for a keyframe now and then, which is
+// compared against what their deltas built. One more socket joins without
+// answering the challenge, as a spoofed source would, and must never see
+// a state message.
+// Build: make bench (Linux)
+// Run:   build/bench_tick_server [bots] [seconds] [tick rate] [width] [height]
+
+#include "TickServer.h"
+#include "WorldView.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstring>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+const int VIEW_BOTS = 4;
+const int KEYFRAME_CHECK_TICKS = 100;
+
+struct Bot {
+    int fd;
+    bool joined;
+    uint16_t id;
+    uint32_t token;
+    uint32_t sequence;
+    uint8_t history[TICK_INPUT_BATCH];
+    uint32_t rng;
+    uint64_t deltas;
+    uint64_t bytes;
+    std::unique_ptr<WorldView> view;
+};
+
+static uint32_t NextRandom(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static void SendMessage(Bot& bot, uint8_t type, uint8_t flags) {
+    TickClientMessage message;
+    std::memset(&message, 0, sizeof(message));
+    message.magic = TICK_MAGIC;
+    message.type = type;
+    message.flags = flags;
+    message.snakeId = bot.id;
+    message.token = bot.token;
+    message.lastSequence = bot.sequence;
+    message.count = (uint8_t)(bot.sequence < (uint32_t)TICK_INPUT_BATCH ? bot.sequence : TICK_INPUT_BATCH);
+    for (int i = 0; i < message.count; i++) {
+        uint32_t sequence = bot.sequence - message.count + 1 + i;
+        message.directions[i] = bot.history[sequence % TICK_INPUT_BATCH];
+    }
+    send(bot.fd, &message, sizeof(message), MSG_DONTWAIT);
+}
+
+int main(int argc, char** argv) {
+    int botCount = argc > 1 ? std::atoi(argv[1]) : 256;
+    double seconds = argc > 2 ? std::atof(argv[2]) : 5.0;
+    TickServerConfig config;
+    config.port = 0;
+    config.maxSessions = botCount;
+    if (argc > 3) config.tickRate = std::atoi(argv[3]);
+    if (argc > 4) config.width = std::atoi(argv[4]);
+    if (argc > 5) config.height = std::atoi(argv[5]);
+
+    TickServer server(config);
+    if (!server.Open()) {
+        perror("bench_tick_server: open");
+        return 1;
+    }
+    std::atomic<bool> running(true);
+    std::thread serverThread([&server, &running]() {
+        while (running.load(std::memory_order_relaxed)) {
+            server.Poll(20);
+        }
+    });
+
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(server.GetPort());
+
+    int epollFd = epoll_create1(0);
+    std::vector<Bot> bots(botCount);
+    for (int i = 0; i < botCount; i++) {
+        Bot& bot = bots[i];
+        bot.fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+        int bufferBytes = 1 << 20;
+        setsockopt(bot.fd, SOL_SOCKET, SO_RCVBUF, &bufferBytes, sizeof(bufferBytes));
+        connect(bot.fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        bot.joined = false;
+        bot.id = 0;
+        bot.token = 0;
+        bot.sequence = 0;
+        std::memset(bot.history, 0, sizeof(bot.history));
+        bot.rng = 2463534242u + (uint32_t)i * 7919u;
+        bot.deltas = 0;
+        bot.bytes = 0;
+        if (i < VIEW_BOTS) bot.view.reset(new WorldView(config.maxSessions));
+
+        epoll_event event;
+        event.events = EPOLLIN;
+        event.data.u32 = (uint32_t)i;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, bot.fd, &event);
+        SendMessage(bot, TICK_JOIN, 0);
+    }
+
+    Bot spoofed;
+    spoofed.fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+    connect(spoofed.fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    spoofed.id = 0;
+    spoofed.token = 0;
+    spoofed.sequence = 0;
+    SendMessage(spoofed, TICK_JOIN, 0);
+
+    std::vector<uint8_t> buffer(TICK_MAX_DATAGRAM);
+    std::vector<epoll_event> events(botCount);
+    auto start = std::chrono::steady_clock::now();
+    auto end = start + std::chrono::duration<double>(seconds);
+    uint64_t firstTick = 0;
+    uint64_t lastTick = 0;
+    uint64_t viewFailures = 0;
+
+    while (std::chrono::steady_clock::now() < end) {
+        int ready = epoll_wait(epollFd, events.data(), (int)events.size(), 50);
+        for (int e = 0; e < ready; e++) {
+            Bot& bot = bots[events[e].data.u32];
+            for (;;) {
+                ssize_t size = recv(bot.fd, buffer.data(), buffer.size(), MSG_DONTWAIT);
+                if (size < (ssize_t)sizeof(uint32_t) + 1) break;
+                uint8_t type = buffer[sizeof(uint32_t)];
+
+                if (type == TICK_CHALLENGE && size == (ssize_t)sizeof(TickWelcome) && !bot.joined) {
+                    // Echo the address cookie to get a slot
+                    TickWelcome challenge;
+                    std::memcpy(&challenge, buffer.data(), sizeof(challenge));
+                    bot.token = challenge.token;
+                    SendMessage(bot, TICK_JOIN, 0);
+                } else if (type == TICK_WELCOME && size == (ssize_t)sizeof(TickWelcome)) {
+                    TickWelcome welcome;
+                    std::memcpy(&welcome, buffer.data(), sizeof(welcome));
+                    bot.joined = true;
+                    bot.id = welcome.snakeId;
+                    bot.token = welcome.token;
+                } else if (type == TICK_KEYFRAME && bot.view) {
+                    bot.view->ApplyKeyframe(buffer.data(), (size_t)size);
+                } else if (type == TICK_DELTA && bot.joined) {
+                    uint32_t tick = 0;
+                    ReadStateTick(buffer.data(), (size_t)size, tick);
+                    bot.deltas++;
+                    bot.bytes += (uint64_t)size;
+                    if (firstTick == 0) firstTick = tick;
+                    if (tick > lastTick) lastTick = tick;
+
+                    uint8_t flags = 0;
+                    if (bot.view) {
+                        bool synced = bot.view->IsSynced();
+                        if (!bot.view->ApplyDelta(buffer.data(), (size_t)size)) {
+                            viewFailures += synced;
+                            flags = TICK_NEED_KEYFRAME;
+                        } else if (tick % KEYFRAME_CHECK_TICKS == 0) {
+                            flags = TICK_NEED_KEYFRAME;
+                        }
+                    }
+
+                    // Turn about every fifth tick; every tick acknowledges as a keepalive
+                    if (NextRandom(bot.rng) % 5 == 0) {
+                        bot.sequence++;
+                        bot.history[bot.sequence % TICK_INPUT_BATCH] = (uint8_t)(NextRandom(bot.rng) & 3);
+                    }
+                    SendMessage(bot, TICK_INPUT, flags);
+                }
+            }
+        }
+        for (Bot& bot : bots) {
+            if (!bot.joined && NextRandom(bot.rng) % 20 == 0) SendMessage(bot, TICK_JOIN, 0);
+        }
+    }
+
+    running.store(false);
+    serverThread.join();
+
+    uint64_t spoofedStates = 0;
+    for (;;) {
+        ssize_t size = recv(spoofed.fd, buffer.data(), buffer.size(), MSG_DONTWAIT);
+        if (size < (ssize_t)sizeof(uint32_t) + 1) break;
+        uint8_t type = buffer[sizeof(uint32_t)];
+        spoofedStates += type == TICK_DELTA || type == TICK_KEYFRAME;
+    }
+    close(spoofed.fd);
+
+    int joined = 0;
+    uint64_t deltas = 0;
+    uint64_t bytes = 0;
+    for (Bot& bot : bots) {
+        joined += bot.joined;
+        deltas += bot.deltas;
+        bytes += bot.bytes;
+        close(bot.fd);
+    }
+    close(epollFd);
+
+    const TickServerStats& stats = server.GetStats();
+    uint64_t ticks = lastTick >= firstTick && firstTick > 0 ? lastTick - firstTick + 1 : 0;
+    printf("server: %d/%d bots joined, %llu ticks at %d Hz on %dx%d\n", joined, botCount,
+           (unsigned long long)stats.ticks, config.tickRate, config.width, config.height);
+    printf("tick:   %.1f us avg, %.1f us max (step + encode + sendmmsg)\n",
+           stats.ticks ? stats.tickNanos / 1e3 / stats.ticks : 0.0, stats.maxTickNanos / 1e3);
+    printf("out:    %.1f KB/tick total, %.0f B/tick per session, %llu keyframes, %llu send drops\n",
+           stats.ticks ? stats.bytesOut / 1024.0 / stats.ticks : 0.0, deltas ? (double)bytes / deltas : 0.0,
+           (unsigned long long)stats.keyframeSends, (unsigned long long)stats.sendDrops);
+    printf("bots:   %.1f%% of deltas received, %llu datagrams in at the server, %llu challenges\n",
+           ticks && joined ? 100.0 * deltas / ((double)ticks * joined) : 0.0,
+           (unsigned long long)stats.datagramsIn, (unsigned long long)stats.challenges);
+
+    uint64_t mismatches = 0;
+    int synced = 0;
+    for (int i = 0; i < VIEW_BOTS && i < botCount; i++) {
+        mismatches += bots[i].view->GetKeyframeMismatches();
+        synced += bots[i].view->IsSynced();
+    }
+    printf("views:  %d/%d synced, %llu keyframe mismatches, %llu gaps\n", synced,
+           VIEW_BOTS < botCount ? VIEW_BOTS : botCount, (unsigned long long)mismatches,
+           (unsigned long long)viewFailures);
+    printf("spoof:  %llu state messages to a join that never echoed its challenge\n",
+           (unsigned long long)spoofedStates);
+    return mismatches == 0 && spoofedStates == 0 ? 0 : 1;
+}
+
+#else
+
+int main() {
+    printf("bench_tick_server needs Linux (epoll, recvmmsg, sendmmsg)\n");
+    return 0;
+}
+
+#endif
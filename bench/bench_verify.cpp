@@ -0,0 +1,108 @@
+// Re-simulates a backlog of leaderboard replays on the work-stealing pool,
+// with a few tampered ones mixed in, for 1..N threads.
+// Build: mingw32-make bench   Run: build/bench_verify [replays] [maxThreads]
+
+#include "ReplayVerifier.h"
+#include "Simulation.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+using Sim = Simulation<Board<20, 20>, ClassicRules>;
+
+static uint32_t NextRandom(uint32_t& rng) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+// Same mix as bench_runner: mostly chases food, sometimes wanders off
+static Direction MixedPolicy(const Sim& sim, uint32_t& rng) {
+    unsigned mask = sim.GetActionMask();
+    if ((NextRandom(rng) & 255) == 0) return static_cast<Direction>((rng >> 8) & 3);
+
+    const auto& board = sim.GetBoard();
+    int head = sim.GetHeadCell();
+    int food = sim.GetFoodCell() >= 0 ? sim.GetFoodCell() : head;
+    int dx = board.X(food) - board.X(head);
+    int dy = board.Y(food) - board.Y(head);
+
+    Direction preferred[4] = {dx > 0 ? RIGHT : LEFT, dy > 0 ? DOWN : UP,
+                              dx > 0 ? LEFT : RIGHT, dy > 0 ? UP : DOWN};
+    for (Direction dir : preferred) {
+        if ((mask >> (4 + dir)) & 1) return dir;
+    }
+    return sim.GetDirection();
+}
+
+// One replay in 64 is doctored: an inflated score, a flipped input, or
+// inputs that carry on past the death
+static int Tamper(Replay& replay, uint32_t& rng) {
+    if ((NextRandom(rng) & 63) != 0) return 0;
+
+    switch ((rng >> 8) % 3) {
+    case 0:
+        replay.score += 10;
+        break;
+    case 1: {
+        size_t i = (rng >> 16) % replay.actions.size();
+        replay.actions[i] ^= 2;
+        break;
+    }
+    default:
+        replay.actions.push_back(replay.actions.back());
+        replay.actions.push_back(replay.actions.back());
+        break;
+    }
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    int count = argc > 1 ? std::atoi(argv[1]) : 100000;
+    int maxThreads = argc > 2 ? std::atoi(argv[2]) : (int)std::thread::hardware_concurrency();
+    if (count < 1) count = 1;
+    if (maxThreads < 1) maxThreads = 1;
+    const uint64_t maxTicks = 5000;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Replay> replays;
+    replays.reserve(count);
+    uint32_t tamperRng = 0x2545F491;
+    int tampered = 0;
+    uint64_t inputs = 0;
+
+    Sim sim;
+    for (int i = 0; i < count; i++) {
+        uint64_t seed = 1 + (uint64_t)i;
+        uint32_t rng = (uint32_t)(seed * 0x9E3779B97F4A7C15ULL >> 32) | 1;
+        ReplayRecorder<Sim> recorder(sim, seed, "bench");
+        while (sim.GetTick() < maxTicks && recorder.Step(MixedPolicy(sim, rng))) {
+        }
+        replays.push_back(recorder.Finish());
+        tampered += Tamper(replays.back(), tamperRng);
+        inputs += replays.back().actions.size();
+    }
+    double recordSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("recorded %d replays (%llu inputs, %.1f MB raw) in %.2f s, %d tampered\n", count,
+           (unsigned long long)inputs, inputs / 1e6, recordSeconds, tampered);
+
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        ThreadPool pool(threads);
+        ReplayVerifier<Sim> verifier(pool);
+
+        start = std::chrono::steady_clock::now();
+        std::vector<ReplayVerdict> verdicts = verifier.VerifyAll(replays);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        int counts[4] = {0, 0, 0, 0};
+        for (ReplayVerdict verdict : verdicts) {
+            counts[verdict]++;
+        }
+        printf("threads %2d  %9.0f replays/s  %7.2f Mticks/s  ok %d  died early %d  score %d  hash %d\n",
+               threads, count / seconds, verifier.GetTicksSimulated() / seconds / 1e6, counts[REPLAY_OK],
+               counts[REPLAY_DIED_EARLY], counts[REPLAY_SCORE_MISMATCH], counts[REPLAY_HASH_MISMATCH]);
+    }
+    return 0;
+}
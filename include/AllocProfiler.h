@@ -0,0 +1,105 @@
+#ifndef ALLOCPROFILER_H
+#define ALLOCPROFILER_H
+
+#include <cstdint>
+#include <cstdio>
+
+// Heap allocation counting for profiling builds. Compile with
+// -DSNAKE_PROFILE_ALLOCS (mingw32-make profile) to replace the global
+// operator new and enable the macros below; otherwise they compile away.
+//
+//     PROFILE_ALLOCS(ALLOC_SNAKE);   // charge this scope's allocations to Snake
+//     ASSERT_NO_ALLOCS();            // abort if this scope allocates at all
+
+enum AllocScopeId {
+    ALLOC_UPDATE,
+    ALLOC_DRAW,
+    ALLOC_SNAKE,
+    ALLOC_FOOD,
+    ALLOC_POWERUP,
+    ALLOC_SOUND
+};
+
+const int ALLOC_SCOPE_COUNT = 6;
+
+struct AllocCounts {
+    uint64_t allocations;
+    uint64_t bytes;
+};
+
+struct AllocScopeStats {
+    uint64_t calls;
+    uint64_t allocations;
+    uint64_t bytes;
+};
+
+#ifdef SNAKE_PROFILE_ALLOCS
+
+class AllocProfiler {
+public:
+    // Allocations made so far by the calling thread
+    static AllocCounts ThreadCounts();
+
+    static void Record(AllocScopeId id, const AllocCounts& delta);
+    static const AllocScopeStats& GetScopeStats(AllocScopeId id);
+    static const char* GetScopeName(AllocScopeId id);
+    static void Reset();
+    static void Report(FILE* out);
+
+    [[noreturn]] static void FailNoAllocs(const char* file, int line, const AllocCounts& delta);
+};
+
+// Scopes nest and are inclusive: a Snake::Move inside Game::Update counts
+// towards both ALLOC_SNAKE and ALLOC_UPDATE
+class AllocScope {
+private:
+    AllocScopeId id;
+    AllocCounts start;
+
+public:
+    explicit AllocScope(AllocScopeId id) : id(id), start(AllocProfiler::ThreadCounts()) {}
+
+    ~AllocScope() {
+        AllocCounts now = AllocProfiler::ThreadCounts();
+        AllocProfiler::Record(id, {now.allocations - start.allocations, now.bytes - start.bytes});
+    }
+
+    AllocScope(const AllocScope&) = delete;
+    AllocScope& operator=(const AllocScope&) = delete;
+};
+
+class NoAllocGuard {
+private:
+    const char* file;
+    int line;
+    AllocCounts start;
+
+public:
+    NoAllocGuard(const char* file, int line)
+        : file(file), line(line), start(AllocProfiler::ThreadCounts()) {}
+
+    ~NoAllocGuard() {
+        AllocCounts now = AllocProfiler::ThreadCounts();
+        if (now.allocations != start.allocations) {
+            AllocProfiler::FailNoAllocs(file, line,
+                {now.allocations - start.allocations, now.bytes - start.bytes});
+        }
+    }
+
+    NoAllocGuard(const NoAllocGuard&) = delete;
+    NoAllocGuard& operator=(const NoAllocGuard&) = delete;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ALLOCS(id) AllocScope PROFILE_CONCAT(allocScope, __LINE__)(id)
+#define ASSERT_NO_ALLOCS() NoAllocGuard PROFILE_CONCAT(noAllocGuard, __LINE__)(__FILE__, __LINE__)
+
+#else
+
+#define PROFILE_ALLOCS(id) ((void)0)
+#define ASSERT_NO_ALLOCS() ((void)0)
+
+#endif
+
+#endif
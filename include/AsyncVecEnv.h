@@ -0,0 +1,129 @@
+#ifndef ASYNCVECENV_H
+#define ASYNCVECENV_H
+
+#include "ThreadPool.h"
+#include "VecEnv.h"
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+// Two VecEnv slots with their own observation/action/reward buffers. While
+// the agent runs inference on one slot, worker threads step the other:
+//
+//     for (int k = 0; ; k++) {
+//         int slot = k & 1;
+//         env.StepWait(slot);                               // obs ready
+//         for (int s = 0; s < env.Shards(); s++)            // games GetShardBegin(s)...
+//             Infer(env.GetObservations(slot, s), ...);     // overlaps the other slot
+//         env.StepAsync(slot, actions[slot]);
+//     }
+//
+// On a pinned pool each slot is split into one shard per NUMA node. A shard
+// is a VecEnv over its own range of games with its own buffers, built by a
+// worker on that node (so first touch places its pages there) and stepped
+// only by that node's workers, every step. An unpinned pool is one shard.
+template <typename SimT, typename T>
+class AsyncVecEnv {
+private:
+    struct Shard {
+        int node;
+        int begin;
+        std::vector<T> observations;
+        std::vector<float> rewards;
+        std::vector<uint8_t> dones;
+        std::vector<Direction> actions;
+        VecEnv<SimT, T> env;
+
+        Shard(int node, int begin, int games, uint64_t seed, const SimT& prototype, size_t stride)
+            : node(node), begin(begin), observations(games * stride), rewards(games, 0.0f), dones(games, 0),
+              actions(games, RIGHT), env(games, seed, observations.data(), prototype) {}
+    };
+
+    struct Slot {
+        std::vector<std::unique_ptr<Shard>> shards;
+        TaskGroup group;
+    };
+
+    struct BuildContext {
+        std::unique_ptr<Shard>* target;
+        int node;
+        int begin;
+        int games;
+        uint64_t seed;
+        const SimT* prototype;
+        size_t stride;
+    };
+
+    ThreadPool& pool;
+    std::unique_ptr<Slot> slots[2];
+    int gamesPerSlot;
+    int chunk;
+
+    static void BuildShard(void* context, int, int) {
+        const BuildContext& ctx = *static_cast<const BuildContext*>(context);
+        ctx.target->reset(new Shard(ctx.node, ctx.begin, ctx.games, ctx.seed, *ctx.prototype, ctx.stride));
+    }
+
+    static void StepChunk(void* context, int begin, int end) {
+        Shard* shard = static_cast<Shard*>(context);
+        shard->env.StepRange(begin, end, shard->actions.data(), shard->rewards.data(), shard->dones.data());
+    }
+
+public:
+    AsyncVecEnv(ThreadPool& pool, int gamesPerSlot, uint64_t seed,
+                const SimT& prototype = SimT(), int chunk = 64)
+        : pool(pool), gamesPerSlot(gamesPerSlot), chunk(chunk) {
+        size_t stride = (size_t)OBS_CHANNEL_COUNT * prototype.GetBoard().Cells();
+        int shards = std::min(pool.NodeCount(), std::max(gamesPerSlot, 1));
+
+        // Offset the second slot's seeds so the two halves never share
+        // episodes, and each shard's so no two shards do
+        std::vector<BuildContext> contexts;
+        contexts.reserve(2 * shards);
+        TaskGroup built;
+        for (int s = 0; s < 2; s++) {
+            slots[s].reset(new Slot());
+            slots[s]->shards.resize(shards);
+            for (int k = 0; k < shards; k++) {
+                int begin = (int)((int64_t)gamesPerSlot * k / shards);
+                int end = (int)((int64_t)gamesPerSlot * (k + 1) / shards);
+                uint64_t shardSeed = seed + ((uint64_t)s << 40) + ((uint64_t)k << 32);
+                contexts.push_back({&slots[s]->shards[k], k, begin, end - begin, shardSeed, &prototype, stride});
+                pool.ParallelForNode(built, k, 1, 1, &AsyncVecEnv::BuildShard, &contexts.back());
+            }
+        }
+        built.Wait();
+    }
+
+    ~AsyncVecEnv() {
+        slots[0]->group.Wait();
+        slots[1]->group.Wait();
+    }
+
+    // Copies the actions and returns immediately; workers step the slot
+    void StepAsync(int slot, const Direction* actions) {
+        Slot& s = *slots[slot];
+        s.group.Wait();
+        for (auto& shard : s.shards) {
+            std::copy(actions + shard->begin, actions + shard->begin + shard->actions.size(), shard->actions.begin());
+            pool.ParallelForNode(s.group, shard->node, (int)shard->actions.size(), chunk,
+                                 &AsyncVecEnv::StepChunk, shard.get());
+        }
+    }
+
+    // Blocks until the slot's last StepAsync has finished
+    void StepWait(int slot) { slots[slot]->group.Wait(); }
+
+    // Shard k holds games [GetShardBegin(k), GetShardBegin(k) + GetShardSize(k))
+    int Shards() const { return (int)slots[0]->shards.size(); }
+    int GetShardBegin(int shard) const { return slots[0]->shards[shard]->begin; }
+    int GetShardSize(int shard) const { return (int)slots[0]->shards[shard]->actions.size(); }
+
+    const T* GetObservations(int slot, int shard) const { return slots[slot]->shards[shard]->observations.data(); }
+    const float* GetRewards(int slot, int shard) const { return slots[slot]->shards[shard]->rewards.data(); }
+    const uint8_t* GetDones(int slot, int shard) const { return slots[slot]->shards[shard]->dones.data(); }
+    const VecEnv<SimT, T>& GetEnv(int slot, int shard) const { return slots[slot]->shards[shard]->env; }
+    int GamesPerSlot() const { return gamesPerSlot; }
+};
+
+#endif
@@ -0,0 +1,396 @@
+#ifndef BATCHSIMULATION_H
+#define BATCHSIMULATION_H
+
+#include "Board.h"
+#include "GameTypes.h"
+#include "Random.h"
+#include "Simulation.h"
+#include <cstdint>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+// LANES games stored structure-of-arrays and advanced in lockstep with
+// ClassicRules (the rules in Game::CheckCollisions). Direction, movement,
+// wall, tail, head and eat logic is branch-free lane-parallel arithmetic.
+// Ring slots and bitboard words are read with explicit gathers, 16 lanes
+// at a time with AVX-512 and 8 with AVX2, and written back with AVX-512
+// scatters (plain stores otherwise). Food and power-up spawns draw from a vectorised
+// per-lane RNG, running one rejection-sampling round for all spawning lanes
+// at once; only invincible overlaps and dense-board spawns drop to scalar
+// code.
+//
+// DATA STRUCTURE: Body rings and bitboards stored slot-major, lane-minor
+// (body[slot][lane], occupancy[word][lane])
+// WHY: The tail, head and occupancy accesses of all lanes in one step are
+// then LANES adjacent columns instead of LANES separate per-game arrays
+//
+// Given the same seed and actions, lane i reproduces
+// Simulation<Board<W, H>, ClassicRules> exactly (bench_batch checks this
+// before it times anything).
+template <int W, int H, int LANES = 8>
+class BatchSimulation {
+private:
+    using Growth = ClassicRules::Growth;
+    using Scoring = ClassicRules::Scoring;
+    using PowerUps = ClassicRules::PowerUps;
+
+    static constexpr int CELLS = W * H;
+    static constexpr int WORDS = (CELLS + 31) / 32;
+    static constexpr int SPAWN_TICKS = Simulation<Board<W, H>>::POWERUP_SPAWN_TICKS;
+    static constexpr int DURATION_TICKS = Simulation<Board<W, H>>::POWERUP_DURATION_TICKS;
+
+    alignas(64) int32_t headX[LANES];
+    alignas(64) int32_t headY[LANES];
+    alignas(64) int32_t direction[LANES];
+    alignas(64) int32_t length[LANES];
+    alignas(64) int32_t pendingGrowth[LANES];
+    alignas(64) int32_t overlaps[LANES];
+    alignas(64) int32_t headIndex[LANES];
+    alignas(64) int32_t foodCell[LANES];
+    alignas(64) int32_t powerUpCell[LANES];
+    alignas(64) int32_t powerUpType[LANES];
+    alignas(64) int32_t spawnTimer[LANES];
+    alignas(64) int32_t activeTicks[POWERUP_TYPE_COUNT][LANES];
+    alignas(64) int32_t score[LANES];
+    alignas(64) int32_t alive[LANES];
+    Xoshiro128PlusLanes<LANES> rng;
+
+    // Per-lane scratch for the current step
+    alignas(64) int32_t nextCell[LANES];
+    alignas(64) int32_t dies[LANES];
+
+    alignas(64) uint32_t occupancy[WORDS][LANES];
+    alignas(64) int32_t body[CELLS][LANES];
+
+    uint32_t NextRandom(int lane) {
+        alignas(64) uint32_t draw[LANES];
+        rng.NextMasked(1u << lane, draw);
+        return draw[lane];
+    }
+
+    bool Test(int lane, int cell) const { return (occupancy[cell >> 5][lane] >> (cell & 31)) & 1; }
+    void Set(int lane, int cell) { occupancy[cell >> 5][lane] |= 1u << (cell & 31); }
+
+    int BodyIndex(int lane, int i) const {
+        int index = headIndex[lane] + i;
+        return index >= CELLS ? index - CELLS : index;
+    }
+
+    // Only used to lay out a new game; Step() pushes for all lanes at once
+    void PushHead(int lane, int cell) {
+        headIndex[lane] = headIndex[lane] == 0 ? CELLS - 1 : headIndex[lane] - 1;
+        body[headIndex[lane]][lane] = cell;
+        length[lane]++;
+        Set(lane, cell);
+    }
+
+    // Invincible snakes may pass through themselves; the tail bit stays
+    // set (and one overlap is used up) while another copy of the cell is
+    // still in the body
+    bool TailStillOccupied(int lane, int tail) {
+        for (int i = 0; i < length[lane]; i++) {
+            if (body[BodyIndex(lane, i)][lane] == tail) {
+                overlaps[lane]--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool IsFree(int lane, int cell) const {
+        return !Test(lane, cell) && cell != foodCell[lane] && cell != powerUpCell[lane];
+    }
+
+    // Same draw sequence per lane as Simulation::RandomFreeCell, but every
+    // lane in 'mask' runs its rejection rounds together on the lane RNG
+    void SpawnMasked(uint32_t mask, int32_t* target) {
+        alignas(64) uint32_t draw[LANES];
+        uint32_t searching = mask;
+
+        for (int attempt = 0; attempt < 16 && searching; attempt++) {
+            rng.NextMasked(searching, draw);
+            for (int lane = 0; lane < LANES; lane++) {
+                if (!((searching >> lane) & 1)) continue;
+                int cell = (int)RandomBelow(draw[lane], (uint32_t)CELLS);
+                if (IsFree(lane, cell)) {
+                    target[lane] = cell;
+                    searching &= ~(1u << lane);
+                }
+            }
+        }
+
+        for (int lane = 0; lane < LANES; lane++) {
+            if ((searching >> lane) & 1) target[lane] = ScanFreeCell(lane);
+        }
+    }
+
+    // Dense-board fallback once rejection sampling has failed 16 times
+    int ScanFreeCell(int lane) {
+        auto isFree = [&](int cell) { return IsFree(lane, cell); };
+
+        int freeCount = 0;
+        for (int cell = 0; cell < CELLS; cell++) {
+            freeCount += isFree(cell);
+        }
+        if (freeCount == 0) return -1;
+
+        int target = (int)RandomBelow(NextRandom(lane), (uint32_t)freeCount);
+        for (int cell = 0; cell < CELLS; cell++) {
+            if (isFree(cell) && target-- == 0) return cell;
+        }
+        return -1;
+    }
+
+    // out[l] = table[row[l]][l] for a [rows][LANES] table of 32-bit
+    // values: one gather per 16 (AVX-512) or 8 (AVX2) lanes
+    static void GatherColumns(const void* table, const int32_t* row, int32_t* out) {
+        const int32_t* cells = static_cast<const int32_t*>(table);
+        int lane = 0;
+#ifdef __AVX512F__
+        const __m512i laneIndex16 = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+        for (; lane + 16 <= LANES; lane += 16) {
+            __m512i index = _mm512_add_epi32(_mm512_mullo_epi32(_mm512_load_si512(&row[lane]), _mm512_set1_epi32(LANES)),
+                                              _mm512_add_epi32(laneIndex16, _mm512_set1_epi32(lane)));
+            // Masked form for the same GCC 12 warning as in Random.h
+            _mm512_store_si512(&out[lane], _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), 0xFFFF, index, table, 4));
+        }
+#endif
+#ifdef __AVX2__
+        const __m256i laneIndex = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        for (; lane + 8 <= LANES; lane += 8) {
+            __m256i rows = _mm256_load_si256(reinterpret_cast<const __m256i*>(&row[lane]));
+            __m256i index = _mm256_add_epi32(_mm256_mullo_epi32(rows, _mm256_set1_epi32(LANES)),
+                                             _mm256_add_epi32(laneIndex, _mm256_set1_epi32(lane)));
+            _mm256_store_si256(reinterpret_cast<__m256i*>(&out[lane]), _mm256_i32gather_epi32(cells, index, 4));
+        }
+#endif
+        for (; lane < LANES; lane++) {
+            out[lane] = cells[row[lane] * LANES + lane];
+        }
+    }
+
+    // table[row[l]][l] = value[l]. Every lane writes its own column, so
+    // the scatter never has two lanes on one address.
+    static void ScatterColumns(void* table, const int32_t* row, const int32_t* value) {
+        int32_t* cells = static_cast<int32_t*>(table);
+        int lane = 0;
+#ifdef __AVX512F__
+        const __m512i laneIndex16 = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+        for (; lane + 16 <= LANES; lane += 16) {
+            __m512i index = _mm512_add_epi32(_mm512_mullo_epi32(_mm512_load_si512(&row[lane]), _mm512_set1_epi32(LANES)),
+                                              _mm512_add_epi32(laneIndex16, _mm512_set1_epi32(lane)));
+            _mm512_i32scatter_epi32(table, index, _mm512_load_si512(&value[lane]), 4);
+        }
+#endif
+        for (; lane < LANES; lane++) {
+            cells[row[lane] * LANES + lane] = value[lane];
+        }
+    }
+
+public:
+    static constexpr int LANE_COUNT = LANES;
+
+    BatchSimulation() {
+        for (int lane = 0; lane < LANES; lane++) ResetLane(lane, lane + 1);
+    }
+
+    void ResetLane(int lane, uint64_t seed) {
+        for (int word = 0; word < WORDS; word++) occupancy[word][lane] = 0;
+        headIndex[lane] = 0;
+        length[lane] = 0;
+        pendingGrowth[lane] = 0;
+        overlaps[lane] = 0;
+        direction[lane] = RIGHT;
+        foodCell[lane] = -1;
+        powerUpCell[lane] = -1;
+        powerUpType[lane] = SPEED_BOOST;
+        spawnTimer[lane] = 0;
+        for (int i = 0; i < POWERUP_TYPE_COUNT; i++) activeTicks[i][lane] = 0;
+        score[lane] = 0;
+        alive[lane] = 1;
+
+        rng.Seed(lane, seed);
+
+        int cx = W / 2;
+        int cy = H / 2;
+        PushHead(lane, cy * W + cx - 2);
+        PushHead(lane, cy * W + cx - 1);
+        PushHead(lane, cy * W + cx);
+        headX[lane] = cx;
+        headY[lane] = cy;
+
+        SpawnMasked(1u << lane, foodCell);
+    }
+
+    // Advances every live lane one move. Returns a bitmask of lanes that
+    // are still alive afterwards; dead lanes stay put until ResetLane().
+    uint32_t Step(const Direction* actions) {
+        ASSERT_NO_ALLOCS();
+        PERF_SCOPE(PERF_REGION_BATCH_STEP);
+        alignas(64) int32_t invincible[LANES];
+        alignas(64) int32_t live[LANES];
+        alignas(64) int32_t row[LANES];
+        alignas(64) int32_t word[LANES];
+
+        // Phase 1 (vectorised): turn, move, walls
+        for (int lane = 0; lane < LANES; lane++) {
+            int32_t action = actions[lane];
+            int32_t dir = direction[lane];
+            // UP^DOWN == LEFT^RIGHT == 1, so a reversal is exactly xor == 1
+            dir = ((dir ^ action) == 1) ? dir : action;
+            direction[lane] = dir;
+
+            int32_t x = headX[lane] + (dir == RIGHT) - (dir == LEFT);
+            int32_t y = headY[lane] + (dir == DOWN) - (dir == UP);
+            int32_t outside = (x < 0) | (x >= W) | (y < 0) | (y >= H);
+            int32_t inv = activeTicks[INVINCIBILITY][lane] > 0;
+
+            // Invincible snakes wrap, as in DieAtWalls
+            x += W & -(x < 0);
+            x -= W & -(x >= W);
+            y += H & -(y < 0);
+            y -= H & -(y >= H);
+
+            invincible[lane] = inv;
+            dies[lane] = (outside & (inv ^ 1)) | (alive[lane] ^ 1);
+            nextCell[lane] = dies[lane] ? -1 : y * W + x;
+            headX[lane] = dies[lane] ? headX[lane] : x;
+            headY[lane] = dies[lane] ? headY[lane] : y;
+        }
+
+        // Phase 2 (vectorised, ring columns): tail leaves before the head
+        // arrives. Lanes with pending growth keep their tail.
+        alignas(64) int32_t tailCell[LANES];
+        alignas(64) int32_t clearTail[LANES];
+        int32_t anyOverlap = 0;
+        for (int lane = 0; lane < LANES; lane++) {
+            int32_t moves = dies[lane] ^ 1;
+            int32_t pop = moves & (pendingGrowth[lane] == 0);
+            pendingGrowth[lane] -= moves & (pop ^ 1);
+
+            int32_t slot = headIndex[lane] + length[lane] - 1;
+            slot -= CELLS & -(slot >= CELLS);
+            row[lane] = slot;
+            length[lane] -= pop;
+            clearTail[lane] = pop;
+            anyOverlap |= pop & (overlaps[lane] > 0);
+        }
+        GatherColumns(body, row, tailCell);
+        if (anyOverlap) {
+            for (int lane = 0; lane < LANES; lane++) {
+                if (clearTail[lane] && overlaps[lane] > 0) {
+                    clearTail[lane] = !TailStillOccupied(lane, tailCell[lane]);
+                }
+            }
+        }
+        for (int lane = 0; lane < LANES; lane++) row[lane] = tailCell[lane] >> 5;
+        GatherColumns(occupancy, row, word);
+        for (int lane = 0; lane < LANES; lane++) {
+            word[lane] &= (int32_t)~((uint32_t)clearTail[lane] << (tailCell[lane] & 31));
+        }
+        ScatterColumns(occupancy, row, word);
+
+        // Phase 3 (gather): self-collision against the per-lane bitboards.
+        // Dead lanes look at cell 0 and ignore the answer.
+        for (int lane = 0; lane < LANES; lane++) {
+            row[lane] = (nextCell[lane] & -(nextCell[lane] >= 0)) >> 5;
+        }
+        GatherColumns(occupancy, row, word);
+        for (int lane = 0; lane < LANES; lane++) {
+            int32_t bit = nextCell[lane] & 31;
+            int32_t occupied = (dies[lane] ^ 1) & ((uint32_t)word[lane] >> bit) & 1;
+            overlaps[lane] += occupied & invincible[lane];
+            dies[lane] |= occupied & (invincible[lane] ^ 1);
+            alive[lane] &= dies[lane] ^ 1;
+            live[lane] = dies[lane] ^ 1;
+            word[lane] |= (int32_t)((uint32_t)live[lane] << bit);
+        }
+        ScatterColumns(occupancy, row, word);
+
+        // Head push: dead lanes rewrite their current head slot unchanged
+        alignas(64) int32_t headCell[LANES];
+        GatherColumns(body, headIndex, headCell);
+        for (int lane = 0; lane < LANES; lane++) {
+            int32_t index = headIndex[lane] - live[lane];
+            index += CELLS & -(index < 0);
+            headIndex[lane] = index;
+            headCell[lane] = live[lane] ? nextCell[lane] : headCell[lane];
+            length[lane] += live[lane];
+        }
+        ScatterColumns(body, headIndex, headCell);
+
+        // Phase 4 (vectorised, masked): timers, eating, scoring
+        for (int i = 0; i < POWERUP_TYPE_COUNT; i++) {
+            for (int lane = 0; lane < LANES; lane++) {
+                activeTicks[i][lane] -= (activeTicks[i][lane] > 0) & live[lane];
+            }
+        }
+        alignas(64) int32_t eats[LANES];
+        for (int lane = 0; lane < LANES; lane++) {
+            int32_t boosted = activeTicks[SCORE_MULTIPLIER][lane] > 0;
+            eats[lane] = live[lane] & (nextCell[lane] == foodCell[lane]);
+            pendingGrowth[lane] += eats[lane] * Growth::AMOUNT;
+            int32_t room = CELLS - length[lane];  // as Simulation: never overrun the ring
+            pendingGrowth[lane] = pendingGrowth[lane] < room ? pendingGrowth[lane] : room;
+            score[lane] += eats[lane] * Scoring::Points(boosted);
+        }
+
+        // Phase 5 (masked lane RNG): food respawns, then power-ups
+        uint32_t aliveMask = 0;
+        uint32_t eatMask = 0;
+        for (int lane = 0; lane < LANES; lane++) {
+            aliveMask |= (uint32_t)live[lane] << lane;
+            eatMask |= (uint32_t)eats[lane] << lane;
+            foodCell[lane] = eats[lane] ? -1 : foodCell[lane];
+        }
+        if (eatMask) SpawnMasked(eatMask, foodCell);
+
+        // Dead lanes have nextCell -1, which must not match an absent power-up
+        alignas(64) int32_t takes[LANES];
+        alignas(64) int32_t spawns[LANES];
+        for (int lane = 0; lane < LANES; lane++) {
+            int32_t take = live[lane] & (nextCell[lane] == powerUpCell[lane]);
+            int32_t waiting = live[lane] & (take ^ 1) & (powerUpCell[lane] < 0);
+            spawnTimer[lane] += waiting;
+            int32_t spawn = waiting & (spawnTimer[lane] >= SPAWN_TICKS);
+            spawnTimer[lane] = (take | spawn) ? 0 : spawnTimer[lane];
+            powerUpCell[lane] = take ? -1 : powerUpCell[lane];
+            takes[lane] = take;
+            spawns[lane] = spawn;
+        }
+        uint32_t takeMask = 0;
+        uint32_t spawnMask = 0;
+        for (int lane = 0; lane < LANES; lane++) {
+            takeMask |= (uint32_t)takes[lane] << lane;
+            spawnMask |= (uint32_t)spawns[lane] << lane;
+        }
+        for (int lane = 0; takeMask != 0 && lane < LANES; lane++) {
+            if ((takeMask >> lane) & 1) activeTicks[powerUpType[lane]][lane] = DURATION_TICKS;
+        }
+        if (spawnMask) {
+            alignas(64) uint32_t draw[LANES];
+            SpawnMasked(spawnMask, powerUpCell);
+            rng.NextMasked(spawnMask, draw);
+            for (int lane = 0; lane < LANES; lane++) {
+                if ((spawnMask >> lane) & 1) {
+                    powerUpType[lane] = (int32_t)PowerUps::Pick(RandomBelow(draw[lane], PowerUps::COUNT));
+                }
+            }
+        }
+
+        return aliveMask;
+    }
+
+    bool IsAlive(int lane) const { return alive[lane] != 0; }
+    int GetScore(int lane) const { return score[lane]; }
+    int GetLength(int lane) const { return length[lane] + pendingGrowth[lane]; }
+    int GetHeadCell(int lane) const { return body[headIndex[lane]][lane]; }
+    int GetFoodCell(int lane) const { return foodCell[lane]; }
+    int GetPowerUpCell(int lane) const { return powerUpCell[lane]; }
+    bool IsOccupied(int lane, int cell) const { return Test(lane, cell); }
+    Direction GetDirection(int lane) const { return static_cast<Direction>(direction[lane]); }
+};
+
+#endif
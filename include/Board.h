@@ -0,0 +1,147 @@
+#ifndef BOARD_H
+#define BOARD_H
+
+#include "GameTypes.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// DATA STRUCTURE: Bitboard - one bit of occupancy per grid cell
+// WHY: Occupancy checks become a shift and a mask instead of scanning the body
+
+// Compile-time board: width, height and strides are constants, so index math
+// and bounds checks fold away and storage is a fixed std::array
+template <int W, int H>
+class Board {
+private:
+    static constexpr int CELLS = W * H;
+    static constexpr int WORDS = (CELLS + 63) / 64;
+
+    // Neighbour lookup is a table for tournament-sized boards and plain
+    // arithmetic for anything larger (keeps compile times sane)
+    static constexpr bool USE_NEIGHBOR_TABLE = CELLS <= 64 * 64;
+
+    static constexpr int ComputeNeighbor(int cell, int dir) {
+        int x = cell % W;
+        int y = cell / W;
+        switch (dir) {
+            case UP:    return y > 0     ? cell - W : -1;
+            case DOWN:  return y < H - 1 ? cell + W : -1;
+            case LEFT:  return x > 0     ? cell - 1 : -1;
+            case RIGHT: return x < W - 1 ? cell + 1 : -1;
+        }
+        return -1;
+    }
+
+    static constexpr std::array<std::array<int, 4>, USE_NEIGHBOR_TABLE ? CELLS : 1> BuildNeighborTable() {
+        std::array<std::array<int, 4>, USE_NEIGHBOR_TABLE ? CELLS : 1> table{};
+        if (USE_NEIGHBOR_TABLE) {
+            for (int cell = 0; cell < CELLS; cell++) {
+                table[cell] = {ComputeNeighbor(cell, UP), ComputeNeighbor(cell, DOWN),
+                               ComputeNeighbor(cell, LEFT), ComputeNeighbor(cell, RIGHT)};
+            }
+        }
+        return table;
+    }
+
+    static constexpr auto neighborTable = BuildNeighborTable();
+
+    std::array<uint64_t, WORDS> bits{};
+
+public:
+    static constexpr bool IS_STATIC = true;
+
+    constexpr int Width() const { return W; }
+    constexpr int Height() const { return H; }
+    constexpr int Cells() const { return CELLS; }
+    constexpr int Words() const { return WORDS; }
+
+    constexpr int Index(int x, int y) const { return y * W + x; }
+    constexpr int X(int cell) const { return cell % W; }
+    constexpr int Y(int cell) const { return cell / W; }
+
+    // Returns -1 when the step leaves the board
+    constexpr int Neighbor(int cell, Direction dir) const {
+        if constexpr (USE_NEIGHBOR_TABLE) {
+            return neighborTable[cell][dir];
+        } else {
+            return ComputeNeighbor(cell, dir);
+        }
+    }
+
+    constexpr int Wrap(int cell, Direction dir) const {
+        int x = cell % W;
+        int y = cell / W;
+        switch (dir) {
+            case UP:    y = (y + H - 1) % H; break;
+            case DOWN:  y = (y + 1) % H; break;
+            case LEFT:  x = (x + W - 1) % W; break;
+            case RIGHT: x = (x + 1) % W; break;
+        }
+        return y * W + x;
+    }
+
+    bool Test(int cell) const { return (bits[cell >> 6] >> (cell & 63)) & 1; }
+    void Set(int cell) { bits[cell >> 6] |= uint64_t(1) << (cell & 63); }
+    void Clear(int cell) { bits[cell >> 6] &= ~(uint64_t(1) << (cell & 63)); }
+    void Reset() { bits.fill(0); }
+
+    const uint64_t* Data() const { return bits.data(); }
+};
+
+// Runtime-dimension fallback with the same interface as Board<W, H>
+class DynamicBoard {
+private:
+    int width;
+    int height;
+    std::vector<uint64_t> bits;
+
+public:
+    static constexpr bool IS_STATIC = false;
+
+    DynamicBoard(int width, int height)
+        : width(width), height(height), bits((width * height + 63) / 64, 0) {}
+
+    int Width() const { return width; }
+    int Height() const { return height; }
+    int Cells() const { return width * height; }
+    int Words() const { return (int)bits.size(); }
+
+    int Index(int x, int y) const { return y * width + x; }
+    int X(int cell) const { return cell % width; }
+    int Y(int cell) const { return cell / width; }
+
+    int Neighbor(int cell, Direction dir) const {
+        int x = cell % width;
+        int y = cell / width;
+        switch (dir) {
+            case UP:    return y > 0          ? cell - width : -1;
+            case DOWN:  return y < height - 1 ? cell + width : -1;
+            case LEFT:  return x > 0          ? cell - 1 : -1;
+            case RIGHT: return x < width - 1  ? cell + 1 : -1;
+        }
+        return -1;
+    }
+
+    int Wrap(int cell, Direction dir) const {
+        int x = cell % width;
+        int y = cell / width;
+        switch (dir) {
+            case UP:    y = (y + height - 1) % height; break;
+            case DOWN:  y = (y + 1) % height; break;
+            case LEFT:  x = (x + width - 1) % width; break;
+            case RIGHT: x = (x + 1) % width; break;
+        }
+        return y * width + x;
+    }
+
+    bool Test(int cell) const { return (bits[cell >> 6] >> (cell & 63)) & 1; }
+    void Set(int cell) { bits[cell >> 6] |= uint64_t(1) << (cell & 63); }
+    void Clear(int cell) { bits[cell >> 6] &= ~(uint64_t(1) << (cell & 63)); }
+    void Reset() { std::fill(bits.begin(), bits.end(), 0); }
+
+    const uint64_t* Data() const { return bits.data(); }
+};
+
+#endif
@@ -0,0 +1,244 @@
+#ifndef COMPACTGAME_H
+#define COMPACTGAME_H
+
+#include "GameTypes.h"
+#include "Random.h"
+#include "Simulation.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Fixed-size record holding one complete headless game, for keeping around
+// a million small-board games in RAM at once. Same rules and RNG sequence as
+// Simulation<Board<W, H>, ClassicRules>.
+//
+// DATA STRUCTURE: Ring buffer of 2-bit moves plus head and tail cells
+// WHY: The body is rebuilt by walking moves from the tail, so it costs a
+// quarter byte per segment - a 20x20 game needs 100 bytes where even 1-byte
+// cell ids could not address all 400 cells
+template <int W, int H>
+struct CompactGame {
+    static constexpr int CELLS = W * H;
+    static constexpr int WORDS = (CELLS + 63) / 64;
+    static constexpr uint16_t NONE = 0xFFFF;
+    static_assert(CELLS < NONE, "cell ids must fit in 16 bits");
+
+    uint64_t occupancy[WORDS];
+    Xoshiro128Plus rng;
+    int32_t score;
+    uint32_t tick;
+    uint16_t head;
+    uint16_t tail;
+    uint16_t headSlot;       // ring slot of the most recent move
+    uint16_t moveCount;      // length - 1
+    uint16_t pendingGrowth;
+    uint16_t overlaps;
+    uint16_t food;
+    uint16_t powerUp;
+    uint8_t direction;
+    uint8_t alive;
+    uint8_t powerUpType;
+    uint8_t spawnTimer;
+    uint8_t activeTicks[POWERUP_TYPE_COUNT];
+    uint8_t moves[(CELLS * 2 + 7) / 8];
+
+    bool Test(int cell) const { return (occupancy[cell >> 6] >> (cell & 63)) & 1; }
+    void Set(int cell) { occupancy[cell >> 6] |= uint64_t(1) << (cell & 63); }
+    void Clear(int cell) { occupancy[cell >> 6] &= ~(uint64_t(1) << (cell & 63)); }
+
+    int GetMove(int slot) const { return (moves[slot >> 2] >> ((slot & 3) * 2)) & 3; }
+    void SetMove(int slot, int dir) {
+        int shift = (slot & 3) * 2;
+        moves[slot >> 2] = (uint8_t)((moves[slot >> 2] & ~(3 << shift)) | (dir << shift));
+    }
+
+    // Wraps at the edges: only an invincible snake ever crosses one, and
+    // the tail must then follow the same wrapped path
+    static int Offset(int cell, int dir) {
+        int x = cell % W;
+        switch (dir) {
+            case UP:    return cell >= W ? cell - W : cell + CELLS - W;
+            case DOWN:  return cell < CELLS - W ? cell + W : cell - CELLS + W;
+            case LEFT:  return x > 0 ? cell - 1 : cell + W - 1;
+            default:    return x < W - 1 ? cell + 1 : cell - W + 1;
+        }
+    }
+
+    int TailSlot() const {
+        int slot = headSlot - moveCount + 1;
+        return slot < 0 ? slot + CELLS : slot;
+    }
+
+    bool IsFree(int cell) const { return !Test(cell) && cell != food && cell != powerUp; }
+
+    uint16_t RandomFreeCell() {
+        for (int attempt = 0; attempt < 16; attempt++) {
+            int cell = (int)RandomBelow(rng.Next(), (uint32_t)CELLS);
+            if (IsFree(cell)) return (uint16_t)cell;
+        }
+
+        int freeCount = 0;
+        for (int cell = 0; cell < CELLS; cell++) freeCount += IsFree(cell);
+        if (freeCount == 0) return NONE;
+
+        int target = (int)RandomBelow(rng.Next(), (uint32_t)freeCount);
+        for (int cell = 0; cell < CELLS; cell++) {
+            if (IsFree(cell) && target-- == 0) return (uint16_t)cell;
+        }
+        return NONE;
+    }
+
+    void PopTail() {
+        int vacated = tail;
+        tail = (uint16_t)Offset(tail, GetMove(TailSlot()));
+        moveCount--;
+
+        if (overlaps > 0) {
+            int cell = tail;
+            int slot = TailSlot();
+            for (int i = 0; i <= moveCount; i++) {
+                if (cell == vacated) {
+                    overlaps--;
+                    return;
+                }
+                // The move at 'slot' leads from 'cell' to the next segment
+                if (i < moveCount) {
+                    cell = Offset(cell, GetMove(slot));
+                    slot = slot + 1 == CELLS ? 0 : slot + 1;
+                }
+            }
+        }
+        Clear(vacated);
+    }
+
+    void Reset(uint64_t seed) {
+        std::memset(this, 0, sizeof(*this));
+
+        rng.Seed(seed);
+
+        int start = (H / 2) * W + W / 2;
+        tail = (uint16_t)(start - 2);
+        head = (uint16_t)start;
+        SetMove(0, RIGHT);
+        SetMove(1, RIGHT);
+        headSlot = 1;
+        moveCount = 2;
+        Set(start - 2);
+        Set(start - 1);
+        Set(start);
+
+        direction = RIGHT;
+        alive = 1;
+        food = NONE;
+        powerUp = NONE;
+        food = RandomFreeCell();
+    }
+
+    bool Step(Direction action) {
+        using Sim = Simulation<Board<W, H>, ClassicRules>;
+        using PowerUps = ClassicRules::PowerUps;
+        if (!alive) return false;
+
+        if ((direction ^ action) != 1) direction = (uint8_t)action;
+        tick++;
+
+        bool invincible = activeTicks[INVINCIBILITY] > 0;
+        int x = head % W;
+        int y = head / W;
+        bool outside = (direction == UP && y == 0) || (direction == DOWN && y == H - 1) ||
+                       (direction == LEFT && x == 0) || (direction == RIGHT && x == W - 1);
+        if (outside && !invincible) {
+            alive = 0;
+            return false;
+        }
+        int next = Offset(head, direction);
+
+        if (pendingGrowth > 0) {
+            pendingGrowth--;
+        } else {
+            PopTail();
+        }
+
+        if (Test(next)) {
+            if (!invincible) {
+                alive = 0;
+                return false;
+            }
+            overlaps++;
+        }
+
+        headSlot = headSlot + 1 == CELLS ? 0 : headSlot + 1;
+        SetMove(headSlot, direction);
+        moveCount++;
+        head = (uint16_t)next;
+        Set(next);
+
+        for (int i = 0; i < POWERUP_TYPE_COUNT; i++) {
+            activeTicks[i] -= activeTicks[i] > 0;
+        }
+        bool boosted = activeTicks[SCORE_MULTIPLIER] > 0;
+
+        if (next == food) {
+            pendingGrowth += ClassicRules::Growth::AMOUNT;
+            // As Simulation: the move ring has one slot per cell
+            if (pendingGrowth > CELLS - (moveCount + 1)) pendingGrowth = (uint16_t)(CELLS - (moveCount + 1));
+            score += ClassicRules::Scoring::Points(boosted);
+            food = NONE;
+            food = RandomFreeCell();
+        }
+
+        if (next == powerUp) {
+            activeTicks[powerUpType] = Sim::POWERUP_DURATION_TICKS;
+            powerUp = NONE;
+            spawnTimer = 0;
+        } else if (powerUp == NONE && ++spawnTimer >= Sim::POWERUP_SPAWN_TICKS) {
+            powerUp = RandomFreeCell();
+            powerUpType = (uint8_t)PowerUps::Pick(RandomBelow(rng.Next(), PowerUps::COUNT));
+            spawnTimer = 0;
+        }
+        return true;
+    }
+
+    int GetLength() const { return moveCount + 1 + pendingGrowth; }
+    bool IsAlive() const { return alive != 0; }
+    Direction GetDirection() const { return static_cast<Direction>(direction); }
+};
+
+// One contiguous allocation holding every record: no per-game heap objects
+template <int W, int H>
+class CompactArena {
+private:
+    std::vector<CompactGame<W, H>> records;
+
+public:
+    CompactArena(size_t count, uint64_t seed) : records(count) {
+        for (size_t i = 0; i < count; i++) {
+            records[i].Reset(seed + i);
+        }
+    }
+
+    // Steps games [begin, end); a game that dies is reset in place, seeded
+    // from its own RNG state so the run stays reproducible. Returns deaths.
+    size_t StepRange(size_t begin, size_t end, const Direction* actions) {
+        size_t deaths = 0;
+        for (size_t i = begin; i < end; i++) {
+            CompactGame<W, H>& game = records[i];
+            if (!game.Step(actions[i])) {
+                game.Reset(game.rng.Next() ^ ((uint64_t)i << 32));
+                deaths++;
+            }
+        }
+        return deaths;
+    }
+
+    size_t Size() const { return records.size(); }
+    CompactGame<W, H>& Get(size_t i) { return records[i]; }
+    const CompactGame<W, H>& Get(size_t i) const { return records[i]; }
+
+    static constexpr size_t RecordBytes() { return sizeof(CompactGame<W, H>); }
+    size_t FootprintBytes() const { return records.size() * sizeof(CompactGame<W, H>); }
+};
+
+static_assert(sizeof(CompactGame<20, 20>) <= 512, "20x20 record must stay under 512 bytes");
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef CPUTOPOLOGY_H
+#define CPUTOPOLOGY_H
+
+#include <vector>
+
+struct NumaNode {
+    int id;
+    std::vector<int> cpus;
+};
+
+// NUMA layout of the host, read once from /sys on Linux. Other platforms
+// (and hosts without NUMA information) report a single node with every CPU.
+class CpuTopology {
+private:
+    std::vector<NumaNode> nodes;
+
+    CpuTopology();
+
+public:
+    static const CpuTopology& Get();
+
+    int NodeCount() const { return (int)nodes.size(); }
+    const std::vector<NumaNode>& GetNodes() const { return nodes; }
+
+    // Worker i goes to node i % nodes, so any thread count spreads evenly
+    // across sockets; returns the CPU and writes its node
+    int CpuForWorker(int worker, int& node) const;
+
+    // Pins the calling thread to one CPU; false if unsupported or refused
+    static bool PinCurrentThread(int cpu);
+};
+
+#endif
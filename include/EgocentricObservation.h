@@ -0,0 +1,183 @@
+#ifndef EGOCENTRICOBSERVATION_H
+#define EGOCENTRICOBSERVATION_H
+
+#include "GameTypes.h"
+#include "Observation.h"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+// K x K window centred on the head and rotated so the snake always faces
+// "up". Observation size (and agent inference cost) is independent of the
+// board, so it stays constant from 20x20 up to 1024x1024 boards.
+enum EgocentricChannel {
+    EGO_BODY,
+    EGO_WALL,      // cells outside the board (always clear under wrap rules)
+    EGO_FOOD,
+    EGO_POWERUP,
+    EGO_CHANNEL_COUNT
+};
+
+// Global features written alongside the window
+enum EgocentricFeature {
+    EGO_FOOD_FORWARD,    // food offset in the rotated frame, / board size
+    EGO_FOOD_RIGHT,
+    EGO_FOOD_DISTANCE,   // Manhattan distance, / (width + height)
+    EGO_LENGTH,          // length / cells
+    EGO_TIMER_SPEED,
+    EGO_TIMER_MULTIPLIER,
+    EGO_TIMER_INVINCIBLE,
+    EGO_FEATURE_COUNT
+};
+
+template <typename SimT, typename T>
+class EgocentricWriter {
+private:
+    int size;
+
+    // World step for one column (right) and one row (back) in the rotated
+    // frame, indexed by Direction
+    static constexpr int COLUMN_DX[4] = {1, -1, 0, 0};
+    static constexpr int COLUMN_DY[4] = {0, 0, -1, 1};
+    static constexpr int ROW_DX[4] = {0, 0, 1, -1};
+    static constexpr int ROW_DY[4] = {1, -1, 0, 0};
+
+    static T Value(float fraction) { return (T)(fraction * ObservationScale<T>::ONE); }
+
+    // Shortest offset along one axis of a torus
+    static int WrapOffset(int delta, int extent) {
+        if (2 * delta > extent) return delta - extent;
+        if (2 * delta < -extent) return delta + extent;
+        return delta;
+    }
+
+    static int WrapCoordinate(int value, int extent) {
+        value %= extent;
+        return value < 0 ? value + extent : value;
+    }
+
+    // Rotated-frame offset of a world cell relative to the head; under wrap
+    // rules the nearest copy of the cell across the edges
+    void ToEgocentric(const SimT& sim, int cell, int& right, int& back) const {
+        const auto& board = sim.GetBoard();
+        Direction dir = sim.GetDirection();
+        int dx = board.X(cell) - board.X(sim.GetHeadCell());
+        int dy = board.Y(cell) - board.Y(sim.GetHeadCell());
+        if constexpr (SimT::WRAPS) {
+            dx = WrapOffset(dx, board.Width());
+            dy = WrapOffset(dy, board.Height());
+        }
+        right = dx * COLUMN_DX[dir] + dy * COLUMN_DY[dir];
+        back = dx * ROW_DX[dir] + dy * ROW_DY[dir];
+    }
+
+    void MarkCell(const SimT& sim, int cell, T* plane) const {
+        if (cell < 0) return;
+        int right, back;
+        ToEgocentric(sim, cell, right, back);
+        int half = size / 2;
+
+        // A window wider than a wrapping board sees the cell once per copy,
+        // as it sees the body
+        if constexpr (SimT::WRAPS) {
+            const auto& board = sim.GetBoard();
+            bool vertical = sim.GetDirection() == UP || sim.GetDirection() == DOWN;
+            int rightPeriod = vertical ? board.Width() : board.Height();
+            int backPeriod = vertical ? board.Height() : board.Width();
+            while (right - rightPeriod >= -half) right -= rightPeriod;
+            while (back - backPeriod >= -half) back -= backPeriod;
+            for (int row = back + half; row < size; row += backPeriod) {
+                for (int col = right + half; col < size; col += rightPeriod) {
+                    if (row >= 0 && col >= 0) plane[row * size + col] = Value(1.0f);
+                }
+            }
+            return;
+        }
+
+        int col = right + half;
+        int row = back + half;
+        if (col >= 0 && col < size && row >= 0 && row < size) {
+            plane[row * size + col] = Value(1.0f);
+        }
+    }
+
+public:
+    explicit EgocentricWriter(int size) : size(size) {}
+
+    int Size() const { return size; }
+    size_t PlaneStride() const { return (size_t)EGO_CHANNEL_COUNT * size * size; }
+    static constexpr int Features() { return EGO_FEATURE_COUNT; }
+
+    // planes: EGO_CHANNEL_COUNT x K x K for this game; features: EGO_FEATURE_COUNT
+    void Write(const SimT& sim, T* planes, float* features) const {
+        const auto& board = sim.GetBoard();
+        const int width = board.Width();
+        const int height = board.Height();
+        const int half = size / 2;
+        const Direction dir = sim.GetDirection();
+        const int headX = board.X(sim.GetHeadCell());
+        const int headY = board.Y(sim.GetHeadCell());
+        const T one = Value(1.0f);
+
+        T* bodyPlane = planes;
+        T* wallPlane = planes + (size_t)EGO_WALL * size * size;
+        std::memset(planes + (size_t)EGO_FOOD * size * size, 0, 2 * (size_t)size * size * sizeof(T));
+
+        // Each row walks a straight line through the board, so the inner
+        // loop is branch-free stride arithmetic plus one bit test
+        for (int row = 0; row < size; row++) {
+            int x = headX + (row - half) * ROW_DX[dir] - half * COLUMN_DX[dir];
+            int y = headY + (row - half) * ROW_DY[dir] - half * COLUMN_DY[dir];
+            T* bodyRow = bodyPlane + row * size;
+            T* wallRow = wallPlane + row * size;
+
+            if constexpr (SimT::WRAPS) {
+                // The row start can be a whole window off the board; after
+                // that each step crosses at most one edge
+                x = WrapCoordinate(x, width);
+                y = WrapCoordinate(y, height);
+                for (int col = 0; col < size; col++) {
+                    bodyRow[col] = board.Test(board.Index(x, y)) ? one : 0;
+                    x += COLUMN_DX[dir];
+                    y += COLUMN_DY[dir];
+                    x += (x < 0) * width - (x >= width) * width;
+                    y += (y < 0) * height - (y >= height) * height;
+                }
+                std::memset(wallRow, 0, (size_t)size * sizeof(T));
+            } else {
+                for (int col = 0; col < size; col++) {
+                    bool inside = (unsigned)x < (unsigned)width && (unsigned)y < (unsigned)height;
+                    int cell = inside ? board.Index(x, y) : 0;
+                    bodyRow[col] = (inside && board.Test(cell)) ? one : 0;
+                    wallRow[col] = inside ? 0 : one;
+                    x += COLUMN_DX[dir];
+                    y += COLUMN_DY[dir];
+                }
+            }
+        }
+
+        MarkCell(sim, sim.GetFoodCell(), planes + (size_t)EGO_FOOD * size * size);
+        MarkCell(sim, sim.GetPowerUpCell(), planes + (size_t)EGO_POWERUP * size * size);
+
+        float boardSize = (float)(width > height ? width : height);
+        int food = sim.GetFoodCell();
+        if (food >= 0) {
+            int right, back;
+            ToEgocentric(sim, food, right, back);
+            features[EGO_FOOD_FORWARD] = -back / boardSize;
+            features[EGO_FOOD_RIGHT] = right / boardSize;
+            features[EGO_FOOD_DISTANCE] = (float)(std::abs(right) + std::abs(back)) / (width + height);
+        } else {
+            features[EGO_FOOD_FORWARD] = 0.0f;
+            features[EGO_FOOD_RIGHT] = 0.0f;
+            features[EGO_FOOD_DISTANCE] = 0.0f;
+        }
+        features[EGO_LENGTH] = (float)sim.GetLength() / board.Cells();
+        for (int type = 0; type < POWERUP_TYPE_COUNT; type++) {
+            features[EGO_TIMER_SPEED + type] =
+                (float)sim.GetPowerUpTicksRemaining(static_cast<PowerUpType>(type)) / SimT::POWERUP_DURATION_TICKS;
+        }
+    }
+};
+
+#endif
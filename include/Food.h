@@ -2,8 +2,9 @@
 #define FOOD_H
 
 #include "raylib.h"
+#include "Snake.h"
+#include <memory_resource>
 #include <vector>
-#include <deque>
 
 class Food {
 private:
@@ -12,16 +13,19 @@ private:
     Color foodColor;
     int gridWidth;
     int gridHeight;
+    std::pmr::vector<Vector2> validPositions;
     
 public:
-    Food(int cellSize, int screenWidth, int screenHeight);
+    Food(int cellSize, int screenWidth, int screenHeight,
+         std::pmr::memory_resource* memory = std::pmr::get_default_resource());
     
-    void Spawn(const std::deque<Vector2>& snakeBody);
+    void Spawn(const SnakeBody& snakeBody);
     Vector2 GetPosition() const { return position; }
+    void SetPosition(Vector2 newPosition) { position = newPosition; }
     void Draw() const;
     
 private:
-    std::vector<Vector2> GetValidPositions(const std::deque<Vector2>& snakeBody);
+    const std::pmr::vector<Vector2>& GetValidPositions(const SnakeBody& snakeBody);
 };
 
 #endif
@@ -0,0 +1,153 @@
+#ifndef FRAMEPROFILER_H
+#define FRAMEPROFILER_H
+
+#include <atomic>
+#include <cstdint>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define FRAMEPROFILER_TSC 1
+#endif
+
+enum ProfileSection {
+    PROFILE_HANDLE_INPUT,
+    PROFILE_UPDATE,
+    PROFILE_MUSIC,
+    PROFILE_COLLISIONS,
+    PROFILE_SPAWN,
+    PROFILE_DRAW_GRID,
+    PROFILE_DRAW_SNAKE,
+    PROFILE_DRAW_FOOD,
+    PROFILE_DRAW_POWERUP,
+    PROFILE_DRAW_ACTIVE_POWERUPS,
+    PROFILE_DRAW_HUD,
+    PROFILE_DRAW_GAME_OVER
+};
+
+const int PROFILE_SECTION_COUNT = 12;
+
+struct TimerSample {
+    uint32_t section;
+    uint32_t ticks;
+};
+
+// DATA STRUCTURE: Single-producer single-consumer ring of timer samples
+// WHY: A scope end is one store and one release increment - no lock, no
+// allocation. A full ring drops the sample instead of blocking the frame.
+class SampleRing {
+private:
+    static const uint32_t CAPACITY = 1024;
+    static const uint32_t MASK = CAPACITY - 1;
+
+    TimerSample samples[CAPACITY];
+    alignas(64) std::atomic<uint32_t> writeIndex;
+    alignas(64) std::atomic<uint32_t> readIndex;
+    uint32_t dropped;
+
+public:
+    SampleRing() : writeIndex(0), readIndex(0), dropped(0) {}
+
+    bool Push(const TimerSample& sample) {
+        uint32_t write = writeIndex.load(std::memory_order_relaxed);
+        if (write - readIndex.load(std::memory_order_acquire) == CAPACITY) {
+            dropped++;
+            return false;
+        }
+        samples[write & MASK] = sample;
+        writeIndex.store(write + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <typename Fn>
+    void Drain(Fn fn) {
+        uint32_t read = readIndex.load(std::memory_order_relaxed);
+        uint32_t write = writeIndex.load(std::memory_order_acquire);
+        for (; read != write; read++) {
+            fn(samples[read & MASK]);
+        }
+        readIndex.store(read, std::memory_order_release);
+    }
+
+    uint32_t GetDropped() const { return dropped; }
+};
+
+// Per-section frame timings for the profiler overlay. Scoped timers push raw
+// timestamp deltas into the ring; EndFrame() drains it once per frame into a
+// rolling history. Timers do nothing until the profiler is enabled.
+class FrameProfiler {
+public:
+    static const int HISTORY = 120;
+
+private:
+    SampleRing ring;
+    bool enabled;
+
+    uint64_t frameTicks[PROFILE_SECTION_COUNT];
+    float history[PROFILE_SECTION_COUNT][HISTORY];  // microseconds
+    int frame;
+
+    // Ticks are converted to time against the steady clock, measured over
+    // the profiler's whole lifetime rather than with a startup sleep
+    uint64_t startTicks;
+    int64_t startNanoseconds;
+    double nanosecondsPerTick;
+
+    FrameProfiler();
+
+public:
+    static FrameProfiler& Get();
+
+    static uint64_t Now() {
+#ifdef FRAMEPROFILER_TSC
+        return __rdtsc();
+#else
+        return NowNanoseconds();
+#endif
+    }
+
+    static uint64_t NowNanoseconds();
+
+    void Record(ProfileSection section, uint64_t ticks) {
+        ring.Push({(uint32_t)section, ticks > UINT32_MAX ? UINT32_MAX : (uint32_t)ticks});
+    }
+
+    void EndFrame();
+
+    void SetEnabled(bool value) { enabled = value; }
+    bool IsEnabled() const { return enabled; }
+
+    // Oldest to newest: sample i of the last HISTORY frames
+    float GetSample(ProfileSection section, int i) const {
+        return history[section][(frame + i) % HISTORY];
+    }
+    float GetAverage(ProfileSection section) const;
+    float GetLatest(ProfileSection section) const { return GetSample(section, HISTORY - 1); }
+    uint32_t GetDroppedSamples() const { return ring.GetDropped(); }
+
+    static const char* GetSectionName(ProfileSection section);
+};
+
+class ScopedTimer {
+private:
+    ProfileSection section;
+    uint64_t start;
+
+public:
+    explicit ScopedTimer(ProfileSection section)
+        : section(section), start(FrameProfiler::Get().IsEnabled() ? FrameProfiler::Now() : 0) {}
+
+    ~ScopedTimer() {
+        if (start != 0) {
+            FrameProfiler::Get().Record(section, FrameProfiler::Now() - start);
+        }
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+};
+
+#define PROFILE_SCOPE_NAME_INNER(a, b) a##b
+#define PROFILE_SCOPE_NAME(a, b) PROFILE_SCOPE_NAME_INNER(a, b)
+#define PROFILE_SCOPE(section) ScopedTimer PROFILE_SCOPE_NAME(scopedTimer, __LINE__)(section)
+
+#endif
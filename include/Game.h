@@ -2,10 +2,18 @@
 #define GAME_H
 
 #include "raylib.h"
+#include "AllocProfiler.h"
+#include "GameMemory.h"
+#include "LeaderboardClient.h"
+#include "LatencyHistogram.h"
 #include "Snake.h"
 #include "Food.h"
 #include "PowerUp.h"
+#include "ProfilerOverlay.h"
+#include "ReplayFile.h"
+#include "RewindBuffer.h"
 #include "SoundManager.h"
+#include "StatsStore.h"
 
 class Game {
 private:
@@ -15,10 +23,18 @@ private:
     bool isRunning;
     bool gameOver;
     
+    // Owns everything below; must outlive the entities it hands out
+    GameMemory memory;
+    
     Snake* snake;
     Food* food;
     PowerUp* powerUp;
     SoundManager* soundManager;
+    ProfilerOverlay profilerOverlay;
+    
+    RewindBuffer rewind;
+    bool rewinding;
+    float rewindTimer;
     
     float moveTimer;
     float baseMoveInterval;
@@ -26,20 +42,56 @@ private:
     
     int score;
     int highScore;
+    StatsStore stats;
+    LeaderboardClient leaderboard;
+    const char* playerName;
+    
+    // Each round also runs on the headless rules, which decide food,
+    // power-ups, score and death while it is recorded; the leaderboard
+    // re-runs the replay on the same rules before ranking the score
+    ClassicSimulation tickSim;
+    ReplayWriter<ClassicSimulation> replayWriter;
+    std::vector<uint8_t> replayBytes;
+    bool recording;
+    
+#ifdef SNAKE_PROFILE_ALLOCS
+    LatencyHistogram tickLatency;
+#endif
     
 public:
     Game(int width, int height, const char* title);
     ~Game();
     void Run();
     void Update();
+    void Update(float deltaTime);
     void Draw();
     void HandleInput();
     void CheckCollisions();
     void Reset();
     bool IsRunning() const { return isRunning; }
+    size_t GetHeapAllocations() const { return memory.GetHeapAllocations(); }
+    
+#ifdef SNAKE_PROFILE_ALLOCS
+    // Plays 'rounds' unrecorded games on autopilot, one move per Update and
+    // a restart after each death. False if GetHeapAllocations() moves once
+    // the first round (the warm-up) is over.
+    bool Soak(int rounds, int maxMovesPerRound);
+#endif
     
 private:
+    void EndGame();
+    void RecordGame();
+    void RecordMove();
+    void StepBack();
+    void UpdateRewind(float deltaTime);
+    void CreateEntities();
+    void DestroyEntities();
     void UpdatePowerUpEffects();
+    void BeginRecording();
+    void StepSimulation();
+    void SyncFromSimulation();
+    Vector2 CellPosition(int cell) const;
+    Direction AutopilotDirection() const;
     void DrawGrid() const;
     void DrawHUD() const;
     void DrawGameOver() const;
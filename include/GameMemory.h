@@ -0,0 +1,88 @@
+#ifndef GAMEMEMORY_H
+#define GAMEMEMORY_H
+
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <utility>
+
+// Passes every request on to 'upstream' and counts what gets through, so a
+// game can check that its ticks never reach the global heap
+class CountingResource : public std::pmr::memory_resource {
+private:
+    std::pmr::memory_resource* upstream;
+    size_t allocations;
+    size_t bytes;
+
+    void* do_allocate(size_t size, size_t alignment) override {
+        allocations++;
+        bytes += size;
+        return upstream->allocate(size, alignment);
+    }
+
+    void do_deallocate(void* p, size_t size, size_t alignment) override {
+        upstream->deallocate(p, size, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+public:
+    explicit CountingResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : upstream(upstream), allocations(0), bytes(0) {}
+
+    size_t GetAllocations() const { return allocations; }
+    size_t GetBytes() const { return bytes; }
+};
+
+// Memory owned by one game: the entities and every container inside them.
+//
+// DATA STRUCTURE: Pool resource on top of a monotonic arena
+// WHY: A game is only ever touched by one thread, so the unsynchronized pool
+// needs no locks; blocks freed by a shrinking deque or a Reset() go back to
+// the pool, so once warmed up a tick is served without the global heap
+//
+// The arena never frees, so any block the pool does not keep must never be
+// given back: 'largestBlock' has to cover the biggest container an entity
+// allocates (the spawn buffers hold one entry per grid cell).
+class GameMemory {
+private:
+    CountingResource heap;
+    std::pmr::monotonic_buffer_resource arena;
+    std::pmr::unsynchronized_pool_resource pool;
+
+    static std::pmr::pool_options PoolOptions(size_t largestBlock) {
+        std::pmr::pool_options options;
+        options.largest_required_pool_block = largestBlock;
+        return options;
+    }
+
+public:
+    explicit GameMemory(size_t largestBlock, size_t arenaBytes = 64 * 1024)
+        : arena(arenaBytes, &heap), pool(PoolOptions(largestBlock), &arena) {}
+
+    GameMemory(const GameMemory&) = delete;
+    GameMemory& operator=(const GameMemory&) = delete;
+
+    std::pmr::memory_resource* Resource() { return &pool; }
+
+    template <typename T, typename... Args>
+    T* New(Args&&... args) {
+        void* p = pool.allocate(sizeof(T), alignof(T));
+        return ::new (p) T(std::forward<Args>(args)...);
+    }
+
+    template <typename T>
+    void Delete(T* object) {
+        if (!object) return;
+        object->~T();
+        pool.deallocate(object, sizeof(T), alignof(T));
+    }
+
+    // Requests that went past the arena to the global heap
+    size_t GetHeapAllocations() const { return heap.GetAllocations(); }
+    size_t GetHeapBytes() const { return heap.GetBytes(); }
+};
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef GAMETYPES_H
+#define GAMETYPES_H
+
+// Shared between the raylib front end and the headless simulation core,
+// so this header must not include raylib.h
+
+enum Direction {
+    UP,
+    DOWN,
+    LEFT,
+    RIGHT
+};
+
+enum PowerUpType {
+    SPEED_BOOST,
+    SCORE_MULTIPLIER,
+    INVINCIBILITY
+};
+
+const int POWERUP_TYPE_COUNT = 3;
+
+#endif
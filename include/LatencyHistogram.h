@@ -0,0 +1,100 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+
+// HDR-style histogram of nanosecond latencies.
+//
+// DATA STRUCTURE: Log-linear buckets - 32 linear sub-buckets per power of two
+// WHY: Every value from 1ns to hours is kept to ~3% precision in a fixed
+// array, so Record() is a couple of shifts and an increment with no allocation
+class LatencyHistogram {
+private:
+    static const int SUB_BITS = 5;
+    static const int SUB_COUNT = 1 << SUB_BITS;
+    static const int BUCKET_COUNT = (64 - SUB_BITS + 1) * SUB_COUNT;
+
+    uint64_t counts[BUCKET_COUNT];
+    uint64_t total;
+    uint64_t sum;
+    uint64_t minValue;
+    uint64_t maxValue;
+
+    static int Index(uint64_t value) {
+        if (value < (uint64_t)SUB_COUNT) return (int)value;
+        int shift = 63 - __builtin_clzll(value) - SUB_BITS;
+        return (shift + 1) * SUB_COUNT + (int)((value >> shift) - SUB_COUNT);
+    }
+
+    // Highest value that lands in bucket 'index'
+    static uint64_t UpperBound(int index) {
+        if (index < SUB_COUNT) return (uint64_t)index;
+        int shift = index / SUB_COUNT - 1;
+        uint64_t low = (uint64_t)(SUB_COUNT + index % SUB_COUNT) << shift;
+        return low + ((uint64_t(1) << shift) - 1);
+    }
+
+public:
+    LatencyHistogram() { Reset(); }
+
+    void Reset() {
+        std::memset(counts, 0, sizeof(counts));
+        total = 0;
+        sum = 0;
+        minValue = UINT64_MAX;
+        maxValue = 0;
+    }
+
+    void Record(uint64_t nanoseconds) {
+        counts[Index(nanoseconds)]++;
+        total++;
+        sum += nanoseconds;
+        if (nanoseconds < minValue) minValue = nanoseconds;
+        if (nanoseconds > maxValue) maxValue = nanoseconds;
+    }
+
+    // Smallest recorded bucket bound that covers 'percentile' (0-100) of samples
+    uint64_t ValueAtPercentile(double percentile) const {
+        if (total == 0) return 0;
+        uint64_t target = (uint64_t)(percentile / 100.0 * total + 0.5);
+        if (target == 0) target = 1;
+
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKET_COUNT; i++) {
+            seen += counts[i];
+            if (seen >= target) {
+                uint64_t bound = UpperBound(i);
+                return bound < maxValue ? bound : maxValue;
+            }
+        }
+        return maxValue;
+    }
+
+    uint64_t Count() const { return total; }
+    uint64_t Min() const { return total ? minValue : 0; }
+    uint64_t Max() const { return maxValue; }
+    double Mean() const { return total ? (double)sum / total : 0.0; }
+};
+
+// Records the lifetime of the enclosing scope into a histogram
+class ScopedLatency {
+private:
+    LatencyHistogram& histogram;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    explicit ScopedLatency(LatencyHistogram& histogram)
+        : histogram(histogram), start(std::chrono::steady_clock::now()) {}
+
+    ~ScopedLatency() {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        histogram.Record((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+};
+
+#endif
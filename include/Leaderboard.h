@@ -0,0 +1,87 @@
+#ifndef LEADERBOARD_H
+#define LEADERBOARD_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+const int LEADERBOARD_NAME_LENGTH = 16;
+
+struct LeaderboardEntry {
+    int32_t score;
+    uint32_t sequence;  // submission order: earlier wins a tie
+    char player[LEADERBOARD_NAME_LENGTH];
+};
+
+// All-time score table shared by every receiver thread of the leaderboard
+// service. Submissions never take a lock and never allocate: nodes come from
+// a pool sized up front, and entries are never removed.
+//
+// DATA STRUCTURE: Insert-only lock-free skiplist ordered by score, then sequence
+// WHY: Threads insert with one CAS per level and readers walk the bottom
+// level without locking, so top-K is a walk of K nodes. Nodes are never
+// freed, so a reader can never land on reclaimed memory.
+//
+// DATA STRUCTURE: Fenwick tree of atomic counters indexed by score
+// WHY: Rank is "how many scores beat this one"; a skiplist without
+// per-link widths cannot answer that without a walk, while the tree answers
+// in O(log MAX_SCORE) with lock-free increments. Scores at or above
+// MAX_SCORE share the top counter.
+class Leaderboard {
+public:
+    static const int MAX_LEVEL = 12;  // branching 1/4: plenty for 16M entries
+    static const int32_t MAX_SCORE = 1 << 20;
+
+private:
+    struct Node {
+        LeaderboardEntry entry;
+        int height;
+        std::atomic<Node*> next[MAX_LEVEL];
+    };
+
+    std::unique_ptr<Node[]> pool;
+    uint32_t capacity;
+    std::atomic<uint32_t> used;
+    std::atomic<uint32_t> nextSequence;
+    std::atomic<uint32_t> rejected;
+    Node head;
+
+    std::unique_ptr<std::atomic<uint32_t>[]> rankTree;  // 1-based Fenwick tree
+
+    static bool Before(const LeaderboardEntry& a, const LeaderboardEntry& b) {
+        return a.score != b.score ? a.score > b.score : a.sequence < b.sequence;
+    }
+
+    static int RandomHeight();
+    static int32_t RankSlot(int32_t score);
+
+    void Find(const LeaderboardEntry& entry, Node** preds, Node** succs);
+    bool Insert(const LeaderboardEntry& entry);
+    uint32_t CountAtMost(int32_t score) const;
+
+public:
+    explicit Leaderboard(uint32_t capacity);
+
+    Leaderboard(const Leaderboard&) = delete;
+    Leaderboard& operator=(const Leaderboard&) = delete;
+
+    // False once the pool is full
+    bool Submit(const char* player, int32_t score);
+
+    // Best 'count' entries, best first
+    int Top(LeaderboardEntry* out, int count) const;
+
+    // 1-based position a score holds (or would hold) on the board
+    uint32_t Rank(int32_t score) const;
+
+    uint32_t Size() const;
+    uint32_t GetRejected() const { return rejected.load(std::memory_order_relaxed); }
+
+    // Whole board, best first, written to path + ".tmp" and renamed over
+    // 'path' so a crash never leaves a half-written snapshot
+    bool SaveSnapshot(const char* path) const;
+    bool LoadSnapshot(const char* path);
+};
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef LEADERBOARDCLIENT_H
+#define LEADERBOARDCLIENT_H
+
+#include "Leaderboard.h"
+#include <cstdint>
+#include <vector>
+
+// Wire format of the local leaderboard service: one request or reply per
+// datagram, native byte order (client and server share a host). The service
+// listens on a UNIX datagram socket (POSIX) and on UDP 127.0.0.1 (every
+// platform; the only transport on Windows).
+//
+// A SUBMIT carries no score of its own: the game's replay file (ReplayFile.h)
+// follows the request in the same datagram, and the service re-runs it on
+// the headless rules before the score it ends with is ranked.
+const char* const LEADERBOARD_SOCKET = "/tmp/snake-leaderboard.sock";
+const uint16_t LEADERBOARD_PORT = 47777;
+const uint32_t LEADERBOARD_MAGIC = 0x334B4E53;  // "SNK3": v3, submits carry a replay
+const int LEADERBOARD_MAX_TOP = 32;
+const int LEADERBOARD_PATH_LENGTH = 108;  // sockaddr_un::sun_path
+// Keeps a submission inside one UDP datagram. Games whose replay would
+// outgrow it stop recording and finish unranked.
+const uint32_t LEADERBOARD_MAX_REPLAY_BYTES = 60 * 1024;
+// Keyframe spacing games record with; the service rejects sparser replays,
+// which bounds the ticks a replay of at most LEADERBOARD_MAX_REPLAY_BYTES
+// can make it simulate
+const uint32_t LEADERBOARD_REPLAY_KEYFRAME_INTERVAL = 4096;
+
+enum LeaderboardOp {
+    LEADERBOARD_SUBMIT = 1,
+    LEADERBOARD_TOP = 2,
+    LEADERBOARD_RANK = 3
+};
+
+struct LeaderboardRequest {
+    uint32_t magic;
+    uint32_t op;
+    uint32_t id;      // echoed in the reply
+    int32_t score;    // RANK
+    uint32_t count;   // TOP; SUBMIT: bytes of replay after the request
+    uint32_t reserved;  // keeps the replay after it 8-byte aligned
+    char player[LEADERBOARD_NAME_LENGTH];
+};
+
+static_assert(sizeof(LeaderboardRequest) % 8 == 0, "a replay follows the request in place");
+
+struct LeaderboardReply {
+    uint32_t magic;
+    uint32_t id;      // of the request this answers
+    uint32_t rank;    // RANK
+    uint32_t total;
+    uint32_t count;   // TOP
+    LeaderboardEntry entries[LEADERBOARD_MAX_TOP];
+};
+
+// Game-side connection. Submit() is a non-blocking send that is dropped if
+// the service is down or its queue is full, so a game over never waits on
+// it; queries wait up to half a second for the reply. Each query carries a
+// fresh id and only a reply echoing it is accepted, so a late answer to an
+// earlier query that timed out is skipped instead of returned.
+//
+// A service started after the game, or restarted under it, is picked up on
+// the next send: if the socket is not connected, or the send finds nobody
+// listening, the client reconnects to the address given to Open() or
+// OpenLoopback() and retries once.
+class LeaderboardClient {
+private:
+    intptr_t fd;  // socket handle (SOCKET on Windows), -1 when closed
+    char socketPath[LEADERBOARD_PATH_LENGTH];
+    uint16_t port;  // nonzero: loopback UDP instead of socketPath
+    uint32_t lastRequestId;
+    std::vector<uint8_t> submission;  // request + replay, reused
+
+    bool Connect();
+    bool Send(const void* data, size_t size, bool wait);
+    bool Query(LeaderboardRequest& request, LeaderboardReply& reply);
+
+public:
+    LeaderboardClient();
+    ~LeaderboardClient();
+
+    LeaderboardClient(const LeaderboardClient&) = delete;
+    LeaderboardClient& operator=(const LeaderboardClient&) = delete;
+
+    // The platform's default transport: the UNIX socket at LEADERBOARD_SOCKET
+    // on POSIX, loopback UDP on Windows
+    bool Open();
+    // UNIX datagram socket at 'path' (POSIX only; false on Windows)
+    bool Open(const char* path);
+    bool OpenLoopback(uint16_t port = LEADERBOARD_PORT);
+    void Close();
+    bool IsOpen() const { return fd >= 0; }
+
+    // 'replay' is an encoded replay file (ReplayWriter::Encode); false if it
+    // is larger than LEADERBOARD_MAX_REPLAY_BYTES or could not be sent
+    bool Submit(const uint8_t* replay, size_t bytes);
+    // Fills up to 'count' entries, best first; -1 if the service did not answer
+    int Top(LeaderboardEntry* out, int count);
+    // 0 if the service did not answer
+    uint32_t Rank(int score, uint32_t* total = nullptr);
+};
+
+#endif
@@ -0,0 +1,131 @@
+#ifndef OBSERVATION_H
+#define OBSERVATION_H
+
+#include "GameTypes.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Observation planes, one H x W plane per channel
+enum ObservationChannel {
+    OBS_BODY,
+    OBS_HEAD,
+    OBS_FOOD,
+    OBS_POWERUP_SPEED,        // spawned power-up item, one plane per type
+    OBS_POWERUP_MULTIPLIER,
+    OBS_POWERUP_INVINCIBLE,
+    OBS_TIMER_SPEED,          // remaining effect time, written at the head cell
+    OBS_TIMER_MULTIPLIER,
+    OBS_TIMER_INVINCIBLE,
+    OBS_CHANNEL_COUNT
+};
+
+template <typename T> struct ObservationScale;
+template <> struct ObservationScale<uint8_t> { static constexpr float ONE = 255.0f; };
+template <> struct ObservationScale<float> { static constexpr float ONE = 1.0f; };
+
+// Writes Simulation state straight into a caller-owned, batch-contiguous
+// NCHW buffer (uint8 or float). After the initial full write of a game,
+// Update() only touches the cells that changed on the last Step(): new and
+// old head, vacated tail, food and power-up moves. No allocation per step.
+template <typename SimT, typename T>
+class ObservationWriter {
+private:
+    struct Cached {
+        int head;
+        int food;
+        int powerUp;
+        PowerUpType powerUpType;
+    };
+
+    T* buffer;
+    int width;
+    int height;
+    std::vector<Cached> cached;
+
+    T* Plane(int game, int channel) const {
+        return buffer + ((size_t)game * OBS_CHANNEL_COUNT + channel) * width * height;
+    }
+
+    static T Value(float fraction) { return (T)(fraction * ObservationScale<T>::ONE); }
+
+    void WriteTimers(int game, const SimT& sim, int cell) const {
+        for (int type = 0; type < POWERUP_TYPE_COUNT; type++) {
+            float remaining = (float)sim.GetPowerUpTicksRemaining(static_cast<PowerUpType>(type)) /
+                              SimT::POWERUP_DURATION_TICKS;
+            Plane(game, OBS_TIMER_SPEED + type)[cell] = Value(remaining);
+        }
+    }
+
+    void ClearTimers(int game, int cell) const {
+        for (int type = 0; type < POWERUP_TYPE_COUNT; type++) {
+            Plane(game, OBS_TIMER_SPEED + type)[cell] = 0;
+        }
+    }
+
+public:
+    ObservationWriter(T* buffer, int games, int width, int height)
+        : buffer(buffer), width(width), height(height), cached(games) {}
+
+    static constexpr int Channels() { return OBS_CHANNEL_COUNT; }
+    size_t GameStride() const { return (size_t)OBS_CHANNEL_COUNT * width * height; }
+
+    // Full rewrite of one game's planes (initial state and after Reset)
+    void Write(int game, const SimT& sim) {
+        std::memset(Plane(game, 0), 0, GameStride() * sizeof(T));
+
+        const T one = Value(1.0f);
+        T* bodyPlane = Plane(game, OBS_BODY);
+        for (int i = 0; i < sim.GetBodySize(); i++) {
+            int cell = sim.GetBodyCell(i);
+            if (sim.GetBoard().Test(cell)) bodyPlane[cell] = one;
+        }
+
+        Cached& c = cached[game];
+        c.head = sim.GetHeadCell();
+        c.food = sim.GetFoodCell();
+        c.powerUp = sim.GetPowerUpCell();
+        c.powerUpType = sim.GetPowerUpType();
+
+        Plane(game, OBS_HEAD)[c.head] = one;
+        WriteTimers(game, sim, c.head);
+        if (c.food >= 0) Plane(game, OBS_FOOD)[c.food] = one;
+        if (c.powerUp >= 0) Plane(game, OBS_POWERUP_SPEED + c.powerUpType)[c.powerUp] = one;
+    }
+
+    // Incremental update after one Step() on a live game
+    void Update(int game, const SimT& sim) {
+        const T one = Value(1.0f);
+        Cached& c = cached[game];
+
+        int tail = sim.GetLastRemovedTail();
+        if (tail >= 0) {
+            Plane(game, OBS_BODY)[tail] = sim.GetBoard().Test(tail) ? one : 0;
+        }
+
+        int head = sim.GetHeadCell();
+        Plane(game, OBS_BODY)[head] = one;
+        Plane(game, OBS_HEAD)[c.head] = 0;
+        Plane(game, OBS_HEAD)[head] = one;
+        ClearTimers(game, c.head);
+        WriteTimers(game, sim, head);
+        c.head = head;
+
+        int food = sim.GetFoodCell();
+        if (food != c.food) {
+            if (c.food >= 0) Plane(game, OBS_FOOD)[c.food] = 0;
+            if (food >= 0) Plane(game, OBS_FOOD)[food] = one;
+            c.food = food;
+        }
+
+        int powerUp = sim.GetPowerUpCell();
+        if (powerUp != c.powerUp) {
+            if (c.powerUp >= 0) Plane(game, OBS_POWERUP_SPEED + c.powerUpType)[c.powerUp] = 0;
+            if (powerUp >= 0) Plane(game, OBS_POWERUP_SPEED + sim.GetPowerUpType())[powerUp] = one;
+            c.powerUp = powerUp;
+            c.powerUpType = sim.GetPowerUpType();
+        }
+    }
+};
+
+#endif
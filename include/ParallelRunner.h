@@ -0,0 +1,99 @@
+#ifndef PARALLELRUNNER_H
+#define PARALLELRUNNER_H
+
+#include "GameTypes.h"
+#include "ThreadPool.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct EpisodeResult {
+    int score;
+    int length;
+    uint64_t ticks;
+};
+
+// Plays a fixed number of headless episodes across a work-stealing pool.
+// Episodes are dealt out in small chunks; each worker reuses one Simulation
+// that auto-resets as soon as an episode ends, so a worker never waits on
+// the slowest game of a static shard. That Simulation is allocated by the
+// worker itself, so on a pinned pool its pages are first touched (and
+// placed) on the worker's own NUMA node.
+template <typename SimT>
+class ParallelRunner {
+public:
+    // Chooses the next action; 'rng' is a per-episode stream seeded from the episode id
+    using Policy = Direction (*)(const SimT& sim, uint32_t& rng);
+
+private:
+    // One cache line per worker so tick counters never false-share
+    struct alignas(64) WorkerState {
+        std::unique_ptr<SimT> sim;
+        uint64_t ticks = 0;
+    };
+
+    struct Context {
+        ParallelRunner* runner;
+        Policy policy;
+        uint64_t seed;
+        EpisodeResult* results;
+    };
+
+    ThreadPool& pool;
+    SimT prototype;
+    int chunk;
+    uint64_t maxTicks;
+    std::vector<WorkerState> workers;
+
+    static void RunChunk(void* context, int begin, int end) {
+        const Context& ctx = *static_cast<const Context*>(context);
+        WorkerState& state = ctx.runner->workers[ThreadPool::CurrentWorker()];
+        if (!state.sim) {
+            state.sim.reset(new SimT(ctx.runner->prototype));
+        }
+        SimT& sim = *state.sim;
+
+        for (int episode = begin; episode < end; episode++) {
+            uint64_t seed = ctx.seed + (uint64_t)episode;
+            uint32_t rng = (uint32_t)(seed * 0x9E3779B97F4A7C15ULL >> 32) | 1;
+            sim.Reset(seed);
+
+            while (sim.GetTick() < ctx.runner->maxTicks && sim.Step(ctx.policy(sim, rng))) {
+            }
+            ctx.results[episode] = {sim.GetScore(), sim.GetLength(), sim.GetTick()};
+            state.ticks += sim.GetTick();
+        }
+    }
+
+public:
+    ParallelRunner(ThreadPool& pool, const SimT& prototype = SimT(),
+                   int chunk = 4, uint64_t maxTicks = 1000000)
+        : pool(pool), prototype(prototype), chunk(chunk), maxTicks(maxTicks),
+          workers(pool.Size()) {}
+
+    // Episode i uses seed + i, so results do not depend on thread count or chunking
+    std::vector<EpisodeResult> RunEpisodes(int episodes, uint64_t seed, Policy policy) {
+        std::vector<EpisodeResult> results(episodes);
+        Context context = {this, policy, seed, results.data()};
+
+        TaskGroup group;
+        pool.ParallelFor(group, episodes, chunk, &ParallelRunner::RunChunk, &context);
+        group.Wait();
+        return results;
+    }
+
+    void SetChunk(int value) { chunk = value; }
+
+    // Ticks simulated so far, summed per NUMA node of the pool's workers
+    std::vector<uint64_t> GetNodeTicks() const {
+        std::vector<uint64_t> perNode;
+        for (int worker = 0; worker < pool.Size(); worker++) {
+            size_t node = (size_t)pool.GetWorkerNode(worker);
+            if (perNode.size() <= node) perNode.resize(node + 1, 0);
+            perNode[node] += workers[worker].ticks;
+        }
+        return perNode;
+    }
+};
+
+#endif
@@ -0,0 +1,116 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <cstdint>
+#include <cstdio>
+
+// Hardware performance counters for the calling thread, read through
+// perf_event_open on Linux. Elsewhere - or when the kernel refuses (no PMU
+// in a VM, perf_event_paranoid too strict) - IsAvailable() is false and
+// every read returns zeros, so callers only need to skip the report.
+
+enum PerfCounterId {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_CACHE_MISSES,
+    PERF_BRANCH_MISSES
+};
+
+const int PERF_COUNTER_COUNT = 4;
+
+struct PerfSample {
+    uint64_t values[PERF_COUNTER_COUNT];
+
+    PerfSample operator-(const PerfSample& other) const {
+        PerfSample delta;
+        for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+            delta.values[i] = values[i] - other.values[i];
+        }
+        return delta;
+    }
+
+    PerfSample& operator+=(const PerfSample& other) {
+        for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+            values[i] += other.values[i];
+        }
+        return *this;
+    }
+
+    double Ipc() const {
+        return values[PERF_CYCLES] ? (double)values[PERF_INSTRUCTIONS] / values[PERF_CYCLES] : 0.0;
+    }
+};
+
+// One counter group, so all four values cover exactly the same interval.
+// Counts are scaled up if the kernel had to multiplex the group.
+class PerfCounters {
+private:
+    int fds[PERF_COUNTER_COUNT];
+    bool available;
+
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // Counters of the calling thread, opened on first use
+    static PerfCounters& ForThread();
+
+    bool IsAvailable() const { return available; }
+    PerfSample Read() const;
+
+    // "IPC 2.31  cycles/tick 40.2  cache-miss/tick 0.42  branch-miss/tick 0.08"
+    static void PrintPer(FILE* out, const PerfSample& delta, uint64_t count, const char* unit);
+};
+
+// Per-region counter totals for instrumented game and bench builds. Compile
+// with -DSNAKE_PERF_COUNTERS to enable PERF_SCOPE; otherwise it compiles
+// away. Regions may be entered from any thread (VecEnv workers).
+enum PerfRegionId {
+    PERF_REGION_SNAKE_MOVE,
+    PERF_REGION_SELF_COLLISION,
+    PERF_REGION_FOOD_SPAWN,
+    PERF_REGION_RENDER,
+    PERF_REGION_SIM_STEP,
+    PERF_REGION_BATCH_STEP,
+    PERF_REGION_VECENV_STEP
+};
+
+const int PERF_REGION_COUNT = 7;
+
+#ifdef SNAKE_PERF_COUNTERS
+
+class PerfRegions {
+public:
+    static void Record(PerfRegionId id, const PerfSample& delta);
+    // Regions that were never entered are left out
+    static void Report(FILE* out);
+};
+
+// Two counter reads (two syscalls) per scope: meant for tuning runs only
+class PerfScope {
+private:
+    PerfRegionId id;
+    PerfSample start;
+
+public:
+    explicit PerfScope(PerfRegionId id) : id(id), start(PerfCounters::ForThread().Read()) {}
+    ~PerfScope() { PerfRegions::Record(id, PerfCounters::ForThread().Read() - start); }
+
+    PerfScope(const PerfScope&) = delete;
+    PerfScope& operator=(const PerfScope&) = delete;
+};
+
+#define PERF_SCOPE_NAME_INNER(a, b) a##b
+#define PERF_SCOPE_NAME(a, b) PERF_SCOPE_NAME_INNER(a, b)
+#define PERF_SCOPE(id) PerfScope PERF_SCOPE_NAME(perfScope, __LINE__)(id)
+
+#else
+
+#define PERF_SCOPE(id) ((void)0)
+
+#endif
+
+#endif
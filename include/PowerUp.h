@@ -2,15 +2,10 @@
 #define POWERUP_H
 
 #include "raylib.h"
+#include "GameTypes.h"
+#include "Snake.h"
+#include <memory_resource>
 #include <vector>
-#include <deque>
-#include <queue>
-
-enum PowerUpType {
-    SPEED_BOOST,
-    SCORE_MULTIPLIER,
-    INVINCIBILITY
-};
 
 struct ActivePowerUp {
     PowerUpType type;
@@ -21,6 +16,20 @@ struct ActivePowerUp {
     }
 };
 
+const int POWERUP_STATE_MAX_ACTIVE = POWERUP_TYPE_COUNT * 2;
+
+// Fixed-size copy of a PowerUp, for the rewind buffer. Effects beyond
+// POWERUP_STATE_MAX_ACTIVE (never reached in play: one spawn per 10s, 5s
+// each) keep only the longest-lasting ones.
+struct PowerUpState {
+    Vector2 position;
+    PowerUpType type;
+    bool isActive;
+    float spawnTimer;
+    int activeCount;
+    ActivePowerUp active[POWERUP_STATE_MAX_ACTIVE];
+};
+
 class PowerUp {
 private:
     Vector2 position;
@@ -33,19 +42,27 @@ private:
     float spawnTimer;
     float spawnInterval;
     
-    std::priority_queue<ActivePowerUp> activePowerUps;
+    // DATA STRUCTURE: Vector kept sorted as a priority queue, next to expire at the back
+    // WHY: Every timer drops by the same delta, so the order never changes and
+    // expired entries are popped off the back; lookups scan it without copying
+    std::pmr::vector<ActivePowerUp> activePowerUps;
+    std::pmr::vector<Vector2> validPositions;
     
-    std::vector<Vector2> GetValidPositions(const std::deque<Vector2>& snakeBody);
+    const std::pmr::vector<Vector2>& GetValidPositions(const SnakeBody& snakeBody);
     Color GetPowerUpColor(PowerUpType type) const;
     const char* GetPowerUpName(PowerUpType type) const;
     
 public:
-    PowerUp(int cellSize, int screenWidth, int screenHeight);
+    PowerUp(int cellSize, int screenWidth, int screenHeight,
+            std::pmr::memory_resource* memory = std::pmr::get_default_resource());
     
     void Update(float deltaTime);
-    void Spawn(const std::deque<Vector2>& snakeBody);
+    void Spawn(const SnakeBody& snakeBody);
     void Collect(PowerUpType type, float duration);
     
+    void SaveState(PowerUpState& state) const;
+    void RestoreState(const PowerUpState& state);
+    
     Vector2 GetPosition() const { return position; }
     PowerUpType GetType() const { return type; }
     bool IsActive() const { return isActive; }
@@ -0,0 +1,36 @@
+#ifndef PROFILEROVERLAY_H
+#define PROFILEROVERLAY_H
+
+#include "raylib.h"
+#include "rlgl.h"
+#include "FrameProfiler.h"
+
+// F3 overlay: rolling per-section timing graphs from FrameProfiler plus the
+// draw-call and vertex counts of the frame.
+//
+// DATA STRUCTURE: Our own rlRenderBatch, made the active batch
+// WHY: rlgl keeps its default batch private; owning the batch lets us read
+// drawCounter and each draw's vertexCount before EndDrawing() flushes it
+class ProfilerOverlay {
+private:
+    rlRenderBatch batch;
+    bool batchLoaded;
+    bool visible;
+    int drawCalls;
+    int vertices;
+
+public:
+    ProfilerOverlay();
+
+    void Initialize();  // needs the GL context: call after InitWindow()
+    void Shutdown();    // call before CloseWindow()
+
+    void Toggle();
+    bool IsVisible() const { return visible; }
+
+    // Reads the batch before the overlay adds its own draws to it
+    void CaptureBatchStats();
+    void Draw(int screenWidth) const;
+};
+
+#endif
@@ -0,0 +1,145 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+// Per-game random streams for the headless core. Every game owns one
+// xoshiro128+ stream seeded only from its own seed, so a game draws the same
+// numbers whether it runs alone, in a batch of any width, or on any thread.
+
+inline uint64_t SplitMix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Maps a 32-bit draw onto [0, range) with a multiply instead of a divide
+inline uint32_t RandomBelow(uint32_t draw, uint32_t range) {
+    return (uint32_t)(((uint64_t)draw * range) >> 32);
+}
+
+struct Xoshiro128Plus {
+    uint32_t s[4];
+
+    void Seed(uint64_t seed) {
+        uint64_t a = SplitMix64(seed);
+        uint64_t b = SplitMix64(seed);
+        s[0] = (uint32_t)a;
+        s[1] = (uint32_t)(a >> 32);
+        s[2] = (uint32_t)b;
+        s[3] = (uint32_t)(b >> 32) | 1;  // never the all-zero state
+    }
+
+    uint32_t Next() {
+        uint32_t result = s[0] + s[3];
+        uint32_t t = s[1] << 9;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = (s[3] << 11) | (s[3] >> 21);
+        return result;
+    }
+};
+
+// LANES xoshiro128+ streams stored structure-of-arrays and advanced together.
+// Lane i seeded with seed s produces exactly Xoshiro128Plus seeded with s.
+// NextMasked() only advances the lanes whose mask bit is set, so lanes that
+// do not need a number this tick keep their stream position.
+template <int LANES>
+class Xoshiro128PlusLanes {
+private:
+    alignas(64) uint32_t s0[LANES];
+    alignas(64) uint32_t s1[LANES];
+    alignas(64) uint32_t s2[LANES];
+    alignas(64) uint32_t s3[LANES];
+
+public:
+    void Seed(int lane, uint64_t seed) {
+        Xoshiro128Plus scalar;
+        scalar.Seed(seed);
+        s0[lane] = scalar.s[0];
+        s1[lane] = scalar.s[1];
+        s2[lane] = scalar.s[2];
+        s3[lane] = scalar.s[3];
+    }
+
+    // out[lane] receives a draw for every lane in 'mask'; others are untouched
+    void NextMasked(uint32_t mask, uint32_t* out) {
+        int lane = 0;
+#ifdef __AVX512F__
+        // The lane mask is the AVX-512 write mask as it is. The maskz shifts
+        // avoid a GCC 12 -Wuninitialized false positive in the plain forms.
+        for (; lane + 16 <= LANES; lane += 16) {
+            __mmask16 active = (__mmask16)(mask >> lane);
+
+            __m512i a = _mm512_load_si512(&s0[lane]);
+            __m512i b = _mm512_load_si512(&s1[lane]);
+            __m512i c = _mm512_load_si512(&s2[lane]);
+            __m512i d = _mm512_load_si512(&s3[lane]);
+
+            __m512i result = _mm512_add_epi32(a, d);
+            __m512i t = _mm512_maskz_slli_epi32(0xFFFF, b, 9);
+            __m512i c2 = _mm512_xor_si512(c, a);
+            __m512i d2 = _mm512_xor_si512(d, b);
+            __m512i b2 = _mm512_xor_si512(b, c2);
+            __m512i a2 = _mm512_xor_si512(a, d2);
+            c2 = _mm512_xor_si512(c2, t);
+            d2 = _mm512_maskz_rol_epi32(0xFFFF, d2, 11);
+
+            _mm512_store_si512(&s0[lane], _mm512_mask_mov_epi32(a, active, a2));
+            _mm512_store_si512(&s1[lane], _mm512_mask_mov_epi32(b, active, b2));
+            _mm512_store_si512(&s2[lane], _mm512_mask_mov_epi32(c, active, c2));
+            _mm512_store_si512(&s3[lane], _mm512_mask_mov_epi32(d, active, d2));
+            _mm512_mask_storeu_epi32(&out[lane], active, result);
+        }
+#endif
+#ifdef __AVX2__
+        const __m256i bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+        for (; lane + 8 <= LANES; lane += 8) {
+            __m256i active = _mm256_cmpeq_epi32(
+                _mm256_and_si256(_mm256_set1_epi32((int)(mask >> lane)), bits), bits);
+
+            __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i*>(&s0[lane]));
+            __m256i b = _mm256_load_si256(reinterpret_cast<const __m256i*>(&s1[lane]));
+            __m256i c = _mm256_load_si256(reinterpret_cast<const __m256i*>(&s2[lane]));
+            __m256i d = _mm256_load_si256(reinterpret_cast<const __m256i*>(&s3[lane]));
+
+            __m256i result = _mm256_add_epi32(a, d);
+            __m256i t = _mm256_slli_epi32(b, 9);
+            __m256i c2 = _mm256_xor_si256(c, a);
+            __m256i d2 = _mm256_xor_si256(d, b);
+            __m256i b2 = _mm256_xor_si256(b, c2);
+            __m256i a2 = _mm256_xor_si256(a, d2);
+            c2 = _mm256_xor_si256(c2, t);
+            d2 = _mm256_or_si256(_mm256_slli_epi32(d2, 11), _mm256_srli_epi32(d2, 21));
+
+            _mm256_store_si256(reinterpret_cast<__m256i*>(&s0[lane]), _mm256_blendv_epi8(a, a2, active));
+            _mm256_store_si256(reinterpret_cast<__m256i*>(&s1[lane]), _mm256_blendv_epi8(b, b2, active));
+            _mm256_store_si256(reinterpret_cast<__m256i*>(&s2[lane]), _mm256_blendv_epi8(c, c2, active));
+            _mm256_store_si256(reinterpret_cast<__m256i*>(&s3[lane]), _mm256_blendv_epi8(d, d2, active));
+            _mm256_maskstore_epi32(reinterpret_cast<int*>(&out[lane]), active, result);
+        }
+#endif
+        for (; lane < LANES; lane++) {
+            if (!((mask >> lane) & 1)) continue;
+            uint32_t result = s0[lane] + s3[lane];
+            uint32_t t = s1[lane] << 9;
+            s2[lane] ^= s0[lane];
+            s3[lane] ^= s1[lane];
+            s1[lane] ^= s2[lane];
+            s0[lane] ^= s3[lane];
+            s2[lane] ^= t;
+            s3[lane] = (s3[lane] << 11) | (s3[lane] >> 21);
+            out[lane] = result;
+        }
+    }
+};
+
+#endif
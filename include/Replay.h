@@ -0,0 +1,79 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "GameTypes.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+const int REPLAY_PLAYER_LENGTH = 16;
+
+// Everything needed to re-run a game: the seed fixes every spawn, the
+// action log fixes every turn. 'score' and 'stateHash' are what the player's
+// game claimed at the end.
+struct Replay {
+    uint64_t seed;
+    std::vector<uint8_t> actions;  // one Direction per tick
+    int32_t score;
+    uint64_t stateHash;
+    char player[REPLAY_PLAYER_LENGTH];
+};
+
+// Fingerprint of a game's full state: score, tick, direction, every body
+// cell head to tail, food, power-up and its timers. Any divergence in the
+// rules or the RNG stream shows up here even when the score happens to match.
+template <typename SimT>
+uint64_t HashState(const SimT& sim) {
+    uint64_t hash = 0x9E3779B97F4A7C15ULL;
+    auto mix = [&hash](uint64_t value) {
+        hash ^= value + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2);
+        hash *= 0xBF58476D1CE4E5B9ULL;
+        hash ^= hash >> 31;
+    };
+
+    mix((uint64_t)(int64_t)sim.GetScore());
+    mix(sim.GetTick());
+    mix((uint64_t)sim.IsAlive() << 8 | (uint64_t)sim.GetDirection());
+    mix((uint64_t)sim.GetLength());
+    for (int i = 0; i < sim.GetBodySize(); i++) {
+        mix((uint64_t)sim.GetBodyCell(i));
+    }
+    mix((uint64_t)(int64_t)sim.GetFoodCell());
+    mix((uint64_t)(int64_t)sim.GetPowerUpCell() << 8 | (uint64_t)sim.GetPowerUpType());
+    for (int type = 0; type < POWERUP_TYPE_COUNT; type++) {
+        mix((uint64_t)sim.GetPowerUpTicksRemaining(static_cast<PowerUpType>(type)));
+    }
+    return hash;
+}
+
+// Plays a Simulation while logging its inputs into a Replay
+template <typename SimT>
+class ReplayRecorder {
+private:
+    SimT& sim;
+    Replay replay;
+
+public:
+    ReplayRecorder(SimT& sim, uint64_t seed, const char* player) : sim(sim) {
+        replay.seed = seed;
+        replay.score = 0;
+        replay.stateHash = 0;
+        std::memset(replay.player, 0, sizeof(replay.player));
+        std::strncpy(replay.player, player, REPLAY_PLAYER_LENGTH - 1);
+        sim.Reset(seed);
+    }
+
+    bool Step(Direction action) {
+        replay.actions.push_back((uint8_t)action);
+        return sim.Step(action);
+    }
+
+    // Stamps the claimed score and hash and hands the replay over
+    Replay Finish() {
+        replay.score = sim.GetScore();
+        replay.stateHash = HashState(sim);
+        return std::move(replay);
+    }
+};
+
+#endif
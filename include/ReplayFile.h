@@ -0,0 +1,398 @@
+#ifndef REPLAYFILE_H
+#define REPLAYFILE_H
+
+#include "Replay.h"
+#include "Simulation.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// On-disk replay container:
+//
+//     ReplayFileHeader
+//     input stream     one varint per direction change: (ticks since the
+//                      previous change << 2) | direction
+//     keyframes        SimulationKeyframe + body packed at 2 bits per segment
+//     index            one ReplayIndexEntry per keyframe
+//
+// A snake that holds a direction for hundreds of ticks costs one or two
+// bytes instead of one byte per tick, and its 10k-cell body is 2.5 KB in a
+// keyframe instead of 40 KB of cell ids.
+//
+// DATA STRUCTURE: Keyframe every keyframeInterval ticks, index in tick order
+// WHY: Seeking loads the keyframe at or before the target (the index is
+// regular, so finding it is a division) and re-simulates at most
+// keyframeInterval - 1 ticks, instead of every tick from the start.
+
+const uint32_t REPLAY_FILE_MAGIC = 0x504B4E53;  // "SNKP"
+const uint32_t REPLAY_FILE_VERSION = 1;
+// Bounds the ticks a file can claim per keyframe
+const uint32_t REPLAY_MAX_KEYFRAME_INTERVAL = 1 << 20;
+// Bounds what ReadReplay() allocates, one byte per tick: 64M ticks is about
+// four months of play at the 0.15s move interval
+const uint64_t REPLAY_MAX_TICKS = (uint64_t)1 << 26;
+// Largest board side a file may claim; players size boards and viewers
+// textures from the header before any keyframe is read
+const int32_t REPLAY_MAX_BOARD_SIDE = 4096;
+
+struct ReplayFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t seed;
+    uint64_t tickCount;
+    uint32_t keyframeInterval;
+    uint32_t keyframeCount;
+    uint64_t inputOffset;
+    uint64_t inputBytes;
+    uint64_t indexOffset;
+    int32_t boardWidth;
+    int32_t boardHeight;
+    int32_t score;
+    uint32_t reserved;
+    uint64_t stateHash;
+    char player[REPLAY_PLAYER_LENGTH];
+};
+
+struct ReplayIndexEntry {
+    uint64_t tick;             // keyframe state is after this many ticks
+    uint64_t changeTick;       // tick of the last direction change before it
+    uint64_t inputOffset;      // first change at or after 'tick', from inputOffset
+    uint64_t keyframeOffset;   // from the start of the file
+    uint32_t keyframeBytes;
+    uint8_t action;            // direction in effect at 'tick'
+    uint8_t reserved[3];
+};
+
+inline void AppendVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((uint8_t)value);
+}
+
+// Advances 'cursor'; false on a truncated or overlong varint
+inline bool ReadVarint(const uint8_t*& cursor, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && cursor < end; shift += 7) {
+        uint8_t byte = *cursor++;
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+// Direction from 'from' to the adjacent 'to', across an edge on wrapping boards
+template <typename BoardT>
+uint8_t StepDirection(const BoardT& board, int from, int to) {
+    int dx = board.X(to) - board.X(from);
+    int dy = board.Y(to) - board.Y(from);
+    if (dx == 1 || dx == 1 - board.Width()) return RIGHT;
+    if (dx == -1 || dx == board.Width() - 1) return LEFT;
+    if (dy == 1 || dy == 1 - board.Height()) return DOWN;
+    return UP;
+}
+
+template <typename BoardT>
+int StepCell(const BoardT& board, int cell, uint8_t dir) {
+    int x = board.X(cell);
+    int y = board.Y(cell);
+    switch (dir) {
+        case UP:    y = y == 0 ? board.Height() - 1 : y - 1; break;
+        case DOWN:  y = y == board.Height() - 1 ? 0 : y + 1; break;
+        case LEFT:  x = x == 0 ? board.Width() - 1 : x - 1; break;
+        default:    x = x == board.Width() - 1 ? 0 : x + 1; break;
+    }
+    return board.Index(x, y);
+}
+
+// Read side of the container. The file is memory-mapped, so opening a
+// million-tick replay costs a header check and nothing is copied until a
+// player decodes from it. A replay that is already in memory (one that came
+// over a socket) is read in place the same way.
+class ReplayReader {
+private:
+    const uint8_t* data;
+    size_t size;
+    const ReplayFileHeader* header;
+    const ReplayIndexEntry* index;
+    bool mapped;
+
+#if defined(_WIN32)
+    void* fileHandle;
+    void* mappingHandle;
+#else
+    int fd;
+#endif
+
+    bool Map(const char* path);
+    void Unmap();
+    bool Validate();
+
+public:
+    ReplayReader();
+    ~ReplayReader();
+
+    ReplayReader(const ReplayReader&) = delete;
+    ReplayReader& operator=(const ReplayReader&) = delete;
+
+    // False if the file is missing, truncated or not a replay
+    bool Open(const char* path);
+    // 'bytes' must be 8-byte aligned (the index is read in place) and
+    // outlive the reader; false if it is truncated or not a replay
+    bool Open(const uint8_t* bytes, size_t byteCount);
+    void Close();
+    bool IsOpen() const { return header != nullptr; }
+
+    const ReplayFileHeader& GetHeader() const { return *header; }
+    uint64_t GetTickCount() const { return header->tickCount; }
+    size_t GetFileSize() const { return size; }
+
+    // Last keyframe at or before 'tick'
+    const ReplayIndexEntry& FindKeyframe(uint64_t tick) const;
+    const uint8_t* GetKeyframeData(const ReplayIndexEntry& entry) const { return data + entry.keyframeOffset; }
+    const uint8_t* GetInputBegin() const { return data + header->inputOffset; }
+    const uint8_t* GetInputEnd() const { return data + header->inputOffset + header->inputBytes; }
+
+    // Expands the input stream back into one action per tick, for the verifier
+    bool ReadReplay(Replay& replay) const;
+};
+
+// Records a game into the container while it is played
+template <typename SimT>
+class ReplayWriter {
+private:
+    SimT& sim;
+    ReplayFileHeader header;
+    std::vector<uint8_t> inputs;
+    std::vector<uint8_t> keyframes;
+    std::vector<ReplayIndexEntry> index;
+    std::vector<int> cells;
+    uint8_t action;
+    uint64_t changeTick;
+
+    void AddKeyframe() {
+        ReplayIndexEntry entry;
+        std::memset(&entry, 0, sizeof(entry));
+        entry.tick = sim.GetTick();
+        entry.changeTick = changeTick;
+        entry.inputOffset = inputs.size();
+        entry.keyframeOffset = keyframes.size();  // made absolute in Save()
+        entry.action = action;
+
+        SimulationKeyframe frame;
+        sim.SaveKeyframe(frame, cells);
+        const uint8_t* raw = reinterpret_cast<const uint8_t*>(&frame);
+        keyframes.insert(keyframes.end(), raw, raw + sizeof(frame));
+
+        // Segment i is the step from cell i to cell i + 1, four to a byte
+        uint8_t packed = 0;
+        int segments = (int)cells.size() - 1;
+        for (int i = 0; i < segments; i++) {
+            packed |= StepDirection(sim.GetBoard(), cells[i], cells[i + 1]) << ((i & 3) * 2);
+            if ((i & 3) == 3 || i == segments - 1) {
+                keyframes.push_back(packed);
+                packed = 0;
+            }
+        }
+
+        entry.keyframeBytes = (uint32_t)(keyframes.size() - entry.keyframeOffset);
+        index.push_back(entry);
+    }
+
+public:
+    explicit ReplayWriter(SimT& sim, uint32_t keyframeInterval = 4096) : sim(sim) {
+        std::memset(&header, 0, sizeof(header));
+        if (keyframeInterval < 1) keyframeInterval = 1;
+        if (keyframeInterval > REPLAY_MAX_KEYFRAME_INTERVAL) keyframeInterval = REPLAY_MAX_KEYFRAME_INTERVAL;
+        header.keyframeInterval = keyframeInterval;
+    }
+
+    // Resets the simulation and starts a new recording
+    void Begin(uint64_t seed, const char* player) {
+        sim.Reset(seed);
+        header.seed = seed;
+        std::memset(header.player, 0, sizeof(header.player));
+        std::strncpy(header.player, player, REPLAY_PLAYER_LENGTH - 1);
+
+        inputs.clear();
+        keyframes.clear();
+        index.clear();
+        action = RIGHT;
+        changeTick = 0;
+        AddKeyframe();
+    }
+
+    bool Step(Direction next) {
+        if (!sim.IsAlive()) return false;
+
+        if ((uint8_t)next != action) {
+            uint64_t now = sim.GetTick();
+            AppendVarint(inputs, (now - changeTick) << 2 | (uint64_t)next);
+            action = (uint8_t)next;
+            changeTick = now;
+        }
+
+        bool alive = sim.Step(next);
+        if (alive && sim.GetTick() % header.keyframeInterval == 0) {
+            AddKeyframe();
+        }
+        return alive;
+    }
+
+    // Capacity for a recording of up to 'bytes' encoded bytes, so that Step()
+    // never allocates while GetEncodedBytes() + GetMaxStepBytes() stays in it
+    void Reserve(size_t bytes) {
+        inputs.reserve(bytes);
+        keyframes.reserve(bytes);
+        index.reserve(bytes / sizeof(ReplayIndexEntry) + 1);
+        cells.reserve(sim.GetBoard().Cells());
+    }
+
+    // Stamps the final score and state hash and lays out the whole file in
+    // 'out' (no allocation if it already has GetEncodedBytes() capacity)
+    bool Encode(std::vector<uint8_t>& out) {
+        if (sim.GetTick() > REPLAY_MAX_TICKS) return false;
+        header.magic = REPLAY_FILE_MAGIC;
+        header.version = REPLAY_FILE_VERSION;
+        header.tickCount = sim.GetTick();
+        header.keyframeCount = (uint32_t)index.size();
+        header.inputOffset = sizeof(ReplayFileHeader);
+        header.inputBytes = inputs.size();
+        header.boardWidth = sim.GetBoard().Width();
+        header.boardHeight = sim.GetBoard().Height();
+        header.score = sim.GetScore();
+        header.stateHash = HashState(sim);
+
+        uint64_t keyframeStart = header.inputOffset + header.inputBytes;
+        header.indexOffset = (keyframeStart + keyframes.size() + 7) & ~(uint64_t)7;  // entries are read in place
+
+        const uint8_t* raw = reinterpret_cast<const uint8_t*>(&header);
+        out.assign(raw, raw + sizeof(header));
+        out.insert(out.end(), inputs.begin(), inputs.end());
+        out.insert(out.end(), keyframes.begin(), keyframes.end());
+        out.resize(header.indexOffset, 0);
+        for (ReplayIndexEntry entry : index) {
+            entry.keyframeOffset += keyframeStart;
+            raw = reinterpret_cast<const uint8_t*>(&entry);
+            out.insert(out.end(), raw, raw + sizeof(entry));
+        }
+        return true;
+    }
+
+    bool Save(const char* path) {
+        std::vector<uint8_t> bytes;
+        if (!Encode(bytes)) return false;
+
+        FILE* out = std::fopen(path, "wb");
+        if (!out) return false;
+        bool ok = std::fwrite(bytes.data(), 1, bytes.size(), out) == bytes.size();
+        ok = std::fclose(out) == 0 && ok;
+        return ok;
+    }
+
+    size_t GetEncodedBytes() const {
+        size_t indexOffset = (sizeof(ReplayFileHeader) + inputs.size() + keyframes.size() + 7) & ~(size_t)7;
+        return indexOffset + index.size() * sizeof(ReplayIndexEntry);
+    }
+
+    // Most one Step() can add: a direction change, a keyframe of a snake
+    // that fills the board, and its index entry
+    size_t GetMaxStepBytes() const {
+        return 10 + sizeof(SimulationKeyframe) + (size_t)(sim.GetBoard().Cells() + 3) / 4 +
+               sizeof(ReplayIndexEntry);
+    }
+};
+
+// Plays a replay file back through a Simulation, forwards one tick at a
+// time or jumping to any tick via the nearest keyframe
+template <typename SimT>
+class ReplayPlayer {
+private:
+    const ReplayReader& reader;
+    SimT sim;
+    std::vector<int> cells;
+    const uint8_t* cursor;
+    uint64_t nextChangeTick;
+    uint8_t nextAction;
+    uint8_t action;
+
+    void ReadChange(uint64_t fromTick) {
+        uint64_t value;
+        if (ReadVarint(cursor, reader.GetInputEnd(), value)) {
+            nextChangeTick = fromTick + (value >> 2);
+            nextAction = (uint8_t)(value & 3);
+        } else {
+            nextChangeTick = UINT64_MAX;
+        }
+    }
+
+    bool LoadKeyframe(const ReplayIndexEntry& entry) {
+        SimulationKeyframe frame;
+        if (entry.keyframeBytes < sizeof(frame)) return false;
+        const uint8_t* bytes = reader.GetKeyframeData(entry);
+        std::memcpy(&frame, bytes, sizeof(frame));
+        bytes += sizeof(frame);
+
+        // The head anchors the decoded body, so it is checked before it is
+        // stepped from; the rest is checked by the simulation
+        int bodySize = frame.bodySize;
+        if (frame.tick != entry.tick || bodySize < 1 || bodySize > sim.GetBoard().Cells() ||
+            frame.headCell < 0 || frame.headCell >= sim.GetBoard().Cells() ||
+            entry.keyframeBytes < sizeof(frame) + (size_t)(bodySize + 2) / 4) {
+            return false;
+        }
+
+        cells.resize(bodySize);
+        cells[0] = frame.headCell;
+        for (int i = 1; i < bodySize; i++) {
+            uint8_t dir = (bytes[(i - 1) >> 2] >> (((i - 1) & 3) * 2)) & 3;
+            cells[i] = StepCell(sim.GetBoard(), cells[i - 1], dir);
+        }
+        if (!sim.LoadKeyframe(frame, cells.data())) return false;
+
+        cursor = reader.GetInputBegin() + entry.inputOffset;
+        action = entry.action;
+        ReadChange(entry.changeTick);
+        return true;
+    }
+
+public:
+    explicit ReplayPlayer(const ReplayReader& reader, const SimT& prototype = SimT())
+        : reader(reader), sim(prototype), cursor(nullptr), nextChangeTick(UINT64_MAX),
+          nextAction(RIGHT), action(RIGHT) {}
+
+    // False if the replay was recorded on a different board size or is corrupt
+    bool Seek(uint64_t tick) {
+        const ReplayFileHeader& header = reader.GetHeader();
+        if (header.boardWidth != sim.GetBoard().Width() || header.boardHeight != sim.GetBoard().Height()) {
+            return false;
+        }
+        if (tick > header.tickCount) tick = header.tickCount;
+
+        if (!LoadKeyframe(reader.FindKeyframe(tick))) return false;
+        while (sim.GetTick() < tick && Step()) {
+        }
+        return true;
+    }
+
+    // False at the end of the recording
+    bool Step() {
+        uint64_t now = sim.GetTick();
+        if (now >= reader.GetHeader().tickCount || !sim.IsAlive()) return false;
+
+        if (now == nextChangeTick) {
+            action = nextAction;
+            ReadChange(now);
+        }
+        sim.Step(static_cast<Direction>(action));
+        return true;
+    }
+
+    const SimT& GetSimulation() const { return sim; }
+    uint64_t GetTick() const { return sim.GetTick(); }
+    bool AtEnd() const { return sim.GetTick() >= reader.GetHeader().tickCount || !sim.IsAlive(); }
+};
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef REPLAYVERIFIER_H
+#define REPLAYVERIFIER_H
+
+#include "Replay.h"
+#include "ThreadPool.h"
+#include <memory>
+#include <vector>
+
+enum ReplayVerdict {
+    REPLAY_OK,
+    REPLAY_DIED_EARLY,       // inputs continue after the snake died
+    REPLAY_SCORE_MISMATCH,
+    REPLAY_HASH_MISMATCH     // score matches, final state does not
+};
+
+// Anti-cheat check for leaderboard submissions (server/leaderboard.cpp runs
+// every submitted replay through VerifyAll): re-simulates each replay on
+// the headless core (ClassicRules are Game::CheckCollisions) and compares
+// the claimed score and state hash with what the inputs really produce.
+// Replays are dealt to the work-stealing pool in small chunks, since their
+// lengths vary by orders of magnitude, and each worker reuses one Simulation.
+template <typename SimT>
+class ReplayVerifier {
+private:
+    struct alignas(64) WorkerState {
+        std::unique_ptr<SimT> sim;
+        uint64_t ticks = 0;
+    };
+
+    struct Context {
+        ReplayVerifier* verifier;
+        const Replay* replays;
+        ReplayVerdict* verdicts;
+    };
+
+    ThreadPool& pool;
+    SimT prototype;
+    int chunk;
+    std::vector<WorkerState> workers;
+
+    static void VerifyChunk(void* context, int begin, int end) {
+        const Context& ctx = *static_cast<const Context*>(context);
+        WorkerState& state = ctx.verifier->workers[ThreadPool::CurrentWorker()];
+        if (!state.sim) {
+            state.sim.reset(new SimT(ctx.verifier->prototype));
+        }
+
+        for (int i = begin; i < end; i++) {
+            ctx.verdicts[i] = Verify(*state.sim, ctx.replays[i]);
+            state.ticks += state.sim->GetTick();
+        }
+    }
+
+public:
+    ReplayVerifier(ThreadPool& pool, const SimT& prototype = SimT(), int chunk = 16)
+        : pool(pool), prototype(prototype), chunk(chunk), workers(pool.Size()) {}
+
+    static ReplayVerdict Verify(SimT& sim, const Replay& replay) {
+        sim.Reset(replay.seed);
+
+        size_t count = replay.actions.size();
+        for (size_t i = 0; i < count; i++) {
+            if (!sim.Step(static_cast<Direction>(replay.actions[i] & 3)) && i + 1 < count) {
+                return REPLAY_DIED_EARLY;
+            }
+        }
+
+        if (sim.GetScore() != replay.score) return REPLAY_SCORE_MISMATCH;
+        if (HashState(sim) != replay.stateHash) return REPLAY_HASH_MISMATCH;
+        return REPLAY_OK;
+    }
+
+    std::vector<ReplayVerdict> VerifyAll(const std::vector<Replay>& replays) {
+        std::vector<ReplayVerdict> verdicts(replays.size());
+        Context context = {this, replays.data(), verdicts.data()};
+
+        TaskGroup group;
+        pool.ParallelFor(group, (int)replays.size(), chunk, &ReplayVerifier::VerifyChunk, &context);
+        group.Wait();
+        return verdicts;
+    }
+
+    uint64_t GetTicksSimulated() const {
+        uint64_t total = 0;
+        for (const WorkerState& state : workers) {
+            total += state.ticks;
+        }
+        return total;
+    }
+};
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef REPLAYVIEWER_H
+#define REPLAYVIEWER_H
+
+#include "raylib.h"
+#include "ReplayFile.h"
+#include <memory>
+#include <vector>
+
+// Plays a replay file (see ReplayFile.h) in the window at 1x-1000x.
+// Each frame steps the simulation as many ticks as the speed calls for and
+// draws only the state it lands on, so speed costs simulation time, not
+// draw calls. LEFT/RIGHT and the progress bar seek through keyframes.
+//
+// DATA STRUCTURE: Board texture at one pixel per cell, scaled up on draw
+// WHY: A long snake is one texture upload and one textured quad instead of
+// a rectangle per segment, so a 10k-cell body costs the same to draw as a
+// 3-cell one. The grid lines never change and are drawn once into a
+// render texture.
+class ReplayViewer {
+private:
+    using Player = ReplayPlayer<RuntimeSimulation>;
+
+    int screenWidth;
+    int screenHeight;
+    ReplayReader reader;
+    std::unique_ptr<Player> player;
+
+    int cellSize;
+    Rectangle boardArea;
+    Texture2D boardTexture;
+    RenderTexture2D gridTexture;
+    std::vector<Color> pixels;
+    bool texturesLoaded;
+    bool boardDirty;
+
+    int speedIndex;
+    bool paused;
+    bool dragging;
+    double ticksOwed;
+
+    void HandleInput();
+    void Update();
+    void Draw();
+    void Seek(uint64_t tick);
+    void LoadTextures(int boardWidth, int boardHeight);
+    void UnloadTextures();
+    void UpdateBoardTexture();
+    Rectangle GetProgressBar() const;
+    void DrawHUD() const;
+
+public:
+    ReplayViewer(int width, int height, const char* title);
+    ~ReplayViewer();
+
+    // False if the file is not a readable replay
+    bool Load(const char* path);
+    void Run();
+};
+
+#endif
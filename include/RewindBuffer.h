@@ -0,0 +1,64 @@
+#ifndef REWINDBUFFER_H
+#define REWINDBUFFER_H
+
+#include "raylib.h"
+#include "GameTypes.h"
+#include "PowerUp.h"
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+// What one snake move changed, enough to put it back
+struct RewindEntry {
+    Vector2 removedTail;      // cell Move() dropped off the back
+    Vector2 foodPosition;
+    uint32_t bodySize;        // before the move; one more after it means it ate
+    int32_t score;
+    Direction direction;
+    Direction nextDirection;
+    PowerUpState powerUp;
+};
+
+// Undo log of the last moves of a live game; holding R pops them one by one.
+//
+// DATA STRUCTURE: Ring buffer of per-move deltas, oldest overwritten
+// WHY: A move only changes the two ends of the body, so an entry is a tail
+// cell plus a few scalars (~100 bytes) whatever the snake's length, and
+// recording is a fixed-size copy into a preallocated slot. Memory is fixed
+// at construction; once full, each new move drops the oldest one.
+class RewindBuffer {
+private:
+    std::pmr::vector<RewindEntry> entries;
+    uint32_t next;   // slot the next Push() fills
+    uint32_t count;
+
+public:
+    RewindBuffer(uint32_t capacity, std::pmr::memory_resource* memory = std::pmr::get_default_resource())
+        : entries(capacity > 0 ? capacity : 1, memory), next(0), count(0) {}
+
+    // Slot for the move about to happen, filled in place
+    RewindEntry& Push() {
+        RewindEntry& entry = entries[next];
+        next = next + 1 == entries.size() ? 0 : next + 1;
+        if (count < entries.size()) count++;
+        return entry;
+    }
+
+    // Newest entry, removed from the log; null once it is empty
+    const RewindEntry* Pop() {
+        if (count == 0) return nullptr;
+        next = next == 0 ? (uint32_t)entries.size() - 1 : next - 1;
+        count--;
+        return &entries[next];
+    }
+
+    void Clear() {
+        next = 0;
+        count = 0;
+    }
+
+    uint32_t Size() const { return count; }
+    uint32_t Capacity() const { return (uint32_t)entries.size(); }
+};
+
+#endif
@@ -0,0 +1,115 @@
+#ifndef RULEPOLICIES_H
+#define RULEPOLICIES_H
+
+#include "GameTypes.h"
+
+// Compile-time rule policies for Simulation. Every variant is a distinct
+// type, so Step() is specialised per variant and never branches on config.
+
+// ---- Wall policies: return the next head cell, or -1 for death ----
+// WRAPS: the board is a torus, so observations see across the edges
+
+struct DieAtWalls {
+    static constexpr bool WRAPS = false;
+
+    template <typename BoardT>
+    static int Next(const BoardT& board, int head, Direction& dir, bool invincible) {
+        int next = board.Neighbor(head, dir);
+        // Game lets an invincible snake leave the screen; a bitboard
+        // cannot, so it wraps around instead
+        return (next < 0 && invincible) ? board.Wrap(head, dir) : next;
+    }
+};
+
+struct WrapAtWalls {
+    static constexpr bool WRAPS = true;
+
+    template <typename BoardT>
+    static int Next(const BoardT& board, int head, Direction& dir, bool) {
+        return board.Wrap(head, dir);
+    }
+};
+
+// Turns clockwise (then anticlockwise) along the wall instead of dying
+struct BounceAtWalls {
+    static constexpr bool WRAPS = false;
+
+    template <typename BoardT>
+    static int Next(const BoardT& board, int head, Direction& dir, bool) {
+        int next = board.Neighbor(head, dir);
+        if (next >= 0) return next;
+
+        static const Direction clockwise[] = {RIGHT, LEFT, UP, DOWN};
+        static const Direction anticlockwise[] = {LEFT, RIGHT, DOWN, UP};
+
+        Direction turn = clockwise[dir];
+        next = board.Neighbor(head, turn);
+        if (next < 0) {
+            turn = anticlockwise[dir];
+            next = board.Neighbor(head, turn);
+        }
+        dir = turn;
+        return next;
+    }
+};
+
+// ---- Growth per food ----
+
+template <int N>
+struct GrowBy {
+    static constexpr int AMOUNT = N;
+};
+
+// ---- Scoring: base points per food, scaled while SCORE_MULTIPLIER is active ----
+
+template <int POINTS, int MULTIPLIER>
+struct FoodScore {
+    static constexpr int Points(bool boosted) {
+        return POINTS + POINTS * (MULTIPLIER - 1) * (int)boosted;
+    }
+};
+
+// ---- Enabled power-up set (bit per PowerUpType) ----
+
+const unsigned POWERUPS_NONE = 0;
+const unsigned POWERUPS_ALL = (1u << SPEED_BOOST) | (1u << SCORE_MULTIPLIER) | (1u << INVINCIBILITY);
+
+template <unsigned MASK>
+struct PowerUpSet {
+    static constexpr bool ANY = MASK != 0;
+    static constexpr int COUNT = ((MASK >> SPEED_BOOST) & 1) +
+                                 ((MASK >> SCORE_MULTIPLIER) & 1) +
+                                 ((MASK >> INVINCIBILITY) & 1);
+
+    static constexpr bool Enabled(PowerUpType type) { return (MASK >> type) & 1; }
+
+    // Maps a random roll in [0, COUNT) onto the enabled types
+    static constexpr PowerUpType Pick(unsigned roll) {
+        for (int type = 0; type < POWERUP_TYPE_COUNT; type++) {
+            if ((MASK >> type) & 1) {
+                if (roll-- == 0) return static_cast<PowerUpType>(type);
+            }
+        }
+        return SPEED_BOOST;
+    }
+};
+
+template <typename WallPolicy, typename GrowthPolicy, typename ScorePolicy, typename PowerUpPolicy>
+struct Rules {
+    using Walls = WallPolicy;
+    using Growth = GrowthPolicy;
+    using Scoring = ScorePolicy;
+    using PowerUps = PowerUpPolicy;
+};
+
+// The rules hard-coded in Game::CheckCollisions
+using ClassicRules = Rules<DieAtWalls, GrowBy<1>, FoodScore<10, 2>, PowerUpSet<POWERUPS_ALL>>;
+
+using WrapRules = Rules<WrapAtWalls, GrowBy<1>, FoodScore<10, 2>, PowerUpSet<POWERUPS_ALL>>;
+using BounceRules = Rules<BounceAtWalls, GrowBy<1>, FoodScore<10, 2>, PowerUpSet<POWERUPS_ALL>>;
+
+// No power-ups at all: the power-up timers and spawn code compile away
+using PureRules = Rules<DieAtWalls, GrowBy<1>, FoodScore<10, 1>, PowerUpSet<POWERUPS_NONE>>;
+using PureWrapRules = Rules<WrapAtWalls, GrowBy<3>, FoodScore<10, 1>, PowerUpSet<POWERUPS_NONE>>;
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef RUNLENGTHRENDERER_H
+#define RUNLENGTHRENDERER_H
+
+#include "raylib.h"
+#include "RunLengthSnake.h"
+
+// Draws a RunLengthSnake at 'cellSize' pixels per cell, one rectangle per
+// run plus the head cell, so draw calls scale with turns, not length.
+// Kept out of RunLengthSnake.cpp so the headless build stays raylib-free.
+void DrawRunLengthSnake(const RunLengthSnake& snake, int cellSize, Color bodyColor, Color headColor);
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef RUNLENGTHSNAKE_H
+#define RUNLENGTHSNAKE_H
+
+#include "GameTypes.h"
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <unordered_map>
+
+// Grid coordinates (cells, not pixels) so giant boards stay exact
+struct GridCell {
+    int x;
+    int y;
+};
+
+// A straight stretch of body: 'start' is the cell nearest the head and the
+// run extends 'length' cells back against 'direction'
+struct BodyRun {
+    GridCell start;
+    Direction direction;
+    int length;
+};
+
+// Snake body backend for giant boards (4096x4096 and up). Memory and per-tick
+// work scale with the number of turns instead of the length of the snake.
+// Headless: DrawRunLengthSnake (RunLengthRenderer.h) draws it in the game.
+//
+// DATA STRUCTURE: Deque of runs, head run at the front
+// WHY: A move only extends the front run (or pushes a new one on a turn)
+// and shortens the back one, so a million-cell snake with a few hundred
+// turns is a few hundred entries instead of a million cells.
+//
+// DATA STRUCTURE: Interval index, one ordered map per row (horizontal runs)
+// and per column (vertical runs), keyed by the run's lowest coordinate
+// WHY: The body never overlaps itself, so the runs on one line are disjoint
+// and a cell can only be inside the last run starting at or before it. An
+// occupancy test is O(log runs on that line) instead of a walk over every
+// run, and the index stays O(runs) in size where a bitset would be O(board).
+class RunLengthSnake {
+private:
+    // Lowest coordinate -> run serial. Serials count up as runs are pushed
+    // at the front, so runs[frontSerial - serial] is the run.
+    typedef std::multimap<int, int64_t> LineIndex;
+
+    std::deque<BodyRun> runs;
+    std::unordered_map<int, LineIndex> rows;
+    std::unordered_map<int, LineIndex> columns;
+    int64_t frontSerial;
+    Direction currentDirection;
+    Direction nextDirection;
+    int length;
+    int pendingGrowth;
+    bool collided;
+
+    static GridCell Step(GridCell cell, Direction dir, int count);
+    static bool RunContains(const BodyRun& run, GridCell cell);
+    static bool IsHorizontal(Direction dir) { return dir == LEFT || dir == RIGHT; }
+    static int Low(const BodyRun& run);
+
+    void Index(const BodyRun& run, int64_t serial);
+    void Unindex(const BodyRun& run, int64_t serial);
+    bool LineOccupies(const std::unordered_map<int, LineIndex>& lines, int line, int position, GridCell cell) const;
+
+public:
+    explicit RunLengthSnake(GridCell startCell);
+    void SetDirection(Direction dir);
+    void Move();
+    void Grow();
+    // True if the last Move() ran the head into the body
+    bool CheckSelfCollision() const { return collided; }
+    bool Occupies(GridCell cell) const;
+    GridCell GetHeadCell() const { return runs.front().start; }
+    GridCell GetTailCell() const;
+    Direction GetDirection() const { return currentDirection; }
+
+    int GetLength() const { return length; }
+    const std::deque<BodyRun>& GetRuns() const { return runs; }
+};
+
+#endif
@@ -0,0 +1,420 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "AllocProfiler.h"
+#include "Board.h"
+#include "GameTypes.h"
+#include "PerfCounters.h"
+#include "Random.h"
+#include "RulePolicies.h"
+#include <cstdint>
+#include <vector>
+
+// Everything in a Simulation except the body cells, as plain data so replay
+// keyframes can store it verbatim (see ReplayFile.h)
+struct SimulationKeyframe {
+    uint64_t tick;
+    uint32_t rng[4];
+    int32_t score;
+    int32_t bodySize;
+    int32_t pendingGrowth;
+    int32_t overlaps;
+    int32_t foodCell;
+    int32_t powerUpCell;
+    int32_t powerUpType;
+    int32_t powerUpSpawnTimer;
+    int32_t activeTicks[POWERUP_TYPE_COUNT];
+    int32_t headCell;
+    uint8_t direction;
+    uint8_t alive;
+    uint8_t reserved[6];
+};
+
+// Headless, tick-based mirror of the rules in Game::CheckCollisions.
+// No raylib, no wall-clock time: one Step() is one snake move. Power-up
+// timers are converted from seconds at the 0.15s base move interval.
+// RulesT selects the variant at compile time (see RulePolicies.h).
+template <typename BoardT, typename RulesT = ClassicRules>
+class Simulation {
+private:
+    using Walls = typename RulesT::Walls;
+    using PowerUps = typename RulesT::PowerUps;
+
+    BoardT board;
+
+    // DATA STRUCTURE: Ring buffer of cell ids, head at headIndex
+    // WHY: Fixed capacity (one slot per cell), so steady-state ticks never allocate
+    std::vector<int> body;
+    int headIndex;
+    int length;
+    int pendingGrowth;
+    int overlaps;
+    bool tailShared;  // the tail cell is also further up the body
+    int lastRemovedTail;
+
+    Direction currentDirection;
+    Direction nextDirection;
+
+    int foodCell;
+    int powerUpCell;
+    PowerUpType powerUpType;
+    int powerUpSpawnTimer;
+    int activeTicks[POWERUP_TYPE_COUNT];
+
+    int score;
+    bool alive;
+    uint64_t tick;
+    Xoshiro128Plus rng;
+
+    int BodyCell(int i) const {
+        int capacity = (int)body.size();
+        int index = headIndex + i;
+        return index >= capacity ? index - capacity : index;
+    }
+
+    void PushHead(int cell) {
+        headIndex = headIndex == 0 ? (int)body.size() - 1 : headIndex - 1;
+        body[headIndex] = cell;
+        length++;
+        board.Set(cell);
+    }
+
+    void PopTail() {
+        int tail = body[BodyCell(length - 1)];
+        length--;
+        lastRemovedTail = tail;
+
+        // Invincible snakes may pass through themselves; only clear the bit
+        // once the last copy of the cell leaves the body. While copies
+        // remain, one pass finds out whether the new tail has one too, so
+        // neither this nor GetActionMask() has to scan for it later.
+        bool stillOccupied = tailShared;
+        tailShared = false;
+        overlaps -= stillOccupied;
+        if (overlaps > 0 && length > 0) {
+            int newTail = body[BodyCell(length - 1)];
+            for (int i = 0; i < length - 1; i++) {
+                tailShared |= body[BodyCell(i)] == newTail;
+            }
+        }
+        if (!stillOccupied) board.Clear(tail);
+    }
+
+    // Rejection sampling is O(1) on a sparse board; the counted scan below
+    // only runs once the snake fills most of it
+    int RandomFreeCell() {
+        int cells = board.Cells();
+        for (int attempt = 0; attempt < 16; attempt++) {
+            int cell = (int)RandomBelow(rng.Next(), (uint32_t)cells);
+            if (!board.Test(cell) && cell != foodCell && cell != powerUpCell) {
+                return cell;
+            }
+        }
+
+        int freeCount = 0;
+        for (int cell = 0; cell < cells; cell++) {
+            if (!board.Test(cell) && cell != foodCell && cell != powerUpCell) {
+                freeCount++;
+            }
+        }
+        if (freeCount == 0) return -1;
+
+        int target = (int)RandomBelow(rng.Next(), (uint32_t)freeCount);
+        for (int cell = 0; cell < cells; cell++) {
+            if (!board.Test(cell) && cell != foodCell && cell != powerUpCell) {
+                if (target-- == 0) return cell;
+            }
+        }
+        return -1;
+    }
+
+public:
+    static constexpr int POWERUP_SPAWN_TICKS = 67;     // 10s
+    static constexpr int POWERUP_DURATION_TICKS = 33;  // 5s
+    static constexpr bool WRAPS = Walls::WRAPS;
+    using BoardType = BoardT;
+
+    explicit Simulation(uint64_t seed = 1, BoardT board = BoardT())
+        : board(board), body(board.Cells()) {
+        Reset(seed);
+    }
+
+    void Reset(uint64_t seed) {
+        board.Reset();
+        headIndex = 0;
+        length = 0;
+        pendingGrowth = 0;
+        overlaps = 0;
+        tailShared = false;
+        lastRemovedTail = -1;
+        currentDirection = RIGHT;
+        nextDirection = RIGHT;
+        foodCell = -1;
+        powerUpCell = -1;
+        powerUpType = SPEED_BOOST;
+        powerUpSpawnTimer = 0;
+        for (int i = 0; i < POWERUP_TYPE_COUNT; i++) activeTicks[i] = 0;
+        score = 0;
+        alive = true;
+        tick = 0;
+
+        rng.Seed(seed);
+
+        // Same layout as Game: length 3, heading right from the centre
+        int cx = board.Width() / 2;
+        int cy = board.Height() / 2;
+        PushHead(board.Index(cx - 2, cy));
+        PushHead(board.Index(cx - 1, cy));
+        PushHead(board.Index(cx, cy));
+
+        foodCell = RandomFreeCell();
+    }
+
+    void SetDirection(Direction dir) {
+        if ((currentDirection == UP && dir == DOWN) ||
+            (currentDirection == DOWN && dir == UP) ||
+            (currentDirection == LEFT && dir == RIGHT) ||
+            (currentDirection == RIGHT && dir == LEFT)) {
+            return;
+        }
+        nextDirection = dir;
+    }
+
+    // Advances one move. Returns false once the snake is dead.
+    bool Step(Direction action) {
+        ASSERT_NO_ALLOCS();
+        PERF_SCOPE(PERF_REGION_SIM_STEP);
+        if (!alive) return false;
+
+        SetDirection(action);
+        currentDirection = nextDirection;
+        tick++;
+        lastRemovedTail = -1;
+
+        bool invincible = false;
+        if constexpr (PowerUps::Enabled(INVINCIBILITY)) {
+            invincible = activeTicks[INVINCIBILITY] > 0;
+        }
+
+        int head = body[headIndex];
+        int next = Walls::Next(board, head, currentDirection, invincible);
+        nextDirection = currentDirection;
+
+        if (next < 0) {
+            alive = false;
+            return false;
+        }
+
+        // Tail leaves before the head arrives, as in Snake::Move
+        if (pendingGrowth > 0) {
+            pendingGrowth--;
+        } else {
+            PopTail();
+        }
+
+        if (board.Test(next)) {
+            if (!invincible) {
+                alive = false;
+                return false;
+            }
+            overlaps++;
+            tailShared |= next == body[BodyCell(length - 1)];
+        }
+        PushHead(next);
+
+        bool boosted = false;
+        if constexpr (PowerUps::ANY) {
+            for (int i = 0; i < POWERUP_TYPE_COUNT; i++) {
+                activeTicks[i] -= activeTicks[i] > 0;
+            }
+            if constexpr (PowerUps::Enabled(SCORE_MULTIPLIER)) {
+                boosted = activeTicks[SCORE_MULTIPLIER] > 0;
+            }
+        }
+
+        if (next == foodCell) {
+            // The ring holds one slot per cell; an invincible snake that
+            // fills the board stops growing instead of overrunning it
+            pendingGrowth += RulesT::Growth::AMOUNT;
+            if (pendingGrowth > (int)body.size() - length) pendingGrowth = (int)body.size() - length;
+            score += RulesT::Scoring::Points(boosted);
+            foodCell = -1;
+            foodCell = RandomFreeCell();
+        }
+
+        if constexpr (PowerUps::ANY) {
+            if (next == powerUpCell) {
+                activeTicks[powerUpType] = POWERUP_DURATION_TICKS;
+                powerUpCell = -1;
+                powerUpSpawnTimer = 0;
+            } else if (powerUpCell < 0 && ++powerUpSpawnTimer >= POWERUP_SPAWN_TICKS) {
+                powerUpCell = RandomFreeCell();
+                powerUpType = PowerUps::Pick(RandomBelow(rng.Next(), PowerUps::COUNT));
+                powerUpSpawnTimer = 0;
+            }
+        }
+
+        return true;
+    }
+
+    // Bits 0-3: legal actions (not a reversal), indexed by Direction.
+    // Bits 4-7: legal and survivable next tick given walls, body (the tail
+    // cell counts as free when it is about to move) and INVINCIBILITY.
+    uint8_t GetActionMask() const {
+        int head = body[headIndex];
+        int tail = GetTailCell();
+        unsigned tailMoves = IsTailMoving();
+
+        unsigned invincible = 0;
+        if constexpr (PowerUps::Enabled(INVINCIBILITY)) {
+            invincible = activeTicks[INVINCIBILITY] > 0;
+        }
+
+        unsigned mask = 0;
+        for (int d = 0; d < 4; d++) {
+            Direction dir = static_cast<Direction>(d);
+            int next = NextCell(board, head, dir, invincible != 0);
+
+            unsigned legal = (currentDirection ^ d) != 1;
+            unsigned inside = next >= 0;
+            int cell = inside ? next : head;
+            unsigned occupied = board.Test(cell) & ((tailMoves & (cell == tail)) ^ 1);
+            unsigned safe = legal & inside & (invincible | (occupied ^ 1));
+
+            mask |= (legal << d) | (safe << (4 + d));
+        }
+        return (uint8_t)mask;
+    }
+
+    // Cell a move in 'dir' lands on (-1: death at a wall), as Step() sees it
+    static int NextCell(const BoardT& board, int head, Direction dir, bool invincible) {
+        return Walls::Next(board, head, dir, invincible);
+    }
+
+    // The tail cell frees up next tick: no growth pending, and (after an
+    // invincible overlap) no other copy of it further up the body
+    bool IsTailMoving() const { return pendingGrowth == 0 && !tailShared; }
+
+    // Body cells go to 'cells', head first
+    void SaveKeyframe(SimulationKeyframe& frame, std::vector<int>& cells) const {
+        frame = SimulationKeyframe();
+        frame.tick = tick;
+        for (int i = 0; i < 4; i++) frame.rng[i] = rng.s[i];
+        frame.score = score;
+        frame.bodySize = length;
+        frame.pendingGrowth = pendingGrowth;
+        frame.overlaps = overlaps;
+        frame.foodCell = foodCell;
+        frame.powerUpCell = powerUpCell;
+        frame.powerUpType = powerUpType;
+        frame.powerUpSpawnTimer = powerUpSpawnTimer;
+        for (int i = 0; i < POWERUP_TYPE_COUNT; i++) frame.activeTicks[i] = activeTicks[i];
+        frame.headCell = body[headIndex];
+        frame.direction = (uint8_t)currentDirection;
+        frame.alive = alive;
+
+        cells.resize(length);
+        for (int i = 0; i < length; i++) {
+            cells[i] = body[BodyCell(i)];
+        }
+    }
+
+    // Keyframes come from files: every cell id and enum must fit this board
+    // before any of it is used as an index, and the body must be one a game
+    // could reach (a chain of neighbours that fits the ring with its growth)
+    bool IsValidKeyframe(const SimulationKeyframe& frame, const int* cells) const {
+        int cellCount = board.Cells();
+        if (frame.bodySize < 1 || frame.bodySize > cellCount) return false;
+        if (frame.pendingGrowth < 0 || frame.pendingGrowth > cellCount - frame.bodySize) return false;
+        if (frame.overlaps < 0 || frame.overlaps >= frame.bodySize) return false;
+        if (frame.foodCell < -1 || frame.foodCell >= cellCount) return false;
+        if (frame.powerUpCell < -1 || frame.powerUpCell >= cellCount) return false;
+        if (frame.powerUpType < 0 || frame.powerUpType >= POWERUP_TYPE_COUNT) return false;
+        if (frame.powerUpSpawnTimer < 0 || frame.direction > RIGHT || frame.alive > 1) return false;
+        for (int i = 0; i < POWERUP_TYPE_COUNT; i++) {
+            if (frame.activeTicks[i] < 0) return false;
+        }
+        if (frame.headCell != cells[0]) return false;
+
+        // Wrap() is the plain neighbour inside the board, and covers the
+        // invincible and wrap-rule moves across an edge
+        BoardT seen = board;
+        seen.Reset();
+        int duplicates = 0;
+        for (int i = 0; i < frame.bodySize; i++) {
+            int cell = cells[i];
+            if (cell < 0 || cell >= cellCount) return false;
+            if (i > 0) {
+                int previous = cells[i - 1];
+                bool adjacent = false;
+                for (int d = 0; d < 4; d++) {
+                    adjacent |= board.Wrap(previous, static_cast<Direction>(d)) == cell;
+                }
+                if (!adjacent || cell == previous) return false;
+            }
+            duplicates += seen.Test(cell);
+            seen.Set(cell);
+        }
+        return duplicates == frame.overlaps;
+    }
+
+    // Inverse of SaveKeyframe; the board must have the same dimensions.
+    // False (and nothing loaded) if the keyframe does not fit the board.
+    bool LoadKeyframe(const SimulationKeyframe& frame, const int* cells) {
+        if (!IsValidKeyframe(frame, cells)) return false;
+
+        board.Reset();
+        headIndex = 0;
+        length = frame.bodySize;
+        for (int i = 0; i < length; i++) {
+            body[i] = cells[i];
+            board.Set(cells[i]);
+        }
+        pendingGrowth = frame.pendingGrowth;
+        overlaps = frame.overlaps;
+        tailShared = false;
+        for (int i = 0; i < length - 1; i++) {
+            tailShared |= cells[i] == cells[length - 1];
+        }
+        lastRemovedTail = -1;
+        currentDirection = static_cast<Direction>(frame.direction);
+        nextDirection = currentDirection;
+        foodCell = frame.foodCell;
+        powerUpCell = frame.powerUpCell;
+        powerUpType = static_cast<PowerUpType>(frame.powerUpType);
+        powerUpSpawnTimer = frame.powerUpSpawnTimer;
+        for (int i = 0; i < POWERUP_TYPE_COUNT; i++) activeTicks[i] = frame.activeTicks[i];
+        score = frame.score;
+        alive = frame.alive != 0;
+        tick = frame.tick;
+        for (int i = 0; i < 4; i++) rng.s[i] = frame.rng[i];
+        return true;
+    }
+
+    const BoardT& GetBoard() const { return board; }
+    int GetHeadCell() const { return body[headIndex]; }
+    int GetTailCell() const { return body[BodyCell(length - 1)]; }
+    int GetBodyCell(int i) const { return body[BodyCell(i)]; }
+    int GetLength() const { return length + pendingGrowth; }
+    int GetBodySize() const { return length; }  // cells currently in the ring
+    // Cell the tail left on the last Step(), -1 if the snake grew instead.
+    // It may still be occupied if an invincible snake overlapped itself.
+    int GetLastRemovedTail() const { return lastRemovedTail; }
+    Direction GetDirection() const { return currentDirection; }
+    int GetFoodCell() const { return foodCell; }
+    int GetPowerUpCell() const { return powerUpCell; }
+    PowerUpType GetPowerUpType() const { return powerUpType; }
+    int GetPowerUpTicksRemaining(PowerUpType type) const { return activeTicks[type]; }
+    bool HasActivePowerUp(PowerUpType type) const { return activeTicks[type] > 0; }
+    int GetScore() const { return score; }
+    bool IsAlive() const { return alive; }
+    uint64_t GetTick() const { return tick; }
+};
+
+// Fixed-size configs get fully specialised step functions; anything else
+// goes through the runtime-dimension fallback
+using ClassicSimulation = Simulation<Board<40, 30>, ClassicRules>;     // 800x600 at cellSize 20
+using TournamentSimulation = Simulation<Board<64, 64>, ClassicRules>;
+using RuntimeSimulation = Simulation<DynamicBoard, ClassicRules>;
+
+#endif
@@ -2,32 +2,40 @@
 #define SNAKE_H
 
 #include "raylib.h"
+#include "GameTypes.h"
 #include <deque>
+#include <memory_resource>
 
-enum Direction {
-    UP,
-    DOWN,
-    LEFT,
-    RIGHT
-};
+using SnakeBody = std::pmr::deque<Vector2>;
 
 class Snake {
 private:
-    std::deque<Vector2> body;
+    SnakeBody body;
     Direction currentDirection;
     Direction nextDirection;
     int cellSize;
     Color snakeColor;
     
 public:
-    Snake(Vector2 startPosition, int size);
+    Snake(Vector2 startPosition, int size,
+          std::pmr::memory_resource* memory = std::pmr::get_default_resource());
     void SetDirection(Direction dir);
     void Move();
     void Grow();
     bool CheckSelfCollision() const;
     Vector2 GetHeadPosition() const;
+    Direction GetDirection() const { return currentDirection; }
+    Direction GetNextDirection() const { return nextDirection; }
+    
+    // Inverses of Move() and Grow(), for rewinding
+    void Unmove(Vector2 removedTail, Direction current, Direction next);
+    void Shrink();
+    
+    // Puts the head where the tick simulation moved it, which wraps an
+    // invincible snake around the board instead of leaving the screen
+    void SetHeadPosition(Vector2 position) { body.front() = position; }
     void Draw() const;
-    const std::deque<Vector2>& GetBody() const { return body; }
+    const SnakeBody& GetBody() const { return body; }
 };
 
 #endif
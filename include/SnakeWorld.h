@@ -0,0 +1,114 @@
+#ifndef SNAKEWORLD_H
+#define SNAKEWORLD_H
+
+#include "Board.h"
+#include "GameTypes.h"
+#include "Random.h"
+#include "RulePolicies.h"
+#include <cstdint>
+#include <vector>
+
+const int WORLD_MAX_LENGTH = 1024;  // longer snakes stop growing
+const int WORLD_SPAWN_LENGTH = 3;
+
+// Headless shared board for the multiplayer tick server: many snakes, one
+// pool of food and one power-up, stepped together with the ClassicRules
+// used by Game and Simulation. A dead snake leaves the board at once and
+// respawns after RESPAWN_TICKS with a fresh score.
+//
+// Moves are simultaneous: every tail leaves before any head arrives, two
+// heads entering the same cell both die, and a head entering any body
+// (its own or another snake's) dies unless INVINCIBILITY is active.
+//
+// DATA STRUCTURE: One preallocated ring of WORLD_MAX_LENGTH cells per snake slot
+// WHY: Slots are reused as players come and go, and no tick ever allocates;
+// 1024 cells of 4 bytes keep hundreds of snakes within a few MB.
+//
+// DATA STRUCTURE: Occupancy count per cell (not a bitboard)
+// WHY: Invincible snakes may pass through bodies, so a cell can hold several
+// segments; it only becomes free when the last one leaves.
+class SnakeWorld {
+public:
+    static const int RESPAWN_TICKS = 20;
+    static const int POWERUP_SPAWN_TICKS = 67;     // 10s at the base move interval
+    static const int POWERUP_DURATION_TICKS = 33;  // 5s
+
+private:
+    using Walls = ClassicRules::Walls;
+    using PowerUps = ClassicRules::PowerUps;
+
+    struct SnakeState {
+        int headIndex;
+        int length;
+        int pendingGrowth;
+        int score;
+        Direction direction;
+        Direction nextDirection;
+        bool active;         // slot belongs to a player
+        bool alive;
+        bool spawned;        // (re)entered the board on the last Step()
+        int respawnTimer;
+        int target;          // next head cell during Step(), -1 for death
+        int activeTicks[POWERUP_TYPE_COUNT];
+    };
+
+    DynamicBoard board;
+    std::vector<SnakeState> snakes;
+    std::vector<int> bodies;            // WORLD_MAX_LENGTH cells per slot
+    std::vector<uint8_t> occupancy;
+    std::vector<int16_t> foodAt;        // food slot on each cell, or -1
+    std::vector<uint32_t> claimTick;    // head conflicts within one Step()
+    std::vector<int> claimOwner;
+    std::vector<int> foodCells;
+    int powerUpCell;
+    PowerUpType powerUpType;
+    int powerUpSpawnTimer;
+    uint64_t tick;
+    int activeCount;
+    Xoshiro128Plus rng;
+
+    int& BodyAt(int id, int i);
+    bool IsFree(int cell) const;
+    int RandomFreeCell();
+    bool TrySpawn(int id);
+    void PushHead(int id, int cell);
+    void PopTail(int id);
+    void Kill(int id);
+
+public:
+    SnakeWorld(int width, int height, int maxSnakes, int foodCount, uint64_t seed = 1);
+
+    // Slot of the new snake, or -1 if every slot is taken
+    int AddSnake();
+    void RemoveSnake(int id);
+    // Reversals are ignored, as in Snake::SetDirection
+    void SetDirection(int id, Direction dir);
+
+    void Step();
+
+    const DynamicBoard& GetBoard() const { return board; }
+    int GetMaxSnakes() const { return (int)snakes.size(); }
+    int GetActiveCount() const { return activeCount; }
+    uint64_t GetTick() const { return tick; }
+
+    bool IsActive(int id) const { return snakes[id].active; }
+    bool IsAlive(int id) const { return snakes[id].alive; }
+    bool WasSpawned(int id) const { return snakes[id].spawned; }
+    int GetBodySize(int id) const { return snakes[id].length; }
+    // Head first
+    int GetBodyCell(int id, int i) const;
+    int GetHeadCell(int id) const { return GetBodyCell(id, 0); }
+    int GetScore(int id) const { return snakes[id].score; }
+    Direction GetDirection(int id) const { return snakes[id].direction; }
+    int GetPowerUpTicksRemaining(int id, PowerUpType type) const { return snakes[id].activeTicks[type]; }
+
+    // Some body segment is on the cell (bots use this to steer)
+    bool IsOccupied(int cell) const { return occupancy[cell] > 0; }
+
+    int GetFoodCount() const { return (int)foodCells.size(); }
+    int GetFoodCell(int i) const { return foodCells[i]; }  // -1 while the board is too full to place it
+    int GetPowerUpCell() const { return powerUpCell; }
+    PowerUpType GetPowerUpType() const { return powerUpType; }
+};
+
+#endif
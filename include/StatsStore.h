@@ -0,0 +1,100 @@
+#ifndef STATSSTORE_H
+#define STATSSTORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+const int STATS_MAX_VARIANTS = 8;
+const int STATS_NAME_LENGTH = 24;
+const int STATS_HISTOGRAM_BUCKETS = 32;
+const int STATS_HISTOGRAM_WIDTH = 50;  // points per bucket; the last one is open-ended
+
+struct StatsVariant {
+    char name[STATS_NAME_LENGTH];
+    int32_t highScore;
+    uint32_t reserved;
+    uint64_t gamesPlayed;
+    uint64_t totalScore;
+    uint32_t scoreHistogram[STATS_HISTOGRAM_BUCKETS];
+};
+
+struct StatsSlot {
+    uint64_t sequence;
+    uint32_t checksum;
+    uint32_t variantCount;
+    StatsVariant variants[STATS_MAX_VARIANTS];
+};
+
+struct StatsFile {
+    uint32_t magic;
+    uint32_t version;
+    StatsSlot slots[2];
+};
+
+static_assert(std::is_trivially_copyable<StatsFile>::value, "StatsFile is mapped straight from disk");
+
+// High scores, games played and score histograms per rule variant, kept in
+// a memory-mapped file. Opening maps the file instead of parsing it, and
+// recording a game is a few stores into the mapping, never a blocking write.
+//
+// DATA STRUCTURE: Two checksummed slots, written alternately
+// WHY: An update copies the live slot into the spare one, changes it and
+// stamps a higher sequence and checksum last. A crash or power cut in the
+// middle leaves a slot whose checksum fails, and Open() falls back to the
+// other - the previous complete state.
+//
+// Several games may map the same file. Each update takes an exclusive lock
+// on it (flock / LockFileEx) and picks the newest valid slot again before
+// copying it, so a writer never builds on a stale slot or overwrites the
+// one another process just made live. The lock is held for a copy of one
+// slot, so a game over still never waits on disk.
+//
+// Without a usable file (read-only directory, mapping refused) the store
+// keeps working in memory and IsPersistent() reports false.
+class StatsStore {
+private:
+    StatsFile* file;
+    StatsFile fallback;
+    int active;
+    bool persistent;
+
+#if defined(_WIN32)
+    void* fileHandle;
+    void* mappingHandle;
+#else
+    int fd;
+#endif
+
+    bool Map(const char* path);
+    void Unmap();
+    void Lock();
+    void Unlock();
+    void Initialize();
+    // Index of the valid slot with the highest sequence, or -1
+    int FindNewestSlot() const;
+    int FindVariant(const char* name) const;
+
+public:
+    StatsStore();
+    ~StatsStore();
+
+    StatsStore(const StatsStore&) = delete;
+    StatsStore& operator=(const StatsStore&) = delete;
+
+    // Maps 'path', creating or resetting it if missing or unreadable
+    bool Open(const char* path);
+    void Close();
+    bool IsPersistent() const { return persistent; }
+
+    void RecordGame(const char* variant, int score);
+
+    int GetHighScore(const char* variant) const;
+    // Null if the variant has never been recorded
+    const StatsVariant* GetVariant(const char* variant) const;
+    const StatsSlot& GetSnapshot() const { return file->slots[active]; }
+
+    static uint32_t Checksum(const StatsSlot& slot);
+};
+
+#endif
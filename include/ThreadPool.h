@@ -0,0 +1,106 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Completion counter for a batch of tasks. Wait() parks the caller on a
+// condition variable instead of spinning, and returns only after the last
+// Finish() has let go of the group, so the caller may destroy it then.
+class TaskGroup {
+private:
+    std::atomic<int> pending;
+    std::mutex mutex;
+    std::condition_variable done;
+
+public:
+    TaskGroup() : pending(0) {}
+
+    void Add(int count) { pending.fetch_add(count, std::memory_order_relaxed); }
+    void Finish();
+    void Wait();
+    bool IsDone() const { return pending.load(std::memory_order_acquire) == 0; }
+};
+
+// Plain function pointer + context: a task is a small trivially copyable
+// record with no captured state to allocate (the worker deques still grow
+// in blocks on the heap as they fill)
+struct Task {
+    void (*run)(void* context, int begin, int end);
+    void* context;
+    int begin;
+    int end;
+    TaskGroup* group;
+    int node;  // pool node index the task must run on, -1 for any worker
+};
+
+// Work-stealing pool: every worker owns a deque, pops its own work from the
+// back and steals from the front of the others' when it runs dry. Small
+// chunks of uneven cost (games that die at tick 20 next to games that run
+// for a million ticks) then balance themselves across cores. Idle workers
+// park on a condition variable.
+class ThreadPool {
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> workers;
+    std::vector<int> workerNodes;
+    std::vector<int> workerNodeIndex;          // dense 0..NodeCount()-1
+    std::vector<std::vector<int>> nodeWorkers;  // workers per node index
+    bool pinThreads;
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<int> queued;                        // tasks any worker may run
+    std::unique_ptr<std::atomic<int>[]> nodeQueued;  // node-bound tasks per node index
+    std::atomic<bool> stopping;
+    std::atomic<unsigned> nextQueue;
+    std::atomic<unsigned long long> steals;
+
+    bool PopLocal(int index, Task& task);
+    bool StealFrom(int victim, int thief, Task& task);
+    bool Steal(int thief, Task& task);
+    void Push(int worker, const Task& task);
+    std::atomic<int>& Counter(int node) { return node < 0 ? queued : nodeQueued[node]; }
+    void WorkerLoop(int index, int cpu);
+
+public:
+    // With pinThreads, worker i is bound to a core on NUMA node i % nodes
+    // (see CpuTopology), so memory it first touches stays node-local
+    explicit ThreadPool(int threadCount, bool pinThreads = false);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Splits [0, count) into chunks of 'chunk' items, dealt round-robin
+    // onto the worker deques, and tracks them on 'group'
+    void ParallelFor(TaskGroup& group, int count, int chunk,
+                     void (*run)(void* context, int begin, int end), void* context);
+
+    // Same, but only workers on node index 'node' run the chunks: chunk k
+    // always goes to the same worker's deque, and workers on other nodes
+    // never steal it, so data a node first touched stays on that node
+    void ParallelForNode(TaskGroup& group, int node, int count, int chunk,
+                         void (*run)(void* context, int begin, int end), void* context);
+
+    int Size() const { return (int)workers.size(); }
+    int GetWorkerNode(int worker) const { return workerNodes[worker]; }
+    // Nodes with at least one worker; an unpinned pool is a single node
+    int NodeCount() const { return (int)nodeWorkers.size(); }
+    bool IsPinned() const { return pinThreads; }
+
+    // Index of the pool worker running the caller, -1 outside any pool
+    static int CurrentWorker();
+    unsigned long long GetStealCount() const { return steals.load(std::memory_order_relaxed); }
+};
+
+#endif
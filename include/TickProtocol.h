@@ -0,0 +1,68 @@
+#ifndef TICKPROTOCOL_H
+#define TICKPROTOCOL_H
+
+#include <cstdint>
+
+// Wire format of the multiplayer tick server: one message per UDP
+// datagram, native byte order (loopback and LAN test rigs only).
+//
+// Client -> server: TickClientMessage (JOIN, INPUT, LEAVE). INPUT doubles
+// as the keepalive and repeats the last TICK_INPUT_BATCH directions, so a
+// lost datagram costs nothing as long as the next one arrives.
+//
+// Joining is a two-step handshake so a spoofed source address never gets
+// a slot or a state stream: the first JOIN is answered with a CHALLENGE
+// whose token is derived from the sender's address, and only a JOIN that
+// echoes that token gets a snake. Neither reply is larger than the JOIN.
+//
+// Server -> client: WELCOME with the client's snake id, then one state
+// message per tick. State messages are identical for every client, so the
+// server encodes each tick once and sends the same bytes to every session.
+
+const uint16_t TICK_SERVER_PORT = 7777;
+const uint32_t TICK_MAGIC = 0x534E4B4D;  // "SNKM"
+const int TICK_MAX_DATAGRAM = 32768;
+const int TICK_INPUT_BATCH = 8;
+const uint16_t TICK_NO_CELL = 0xFFFF;    // cells are 16-bit: boards up to 65535 cells
+
+enum TickMessageType {
+    TICK_JOIN = 1,
+    TICK_INPUT = 2,
+    TICK_LEAVE = 3,
+    TICK_WELCOME = 4,
+    TICK_FULL = 5,       // join refused: every slot is taken
+    TICK_DELTA = 6,
+    TICK_KEYFRAME = 7,
+    TICK_CHALLENGE = 8   // JOIN again with this token to prove the address
+};
+
+enum TickClientFlags {
+    TICK_NEED_KEYFRAME = 1   // the client's view is out of sync
+};
+
+struct TickClientMessage {
+    uint32_t magic;
+    uint8_t type;
+    uint8_t flags;
+    uint8_t count;           // INPUT: directions in use, newest last
+    uint8_t reserved;
+    uint16_t snakeId;        // from WELCOME
+    uint16_t reserved2;
+    uint32_t token;          // JOIN: from CHALLENGE; otherwise from WELCOME
+    uint32_t lastSequence;   // INPUT: sequence number of directions[count - 1]
+    uint8_t directions[TICK_INPUT_BATCH];
+};
+
+// WELCOME, FULL and CHALLENGE
+struct TickWelcome {
+    uint32_t magic;
+    uint8_t type;
+    uint8_t reserved[3];
+    uint16_t snakeId;
+    uint16_t tickRate;
+    uint16_t width;
+    uint16_t height;
+    uint32_t token;
+};
+
+#endif
@@ -0,0 +1,115 @@
+#ifndef TICKSERVER_H
+#define TICKSERVER_H
+
+#include "SnakeWorld.h"
+#include "TickProtocol.h"
+#include "WorldView.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct TickServerConfig {
+    uint16_t port = TICK_SERVER_PORT;  // 0 picks a free one (see GetPort)
+    int width = 128;
+    int height = 128;
+    int maxSessions = 512;
+    int foodCount = 64;
+    int tickRate = 20;                 // ticks per second
+    int timeoutTicks = 100;            // silence that ends a session
+};
+
+struct TickServerStats {
+    uint64_t ticks = 0;
+    uint64_t tickNanos = 0;            // step + encode + send, summed
+    uint64_t maxTickNanos = 0;
+    uint64_t datagramsIn = 0;
+    uint64_t datagramsOut = 0;
+    uint64_t bytesOut = 0;
+    uint64_t sendDrops = 0;            // socket buffer full
+    uint64_t joins = 0;
+    uint64_t challenges = 0;
+    uint64_t timeouts = 0;
+    uint64_t keyframeSends = 0;
+};
+
+// Authoritative server for a shared SnakeWorld: one UDP socket and one
+// timerfd on an epoll set, fixed-rate ticks, one snake per session.
+// Linux only - elsewhere Open() fails.
+//
+// Each tick it applies at most one queued direction per session, steps
+// the world, encodes the delta once and hands the same buffer to every
+// session in a single sendmmsg() batch. Keyframes are encoded at most once
+// per tick, only when some session joined or reported a gap.
+//
+// A JOIN only takes a slot once it echoes the address cookie from a
+// CHALLENGE (see TickProtocol.h); the cookie is a keyed hash of the
+// sender's address, so unconfirmed joins cost the server no state.
+//
+// DATA STRUCTURE: Preallocated message pool plus mmsghdr/iovec arrays sized for maxSessions
+// WHY: A tick never allocates: state messages are encoded into fixed
+// buffers, and the send batch only points at them, so sending to hundreds
+// of sessions is one syscall per 1024 datagrams and no copies in user space.
+class TickServer {
+private:
+    struct Session {
+        bool active;
+        uint32_t address;     // IPv4, network order
+        uint16_t port;        // network order
+        uint32_t token;
+        uint32_t lastSequence;
+        uint64_t lastHeard;   // tick
+        bool needsKeyframe;
+        uint8_t queue[TICK_INPUT_BATCH];
+        int queueHead;
+        int queueCount;
+    };
+
+    struct IoState;  // socket-level arrays, defined with the platform code
+
+    TickServerConfig config;
+    SnakeWorld world;
+    WorldDeltaEncoder encoder;
+    std::vector<Session> sessions;     // index is the snake id
+    std::vector<uint8_t> pool;         // message buffers of TICK_MAX_DATAGRAM bytes
+    int poolMessages;
+    std::unique_ptr<IoState> io;
+    int socketFd;
+    int epollFd;
+    int timerFd;
+    uint16_t boundPort;
+    uint32_t tokenState;
+    uint64_t cookieKey;
+    TickServerStats stats;
+
+    uint8_t* PoolMessage(int index) { return pool.data() + (size_t)index * TICK_MAX_DATAGRAM; }
+    void Receive();
+    void Handle(const TickClientMessage& message, uint32_t address, uint16_t port);
+    uint32_t Cookie(uint32_t address, uint16_t port) const;
+    void Join(uint32_t address, uint16_t port, uint32_t token);
+    void SendWelcome(uint8_t type, int id, uint32_t token, uint32_t address, uint16_t port);
+    void EndSession(int id);
+    void Tick();
+    void QueueSend(int session, const uint8_t* data, size_t size);
+    void FlushSends();
+
+public:
+    explicit TickServer(const TickServerConfig& config);
+    ~TickServer();
+
+    TickServer(const TickServer&) = delete;
+    TickServer& operator=(const TickServer&) = delete;
+
+    bool Open();
+    void Close();
+
+    // Handles whatever is ready (datagrams, due ticks), waiting up to
+    // 'timeoutMs' for something to happen
+    void Poll(int timeoutMs);
+
+    uint16_t GetPort() const { return boundPort; }
+    int GetSessionCount() const { return world.GetActiveCount(); }
+    const TickServerStats& GetStats() const { return stats; }
+    const SnakeWorld& GetWorld() const { return world; }
+};
+
+#endif
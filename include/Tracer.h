@@ -0,0 +1,155 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Chrome trace event recorder (load the file in chrome://tracing or
+// ui.perfetto.dev). Start() opens the file and a background flush thread;
+// until then TRACE_SCOPE / TRACE_INSTANT cost one relaxed atomic load.
+//
+//     TRACE_SCOPE("Update");          // complete event for this scope
+//     TRACE_INSTANT("PlayEatSound");  // zero-length marker
+//
+// Names must be string literals (or otherwise outlive the tracer).
+
+struct TraceEvent {
+    const char* name;
+    uint64_t start;     // nanoseconds on the steady clock
+    uint64_t duration;  // INSTANT for a marker
+};
+
+// DATA STRUCTURE: One single-producer ring of events per thread
+// WHY: The owning thread appends with a plain store and a release increment,
+// and only the flush thread reads, so recording never takes a lock or
+// contends with another thread. A full ring drops events rather than stall.
+class TraceBuffer {
+private:
+    static const uint32_t CAPACITY = 16384;
+    static const uint32_t MASK = CAPACITY - 1;
+
+    TraceEvent events[CAPACITY];
+    alignas(64) std::atomic<uint32_t> writeIndex;
+    alignas(64) std::atomic<uint32_t> readIndex;
+    std::atomic<uint32_t> dropped;
+    std::atomic<const char*> threadName;
+    const char* writtenName;  // flush thread only
+    int threadId;
+
+public:
+    explicit TraceBuffer(int threadId)
+        : writeIndex(0), readIndex(0), dropped(0), threadName(nullptr), writtenName(nullptr),
+          threadId(threadId) {}
+
+    void Push(const TraceEvent& event) {
+        uint32_t write = writeIndex.load(std::memory_order_relaxed);
+        if (write - readIndex.load(std::memory_order_acquire) == CAPACITY) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        events[write & MASK] = event;
+        writeIndex.store(write + 1, std::memory_order_release);
+    }
+
+    template <typename Fn>
+    void Drain(Fn fn) {
+        uint32_t read = readIndex.load(std::memory_order_relaxed);
+        uint32_t write = writeIndex.load(std::memory_order_acquire);
+        for (; read != write; read++) {
+            fn(events[read & MASK]);
+        }
+        readIndex.store(read, std::memory_order_release);
+    }
+
+    void SetName(const char* name) { threadName.store(name, std::memory_order_release); }
+
+    // The thread's name if it changed since the last call, else null
+    const char* TakeNewName() {
+        const char* name = threadName.load(std::memory_order_acquire);
+        if (name == writtenName) return nullptr;
+        writtenName = name;
+        return name;
+    }
+
+    int GetThreadId() const { return threadId; }
+    uint32_t GetDropped() const { return dropped.load(std::memory_order_relaxed); }
+};
+
+class Tracer {
+public:
+    static const uint64_t INSTANT = UINT64_MAX;
+
+private:
+    std::atomic<bool> active;
+    FILE* file;
+    bool firstEvent;
+    uint64_t startTime;
+
+    std::mutex buffersMutex;  // registration and flushing only
+    std::vector<std::unique_ptr<TraceBuffer>> buffers;
+
+    std::thread flusher;
+    std::mutex flushMutex;
+    std::condition_variable flushWake;
+    bool stopping;
+
+    Tracer();
+
+    TraceBuffer* RegisterThread();
+    void FlushLoop();
+    void Flush();
+
+public:
+    ~Tracer();
+
+    static Tracer& Get();
+    static uint64_t Now();
+
+    // Begins writing to 'path'; false if the file cannot be created or a
+    // trace is already running. Stop() drains every thread and closes it.
+    bool Start(const char* path);
+    void Stop();
+    bool IsActive() const { return active.load(std::memory_order_relaxed); }
+
+    void Record(const char* name, uint64_t start, uint64_t duration);
+
+    // Names the calling thread in the trace viewer
+    void SetThreadName(const char* name);
+};
+
+class TraceScope {
+private:
+    const char* name;
+    uint64_t start;
+
+public:
+    explicit TraceScope(const char* name)
+        : name(name), start(Tracer::Get().IsActive() ? Tracer::Now() : 0) {}
+
+    ~TraceScope() {
+        if (start != 0) {
+            Tracer::Get().Record(name, start, Tracer::Now() - start);
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+};
+
+#define TRACE_SCOPE_NAME_INNER(a, b) a##b
+#define TRACE_SCOPE_NAME(a, b) TRACE_SCOPE_NAME_INNER(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_SCOPE_NAME(traceScope, __LINE__)(name)
+#define TRACE_INSTANT(name)                                                      \
+    do {                                                                         \
+        if (Tracer::Get().IsActive()) {                                          \
+            Tracer::Get().Record(name, Tracer::Now(), Tracer::INSTANT);          \
+        }                                                                        \
+    } while (0)
+
+#endif
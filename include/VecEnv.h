@@ -0,0 +1,134 @@
+#ifndef VECENV_H
+#define VECENV_H
+
+#include "EgocentricObservation.h"
+#include "Observation.h"
+#include "Simulation.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// A batch of N headless games stepped together for RL training. The caller
+// owns the observation buffer (N x OBS_CHANNEL_COUNT x H x W, uint8 or
+// float); finished games reset themselves and get a fresh full write.
+// Pass a null buffer to skip full-board planes (e.g. egocentric-only agents
+// on boards too large for them). The games are allocated and first touched
+// by the constructing thread; AsyncVecEnv builds one VecEnv per NUMA node
+// on a worker of that node.
+template <typename SimT, typename T>
+class VecEnv {
+private:
+    std::vector<SimT> games;
+    std::vector<uint64_t> episodes;
+    ObservationWriter<SimT, T> writer;
+    bool writePlanes;
+    uint64_t baseSeed;
+
+    uint64_t EpisodeSeed(int game) const {
+        return baseSeed + (uint64_t)game + episodes[game] * games.size();
+    }
+
+public:
+    VecEnv(int count, uint64_t seed, T* observations, const SimT& prototype = SimT())
+        : games(count, prototype), episodes(count, 0),
+          writer(observations, count,
+                 prototype.GetBoard().Width(), prototype.GetBoard().Height()),
+          writePlanes(observations != nullptr), baseSeed(seed) {
+        for (int i = 0; i < count; i++) {
+            games[i].Reset(EpisodeSeed(i));
+            if (writePlanes) writer.Write(i, games[i]);
+        }
+    }
+
+    // rewards[i] is the score gained this step; dones[i] is 1 when game i
+    // died (its observation already shows the next episode's first state)
+    void Step(const Direction* actions, float* rewards, uint8_t* dones) {
+        StepRange(0, (int)games.size(), actions, rewards, dones);
+    }
+
+    // Steps games [begin, end) only, so workers can split the batch
+    void StepRange(int begin, int end, const Direction* actions, float* rewards, uint8_t* dones) {
+        ASSERT_NO_ALLOCS();
+        PERF_SCOPE(PERF_REGION_VECENV_STEP);
+        for (int i = begin; i < end; i++) {
+            SimT& sim = games[i];
+            int before = sim.GetScore();
+
+            if (sim.Step(actions[i])) {
+                rewards[i] = (float)(sim.GetScore() - before);
+                dones[i] = 0;
+                if (writePlanes) writer.Update(i, sim);
+            } else {
+                rewards[i] = 0.0f;
+                dones[i] = 1;
+                episodes[i]++;
+                sim.Reset(EpisodeSeed(i));
+                if (writePlanes) writer.Write(i, sim);
+            }
+        }
+    }
+
+    // Egocentric windows for the whole batch: planes is N x ego.PlaneStride(),
+    // features is N x EGO_FEATURE_COUNT. Games are stored one after another,
+    // not as lanes, so this is one window per game; the vectorisable part is
+    // the row loop inside EgocentricWriter::Write
+    void WriteEgocentric(const EgocentricWriter<SimT, T>& ego, T* planes, float* features) const {
+        for (size_t i = 0; i < games.size(); i++) {
+            ego.Write(games[i], planes + i * ego.PlaneStride(), features + i * EGO_FEATURE_COUNT);
+        }
+    }
+
+    // N x 4 legal and N x 4 survivable action masks (0/1, indexed by Direction),
+    // by the rule in Simulation::GetActionMask(). Each block of games has its
+    // head, tail and flags gathered into lane arrays first, so the loops per
+    // direction are straight-line code across lanes instead of per game.
+    void WriteActionMasks(uint8_t* legal, uint8_t* safe) const {
+        const int BLOCK = 64;
+        alignas(64) int32_t head[BLOCK];
+        alignas(64) int32_t tail[BLOCK];
+        alignas(64) int32_t next[BLOCK];
+        alignas(64) uint8_t direction[BLOCK];
+        alignas(64) uint8_t tailMoves[BLOCK];
+        alignas(64) uint8_t invincible[BLOCK];
+        alignas(64) uint8_t occupied[BLOCK];
+
+        int count = (int)games.size();
+        for (int begin = 0; begin < count; begin += BLOCK) {
+            int lanes = std::min(BLOCK, count - begin);
+            const SimT* block = games.data() + begin;
+            for (int k = 0; k < lanes; k++) {
+                head[k] = block[k].GetHeadCell();
+                tail[k] = block[k].GetTailCell();
+                direction[k] = (uint8_t)block[k].GetDirection();
+                tailMoves[k] = block[k].IsTailMoving();
+                invincible[k] = block[k].HasActivePowerUp(INVINCIBILITY);
+            }
+
+            for (int d = 0; d < 4; d++) {
+                Direction dir = static_cast<Direction>(d);
+                for (int k = 0; k < lanes; k++) {
+                    next[k] = SimT::NextCell(block[k].GetBoard(), head[k], dir, invincible[k] != 0);
+                }
+                // Lanes that hit a wall test their own head and ignore the answer
+                for (int k = 0; k < lanes; k++) {
+                    int cell = next[k] >= 0 ? next[k] : head[k];
+                    occupied[k] = block[k].GetBoard().Test(cell) & ((tailMoves[k] & (cell == tail[k])) ^ 1);
+                }
+                uint8_t* legalOut = legal + (size_t)begin * 4 + d;
+                uint8_t* safeOut = safe + (size_t)begin * 4 + d;
+                for (int k = 0; k < lanes; k++) {
+                    uint8_t isLegal = (direction[k] ^ d) != 1;
+                    uint8_t inside = next[k] >= 0;
+                    legalOut[k * 4] = isLegal;
+                    safeOut[k * 4] = isLegal & inside & (invincible[k] | (occupied[k] ^ 1));
+                }
+            }
+        }
+    }
+
+    int Size() const { return (int)games.size(); }
+    const SimT& GetGame(int i) const { return games[i]; }
+    size_t ObservationStride() const { return writer.GameStride(); }
+};
+
+#endif
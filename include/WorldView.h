@@ -0,0 +1,184 @@
+#ifndef WORLDVIEW_H
+#define WORLDVIEW_H
+
+#include "Board.h"
+#include "SnakeWorld.h"
+#include "TickProtocol.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// State messages of the tick server (see TickProtocol.h). Both start with
+// TICK_MAGIC and the type byte; the rest is varints and single bytes.
+//
+// DELTA, one per tick, against the previous tick:
+//     tick, flags (TICK_DIFF_*)
+//     [food]      changed slot count, then (slot gap, cell + 1) per slot
+//     [power-up]  cell + 1, type
+//     snake records up to the end: id gap, op byte, payload
+//
+// KEYFRAME, the full state, split into parts that each fit a datagram:
+//     tick, part, flags (TICK_LAST_PART), width, height,
+//     food count, cell + 1 per slot, power-up cell + 1, type
+//     snake records up to the end, SPAWN or OFF only
+//
+// A body is its head cell followed by one 2-bit direction per segment,
+// packed four to a byte, as in replay keyframes.
+//
+// DATA STRUCTURE: One op byte per changed snake (kind, direction, tail and score bits)
+// WHY: Almost every record is a plain move, which costs the id gap and the
+// op byte: the new head is the old one stepped in that direction, and the
+// tail bit says whether the old tail cell left. Scores travel as zigzag
+// deltas only when they change, and snakes waiting to respawn cost nothing.
+
+enum TickDiffFlags {
+    TICK_DIFF_FOOD = 1,
+    TICK_DIFF_POWERUP = 2
+};
+
+enum TickStateFlags {
+    TICK_LAST_PART = 1
+};
+
+enum TickSnakeOp {
+    TICK_OP_MOVE = 0,    // head stepped one cell in the op's direction
+    TICK_OP_SPAWN = 1,   // on the board with a new body: score, length, body follow
+    TICK_OP_OFF = 2,     // off the board: dead or waiting to respawn
+    TICK_OP_SLOT = 3     // a player took (TICK_OP_ACTIVE) or left the slot
+};
+
+const uint8_t TICK_OP_KIND = 0x03;
+const int TICK_OP_DIRECTION_SHIFT = 2;
+const uint8_t TICK_OP_TAIL = 0x10;     // MOVE: the old tail cell left
+const uint8_t TICK_OP_SCORE = 0x20;    // zigzag score delta follows
+const uint8_t TICK_OP_ACTIVE = 0x40;
+
+// Tick of a DELTA or KEYFRAME message without applying it
+bool ReadStateTick(const uint8_t* data, size_t size, uint32_t& tick);
+
+// Keeps what the last delta described (one small baseline per slot, not
+// the bodies: a move only needs the old head and length) and encodes each
+// new tick against it.
+class WorldDeltaEncoder {
+private:
+    struct SnakeBaseline {
+        bool active;
+        bool alive;
+        int head;
+        int length;
+        int score;
+    };
+
+    std::vector<SnakeBaseline> snakes;
+    std::vector<int> foodCells;
+    int powerUpCell;
+    int powerUpType;
+
+public:
+    explicit WorldDeltaEncoder(int maxSnakes);
+
+    // Delta from the previously encoded tick (from an empty world on the
+    // first call) to the world's current tick. Returns the bytes written,
+    // or 0 if they did not fit; the baseline moves on either way, so after
+    // a 0 receivers need a keyframe.
+    size_t EncodeDelta(const SnakeWorld& world, uint8_t* out, size_t capacity);
+};
+
+// Encodes the next keyframe part, starting at snake slot 'nextSnake' and
+// advancing it; the part holding the last snake is flagged TICK_LAST_PART.
+// Returns 0 if not even one snake fits.
+size_t EncodeWorldKeyframe(const SnakeWorld& world, int& nextSnake, uint8_t part,
+                           uint8_t* out, size_t capacity);
+
+// Recording and spectator stream: each tick's delta as one frame (varint
+// length + message), plus a whole keyframe frame every keyframeInterval
+// ticks where a reader can join or seek to
+class WorldStreamWriter {
+private:
+    WorldDeltaEncoder encoder;
+    uint32_t keyframeInterval;
+    std::vector<uint8_t> scratch;
+
+    void AppendFrame(std::vector<uint8_t>& out, size_t size);
+
+public:
+    WorldStreamWriter(int maxSnakes, uint32_t keyframeInterval);
+
+    // Call once per world tick
+    void Append(const SnakeWorld& world, std::vector<uint8_t>& out);
+};
+
+// Client-side copy of the world, rebuilt from keyframes and kept current by
+// deltas applied in place. Bodies are rings in one preallocated array, as
+// in SnakeWorld, so applying a tick never allocates.
+class WorldView {
+private:
+    struct SnakeView {
+        int headIndex;
+        int length;
+        int score;
+        Direction direction;
+        bool active;
+        bool alive;
+    };
+
+    DynamicBoard board;
+    int maxSnakes;
+    std::vector<SnakeView> snakes;    // plus one scratch slot for keyframe records
+    std::vector<uint16_t> bodies;
+    std::vector<uint16_t> foodCells;
+    uint16_t powerUpCell;
+    PowerUpType powerUpType;
+    uint32_t tick;
+    bool synced;
+
+    // Keyframe being assembled
+    uint32_t keyframeTick;
+    int expectedPart;      // -1 when no keyframe is in progress
+    int keyframeNextId;    // slots below this are done
+    bool keyframeCompare;  // view already had keyframeTick: check it
+    bool keyframeDiffers;
+    uint64_t keyframeMismatches;
+
+    uint16_t& BodyAt(int id, int i);
+    void PushHead(int id, uint16_t cell);
+    void ClearSnake(int id);
+    bool ApplyRecord(int id, uint8_t op, const uint8_t*& cursor, const uint8_t* end);
+    bool SnakesMatch(int a, int b) const;
+    void CopySnake(int from, int to);
+    void EndKeyframe();
+
+public:
+    explicit WorldView(int maxSnakes);
+
+    // False if the message is malformed or does not follow the current
+    // tick; the view is then out of sync until the next full keyframe
+    bool ApplyDelta(const uint8_t* data, size_t size);
+    bool ApplyKeyframe(const uint8_t* data, size_t size);
+
+    // Next WorldStreamWriter frame; deltas before the first keyframe are
+    // skipped. False at the end of the stream or on a truncated frame.
+    bool ApplyFrame(const uint8_t*& cursor, const uint8_t* end);
+
+    bool IsSynced() const { return synced; }
+    uint32_t GetTick() const { return tick; }
+    int GetWidth() const { return board.Width(); }
+    int GetHeight() const { return board.Height(); }
+    int GetMaxSnakes() const { return maxSnakes; }
+    bool IsActive(int id) const { return snakes[id].active; }
+    bool IsAlive(int id) const { return snakes[id].alive; }
+    int GetBodySize(int id) const { return snakes[id].length; }
+    int GetBodyCell(int id, int i) const;
+    int GetScore(int id) const { return snakes[id].score; }
+    Direction GetDirection(int id) const { return snakes[id].direction; }
+    int GetFoodCount() const { return (int)foodCells.size(); }
+    int GetFoodCell(int i) const { return foodCells[i] == TICK_NO_CELL ? -1 : foodCells[i]; }
+    int GetPowerUpCell() const { return powerUpCell == TICK_NO_CELL ? -1 : powerUpCell; }
+    PowerUpType GetPowerUpType() const { return powerUpType; }
+
+    // Keyframes that arrived for a tick the view already had, and disagreed
+    // with it: should stay 0, or deltas are losing information
+    uint64_t GetKeyframeMismatches() const { return keyframeMismatches; }
+};
+
+#endif
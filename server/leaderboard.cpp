@@ -0,0 +1,333 @@
+// Local leaderboard service: every game instance on the host submits its
+// final replays here, and any of them can ask for the top K or a rank.
+// Listens on a UNIX datagram socket (POSIX) and on UDP 127.0.0.1:[port],
+// the transport Windows games use. Both feed the same receiver pool.
+// A score is only ranked once its replay re-runs to it (ReplayVerifier).
+// Build: make leaderboard
+// Run:   build/leaderboard [socket] [snapshot] [threads] [snapshot seconds] [port]
+
+#include "Leaderboard.h"
+#include "LeaderboardClient.h"
+#include "ReplayFile.h"
+#include "ReplayVerifier.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET SocketHandle;
+typedef int SocketLength;
+static const SocketHandle NO_SOCKET = INVALID_SOCKET;
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+typedef int SocketHandle;
+typedef socklen_t SocketLength;
+static const SocketHandle NO_SOCKET = -1;
+#endif
+
+static std::atomic<bool> running(true);
+
+// Submissions that parsed, waiting for the verifier. Bounded in replays and
+// in the ticks they claim, so a burst (or a flood of long replays) is
+// dropped here instead of growing the queue without limit.
+class SubmissionQueue {
+private:
+    static const size_t MAX_REPLAYS = 4096;
+    static const uint64_t MAX_TICKS = (uint64_t)1 << 28;
+
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<Replay> replays;
+    uint64_t ticks = 0;
+    uint32_t dropped = 0;
+    bool closed = false;
+
+public:
+    void Push(Replay&& replay) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (replays.size() >= MAX_REPLAYS || ticks + replay.actions.size() > MAX_TICKS) {
+            dropped++;
+            return;
+        }
+        ticks += replay.actions.size();
+        replays.push_back(std::move(replay));
+        ready.notify_one();
+    }
+
+    // Moves everything queued into 'batch', waiting a little for the first
+    // one; false once the queue is closed and empty
+    bool PopAll(std::vector<Replay>& batch) {
+        batch.clear();
+        std::unique_lock<std::mutex> lock(mutex);
+        ready.wait_for(lock, std::chrono::milliseconds(200), [this] { return !replays.empty() || closed; });
+        for (Replay& replay : replays) {
+            batch.push_back(std::move(replay));
+        }
+        replays.clear();
+        ticks = 0;
+        return !batch.empty() || !closed;
+    }
+
+    // Receivers are done: the verifier drains what is left and stops
+    void Close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        ready.notify_all();
+    }
+
+    uint32_t GetDropped() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return dropped;
+    }
+};
+
+static void HandleSignal(int) {
+    running.store(false);
+}
+
+static void CloseSocket(SocketHandle fd) {
+#if defined(_WIN32)
+    closesocket(fd);
+#else
+    close(fd);
+#endif
+}
+
+// Receivers wake up regularly to notice shutdown, and bursts of game-overs
+// queue in the kernel instead of being dropped
+static void ConfigureSocket(SocketHandle fd) {
+    int bufferBytes = 4 << 20;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&bufferBytes), sizeof(bufferBytes));
+#if defined(_WIN32)
+    DWORD timeout = 200;
+#else
+    timeval timeout = {0, 200000};
+#endif
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+}
+
+static SocketHandle BindLoopback(uint16_t port) {
+    SocketHandle fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd == NO_SOCKET) return NO_SOCKET;
+
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        CloseSocket(fd);
+        return NO_SOCKET;
+    }
+    return fd;
+}
+
+#if !defined(_WIN32)
+static SocketHandle BindUnix(const char* path) {
+    SocketHandle fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    if (fd == NO_SOCKET) return NO_SOCKET;
+
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+    unlink(path);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        CloseSocket(fd);
+        return NO_SOCKET;
+    }
+    return fd;
+}
+#endif
+
+// The replay must be one a game on this service's rules recorded: the
+// classic board, keyframed at least as often as the game does
+static bool ReadSubmission(const uint8_t* bytes, size_t size, Replay& replay) {
+    ReplayReader reader;
+    if (!reader.Open(bytes, size)) return false;
+
+    const ReplayFileHeader& header = reader.GetHeader();
+    static const ClassicSimulation::BoardType board;
+    if (header.boardWidth != board.Width() || header.boardHeight != board.Height() ||
+        header.keyframeInterval > LEADERBOARD_REPLAY_KEYFRAME_INTERVAL) {
+        return false;
+    }
+    return reader.ReadReplay(replay);
+}
+
+// Every receiver blocks on the same socket; the kernel hands each datagram
+// to one of them. Submitted replays are parsed here and queued for the
+// verifier; queries are answered from the lock-free board. Replies echo
+// the request id so a client can skip answers it gave up on.
+static void ReceiveLoop(SocketHandle fd, Leaderboard* board, SubmissionQueue* queue) {
+    // uint64_t words keep the replay after the request 8-byte aligned
+    std::vector<uint64_t> buffer((sizeof(LeaderboardRequest) + LEADERBOARD_MAX_REPLAY_BYTES + 7) / 8);
+    LeaderboardRequest& request = *reinterpret_cast<LeaderboardRequest*>(buffer.data());
+    const uint8_t* replayBytes = reinterpret_cast<const uint8_t*>(buffer.data()) + sizeof(LeaderboardRequest);
+    LeaderboardReply reply;
+    sockaddr_storage client;
+
+    while (running.load(std::memory_order_relaxed)) {
+        SocketLength clientLength = sizeof(client);
+        client.ss_family = AF_UNSPEC;
+        long received = (long)recvfrom(fd, reinterpret_cast<char*>(buffer.data()), buffer.size() * 8, 0,
+                                       reinterpret_cast<sockaddr*>(&client), &clientLength);
+        if (received < (long)sizeof(request) || request.magic != LEADERBOARD_MAGIC) continue;
+
+        if (request.op == LEADERBOARD_SUBMIT) {
+            Replay replay;
+            if (request.count <= LEADERBOARD_MAX_REPLAY_BYTES &&
+                received == (long)(sizeof(request) + request.count) &&
+                ReadSubmission(replayBytes, request.count, replay)) {
+                queue->Push(std::move(replay));
+            }
+            continue;
+        }
+        if (received != (long)sizeof(request)) continue;
+
+        reply.magic = LEADERBOARD_MAGIC;
+        reply.id = request.id;
+        reply.total = board->Size();
+        reply.rank = 0;
+        reply.count = 0;
+        if (request.op == LEADERBOARD_TOP) {
+            int count = request.count < (uint32_t)LEADERBOARD_MAX_TOP ? (int)request.count : LEADERBOARD_MAX_TOP;
+            reply.count = (uint32_t)board->Top(reply.entries, count);
+        } else if (request.op == LEADERBOARD_RANK) {
+            reply.rank = board->Rank(request.score);
+        }
+
+        // An unbound UNIX client has no address to answer
+        if (client.ss_family != AF_INET && clientLength <= (SocketLength)sizeof(client.ss_family)) continue;
+
+        size_t length = offsetof(LeaderboardReply, entries) + reply.count * sizeof(LeaderboardEntry);
+#if defined(_WIN32)
+        sendto(fd, reinterpret_cast<const char*>(&reply), (int)length, 0,
+               reinterpret_cast<sockaddr*>(&client), clientLength);
+#else
+        sendto(fd, &reply, length, MSG_DONTWAIT, reinterpret_cast<sockaddr*>(&client), clientLength);
+#endif
+    }
+}
+
+// Re-runs every queued replay on the pool (ReplayVerifier deals them out in
+// chunks) and ranks the ones whose inputs really produce their score
+static void VerifyLoop(SubmissionQueue* queue, Leaderboard* board, int threads, uint32_t* rejected) {
+    ThreadPool pool(threads);
+    ReplayVerifier<ClassicSimulation> verifier(pool);
+    std::vector<Replay> batch;
+
+    while (queue->PopAll(batch)) {
+        if (batch.empty()) continue;
+        std::vector<ReplayVerdict> verdicts = verifier.VerifyAll(batch);
+        for (size_t i = 0; i < batch.size(); i++) {
+            if (verdicts[i] == REPLAY_OK) {
+                board->Submit(batch[i].player, batch[i].score);
+            } else {
+                (*rejected)++;
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* socketPath = argc > 1 ? argv[1] : LEADERBOARD_SOCKET;
+    const char* snapshotPath = argc > 2 ? argv[2] : "leaderboard.snapshot";
+    int threads = argc > 3 ? std::atoi(argv[3]) : 4;
+    int snapshotSeconds = argc > 4 ? std::atoi(argv[4]) : 30;
+    uint16_t port = argc > 5 ? (uint16_t)std::atoi(argv[5]) : LEADERBOARD_PORT;
+
+#if defined(_WIN32)
+    WSADATA data;
+    WSAStartup(MAKEWORD(2, 2), &data);
+#endif
+
+    Leaderboard board(1 << 20);
+    if (board.LoadSnapshot(snapshotPath)) {
+        printf("loaded %u scores from %s\n", board.Size(), snapshotPath);
+    }
+
+    std::vector<SocketHandle> sockets;
+#if !defined(_WIN32)
+    SocketHandle unixSocket = BindUnix(socketPath);
+    if (unixSocket == NO_SOCKET) {
+        perror("leaderboard: bind");
+        return 1;
+    }
+    sockets.push_back(unixSocket);
+    printf("leaderboard listening on %s\n", socketPath);
+#endif
+    SocketHandle loopback = BindLoopback(port);
+    if (loopback != NO_SOCKET) {
+        sockets.push_back(loopback);
+        printf("leaderboard listening on 127.0.0.1:%u (udp)\n", (unsigned)port);
+    } else {
+        fprintf(stderr, "leaderboard: cannot bind 127.0.0.1:%u\n", (unsigned)port);
+        if (sockets.empty()) return 1;
+    }
+
+    std::signal(SIGINT, HandleSignal);
+    std::signal(SIGTERM, HandleSignal);
+
+    SubmissionQueue queue;
+    uint32_t failedVerification = 0;
+    std::thread verifierThread(VerifyLoop, &queue, &board, threads, &failedVerification);
+
+    std::vector<std::thread> receivers;
+    for (SocketHandle fd : sockets) {
+        ConfigureSocket(fd);
+        for (int i = 0; i < threads; i++) {
+            receivers.emplace_back(ReceiveLoop, fd, &board, &queue);
+        }
+    }
+    printf("%d receivers per socket, %d verifier threads\n", threads, threads);
+
+    auto lastSnapshot = std::chrono::steady_clock::now();
+    uint32_t savedSize = board.Size();
+    while (running.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastSnapshot >= std::chrono::seconds(snapshotSeconds) && board.Size() != savedSize) {
+            savedSize = board.Size();
+            board.SaveSnapshot(snapshotPath);
+            lastSnapshot = now;
+        }
+    }
+
+    for (std::thread& receiver : receivers) {
+        receiver.join();
+    }
+    queue.Close();
+    verifierThread.join();
+
+    board.SaveSnapshot(snapshotPath);
+    printf("saved %u scores to %s (%u rejected: board full)\n", board.Size(), snapshotPath, board.GetRejected());
+    printf("%u replays failed verification, %u dropped: queue full\n", failedVerification, queue.GetDropped());
+
+    for (SocketHandle fd : sockets) {
+        CloseSocket(fd);
+    }
+#if defined(_WIN32)
+    WSACleanup();
+#else
+    unlink(socketPath);
+#endif
+    return 0;
+}
@@ -0,0 +1,68 @@
+// Authoritative multiplayer server: one shared board, one snake per UDP
+// client, state broadcast every tick (protocol in TickProtocol.h).
+// Build: make tickserver (Linux)
+// Run:   build/tick_server [port] [tick rate] [max sessions] [width] [height]
+
+#include "TickServer.h"
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+
+static std::atomic<bool> running(true);
+
+static void HandleSignal(int) {
+    running.store(false);
+}
+
+int main(int argc, char** argv) {
+    TickServerConfig config;
+    if (argc > 1) config.port = (uint16_t)std::atoi(argv[1]);
+    if (argc > 2) config.tickRate = std::atoi(argv[2]);
+    if (argc > 3) config.maxSessions = std::atoi(argv[3]);
+    if (argc > 4) config.width = std::atoi(argv[4]);
+    if (argc > 5) config.height = std::atoi(argv[5]);
+    // Cell ids run up to width * height - 1; TICK_NO_CELL itself is reserved
+    if (config.width < 1 || config.height < 1 || config.width * config.height > TICK_NO_CELL) {
+        fprintf(stderr, "tick_server: board must have at most %d cells\n", (int)TICK_NO_CELL);
+        return 1;
+    }
+
+    TickServer server(config);
+    if (!server.Open()) {
+        perror("tick_server: open");
+        return 1;
+    }
+
+    std::signal(SIGINT, HandleSignal);
+    std::signal(SIGTERM, HandleSignal);
+    printf("tick server on udp port %u: %dx%d board, %d Hz, up to %d players\n",
+           server.GetPort(), config.width, config.height, config.tickRate, config.maxSessions);
+
+    auto lastReport = std::chrono::steady_clock::now();
+    TickServerStats reported = server.GetStats();
+    while (running.load()) {
+        server.Poll(200);
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastReport < std::chrono::seconds(5)) continue;
+        const TickServerStats& stats = server.GetStats();
+        uint64_t ticks = stats.ticks - reported.ticks;
+        if (ticks > 0) {
+            printf("%d players, tick %.1f us avg (%.1f max overall), %.1f KB/tick out, %llu drops\n",
+                   server.GetSessionCount(), (stats.tickNanos - reported.tickNanos) / 1e3 / ticks,
+                   stats.maxTickNanos / 1e3, (stats.bytesOut - reported.bytesOut) / 1024.0 / ticks,
+                   (unsigned long long)(stats.sendDrops - reported.sendDrops));
+        }
+        reported = stats;
+        lastReport = now;
+    }
+
+    const TickServerStats& stats = server.GetStats();
+    printf("%llu ticks, %llu joins, %llu timeouts, %llu datagrams in, %llu out\n",
+           (unsigned long long)stats.ticks, (unsigned long long)stats.joins,
+           (unsigned long long)stats.timeouts, (unsigned long long)stats.datagramsIn,
+           (unsigned long long)stats.datagramsOut);
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include "AllocProfiler.h"
+
+#ifdef SNAKE_PROFILE_ALLOCS
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+static thread_local AllocCounts threadCounts = {0, 0};
+static AllocScopeStats scopeStats[ALLOC_SCOPE_COUNT];
+
+static const char* const SCOPE_NAMES[ALLOC_SCOPE_COUNT] = {
+    "Game::Update", "Game::Draw", "Snake", "Food", "PowerUp", "SoundManager"
+};
+
+static void* CountedAlloc(size_t size, size_t alignment) {
+    threadCounts.allocations++;
+    threadCounts.bytes += size;
+
+    if (size == 0) size = 1;
+    void* p;
+    if (alignment <= alignof(std::max_align_t)) {
+        p = std::malloc(size);
+    } else {
+#if defined(_WIN32)
+        p = _aligned_malloc(size, alignment);
+#else
+        if (posix_memalign(&p, alignment, size) != 0) p = nullptr;
+#endif
+    }
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+// Global replacements: the array and nothrow forms forward to these
+void* operator new(size_t size) { return CountedAlloc(size, 0); }
+void* operator new(size_t size, std::align_val_t alignment) { return CountedAlloc(size, (size_t)alignment); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+void operator delete(void* p, std::align_val_t) noexcept {
+#if defined(_WIN32)
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+void operator delete(void* p, size_t, std::align_val_t alignment) noexcept {
+    operator delete(p, alignment);
+}
+
+AllocCounts AllocProfiler::ThreadCounts() {
+    return threadCounts;
+}
+
+void AllocProfiler::Record(AllocScopeId id, const AllocCounts& delta) {
+    AllocScopeStats& stats = scopeStats[id];
+    stats.calls++;
+    stats.allocations += delta.allocations;
+    stats.bytes += delta.bytes;
+}
+
+const AllocScopeStats& AllocProfiler::GetScopeStats(AllocScopeId id) {
+    return scopeStats[id];
+}
+
+const char* AllocProfiler::GetScopeName(AllocScopeId id) {
+    return SCOPE_NAMES[id];
+}
+
+void AllocProfiler::Reset() {
+    for (int i = 0; i < ALLOC_SCOPE_COUNT; i++) {
+        scopeStats[i] = {0, 0, 0};
+    }
+}
+
+void AllocProfiler::Report(FILE* out) {
+    fprintf(out, "%-14s %10s %10s %12s %10s\n", "scope", "calls", "allocs", "bytes", "allocs/call");
+    for (int i = 0; i < ALLOC_SCOPE_COUNT; i++) {
+        const AllocScopeStats& stats = scopeStats[i];
+        fprintf(out, "%-14s %10llu %10llu %12llu %10.3f\n", SCOPE_NAMES[i],
+                (unsigned long long)stats.calls, (unsigned long long)stats.allocations,
+                (unsigned long long)stats.bytes,
+                stats.calls ? (double)stats.allocations / stats.calls : 0.0);
+    }
+}
+
+void AllocProfiler::FailNoAllocs(const char* file, int line, const AllocCounts& delta) {
+    fprintf(stderr, "%s:%d: %llu allocation(s), %llu bytes in a no-allocation scope\n",
+            file, line, (unsigned long long)delta.allocations, (unsigned long long)delta.bytes);
+    std::abort();
+}
+
+#endif
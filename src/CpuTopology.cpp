@@ -0,0 +1,90 @@
+#include "CpuTopology.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
+// Parses a kernel cpulist such as "0-15,32-47"
+static std::vector<int> ParseCpuList(const char* text) {
+    std::vector<int> cpus;
+    const char* p = text;
+    while (*p) {
+        char* end;
+        long first = std::strtol(p, &end, 10);
+        if (end == p) break;
+        long last = first;
+        p = end;
+        if (*p == '-') {
+            last = std::strtol(p + 1, &end, 10);
+            p = end;
+        }
+        for (long cpu = first; cpu <= last; cpu++) {
+            cpus.push_back((int)cpu);
+        }
+        if (*p == ',') p++;
+        else break;
+    }
+    return cpus;
+}
+
+CpuTopology::CpuTopology() {
+#if defined(__linux__)
+    // Node ids can be sparse, so probe a fixed range rather than stop at a gap
+    for (int id = 0; id < 256; id++) {
+        char path[96];
+        std::snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", id);
+        FILE* file = std::fopen(path, "r");
+        if (!file) continue;
+
+        char line[4096] = {};
+        if (std::fgets(line, sizeof(line), file)) {
+            std::vector<int> cpus = ParseCpuList(line);
+            if (!cpus.empty()) nodes.push_back({id, cpus});
+        }
+        std::fclose(file);
+    }
+#endif
+
+    if (nodes.empty()) {
+        NumaNode node = {0, {}};
+        int count = (int)std::thread::hardware_concurrency();
+        for (int cpu = 0; cpu < (count > 0 ? count : 1); cpu++) {
+            node.cpus.push_back(cpu);
+        }
+        nodes.push_back(node);
+    }
+}
+
+const CpuTopology& CpuTopology::Get() {
+    static const CpuTopology topology;
+    return topology;
+}
+
+int CpuTopology::CpuForWorker(int worker, int& node) const {
+    const NumaNode& target = nodes[worker % nodes.size()];
+    node = target.id;
+    return target.cpus[(worker / nodes.size()) % target.cpus.size()];
+}
+
+bool CpuTopology::PinCurrentThread(int cpu) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#elif defined(_WIN32)
+    if (cpu >= (int)(sizeof(DWORD_PTR) * 8)) return false;
+    return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) != 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
@@ -1,12 +1,17 @@
 #include "Food.h"
+#include "AllocProfiler.h"
+#include "FrameProfiler.h"
+#include "PerfCounters.h"
+#include "Tracer.h"
 #include <cstdlib>
 #include <ctime>
 
-Food::Food(int cellSize, int screenWidth, int screenHeight) 
-    : cellSize(cellSize), foodColor(RED) {
+Food::Food(int cellSize, int screenWidth, int screenHeight, std::pmr::memory_resource* memory)
+    : cellSize(cellSize), foodColor(RED), validPositions(memory) {
     
     gridWidth = screenWidth / cellSize;
     gridHeight = screenHeight / cellSize;
+    validPositions.reserve(gridWidth * gridHeight);
     
     // Seed random
     srand(time(nullptr));
@@ -17,9 +22,10 @@ Food::Food(int cellSize, int screenWidth, int screenHeight)
 }
 
 // DATA STRUCTURE: Vector to store all valid spawn positions
-// WHY: Allows us to filter out snake positions and randomly select from remaining
-std::vector<Vector2> Food::GetValidPositions(const std::deque<Vector2>& snakeBody) {
-    std::vector<Vector2> validPositions;
+// WHY: Allows us to filter out snake positions and randomly select from remaining.
+// It is reserved for the whole grid once and refilled in place on every spawn.
+const std::pmr::vector<Vector2>& Food::GetValidPositions(const SnakeBody& snakeBody) {
+    validPositions.clear();
     
     // Generate all possible positions
     for (int x = 0; x < gridWidth; x++) {
@@ -44,8 +50,12 @@ std::vector<Vector2> Food::GetValidPositions(const std::deque<Vector2>& snakeBod
     return validPositions;
 }
 
-void Food::Spawn(const std::deque<Vector2>& snakeBody) {
-    std::vector<Vector2> validPositions = GetValidPositions(snakeBody);
+void Food::Spawn(const SnakeBody& snakeBody) {
+    PROFILE_SCOPE(PROFILE_SPAWN);
+    TRACE_SCOPE("Food::Spawn");
+    PERF_SCOPE(PERF_REGION_FOOD_SPAWN);
+    PROFILE_ALLOCS(ALLOC_FOOD);
+    GetValidPositions(snakeBody);
     
     if (!validPositions.empty()) {
         int randomIndex = rand() % validPositions.size();
@@ -54,6 +64,8 @@ void Food::Spawn(const std::deque<Vector2>& snakeBody) {
 }
 
 void Food::Draw() const {
+    PROFILE_SCOPE(PROFILE_DRAW_FOOD);
+    PROFILE_ALLOCS(ALLOC_FOOD);
     DrawRectangle(position.x, position.y, cellSize, cellSize, foodColor);
     DrawRectangleLines(position.x, position.y, cellSize, cellSize, DARKGRAY);
 }
@@ -0,0 +1,58 @@
+#include "FrameProfiler.h"
+#include <chrono>
+#include <cstring>
+
+static const char* const SECTION_NAMES[PROFILE_SECTION_COUNT] = {
+    "HandleInput", "Update", "UpdateMusic", "CheckCollisions", "Spawn",
+    "DrawGrid", "Snake::Draw", "Food::Draw", "PowerUp::Draw",
+    "DrawActivePowerUps", "DrawHUD", "DrawGameOver"
+};
+
+FrameProfiler::FrameProfiler()
+    : enabled(false), frame(0), startTicks(Now()), startNanoseconds((int64_t)NowNanoseconds()),
+      nanosecondsPerTick(1.0) {
+    std::memset(frameTicks, 0, sizeof(frameTicks));
+    std::memset(history, 0, sizeof(history));
+}
+
+FrameProfiler& FrameProfiler::Get() {
+    static FrameProfiler profiler;
+    return profiler;
+}
+
+uint64_t FrameProfiler::NowNanoseconds() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void FrameProfiler::EndFrame() {
+    ring.Drain([this](const TimerSample& sample) {
+        frameTicks[sample.section] += sample.ticks;
+    });
+
+#ifdef FRAMEPROFILER_TSC
+    int64_t elapsed = (int64_t)NowNanoseconds() - startNanoseconds;
+    uint64_t elapsedTicks = Now() - startTicks;
+    if (elapsed > 0 && elapsedTicks > 0) {
+        nanosecondsPerTick = (double)elapsed / (double)elapsedTicks;
+    }
+#endif
+
+    for (int i = 0; i < PROFILE_SECTION_COUNT; i++) {
+        history[i][frame] = (float)(frameTicks[i] * nanosecondsPerTick / 1000.0);
+        frameTicks[i] = 0;
+    }
+    frame = (frame + 1) % HISTORY;
+}
+
+float FrameProfiler::GetAverage(ProfileSection section) const {
+    float total = 0.0f;
+    for (int i = 0; i < HISTORY; i++) {
+        total += history[section][i];
+    }
+    return total / HISTORY;
+}
+
+const char* FrameProfiler::GetSectionName(ProfileSection section) {
+    return SECTION_NAMES[section];
+}
@@ -1,53 +1,135 @@
 #include "Game.h"
+#include "PerfCounters.h"
+#include "Tracer.h"
 #include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+static const char* const STATS_FILE = "snake_stats.dat";
+static const char* const STATS_VARIANT = "classic";
+
+// Sized for the fastest move rate (speed boost halves the 0.15s interval)
+static const float REWIND_SECONDS = 10.0f;
+static const uint32_t REWIND_CAPACITY = (uint32_t)(REWIND_SECONDS / 0.075f) + 1;
+static const float REWIND_STEP_SECONDS = 0.05f;
 
 Game::Game(int width, int height, const char* title) 
     : screenWidth(width), screenHeight(height), cellSize(20), 
-      isRunning(true), gameOver(false), moveTimer(0.0f), 
+      isRunning(true), gameOver(false),
+      memory((size_t)(screenWidth / cellSize) * (screenHeight / cellSize) * sizeof(Vector2)),
+      rewind(REWIND_CAPACITY, memory.Resource()),
+      rewinding(false), rewindTimer(0.0f), moveTimer(0.0f), 
       baseMoveInterval(0.15f), currentMoveInterval(0.15f),
-      score(0), highScore(0) {
+      score(0), highScore(0),
+      replayWriter(tickSim, LEADERBOARD_REPLAY_KEYFRAME_INTERVAL), recording(false) {
     
     InitWindow(screenWidth, screenHeight, title);
     SetTargetFPS(60);
+    profilerOverlay.Initialize();
     
-    Vector2 startPos = {(float)(screenWidth/2), (float)(screenHeight/2)};
-    snake = new Snake(startPos, cellSize);
-    food = new Food(cellSize, screenWidth, screenHeight);
-    powerUp = new PowerUp(cellSize, screenWidth, screenHeight);
-    soundManager = new SoundManager();
+    stats.Open(STATS_FILE);
+    highScore = stats.GetHighScore(STATS_VARIANT);
+    
+    // Optional: scores also go to the host's leaderboard service if it runs
+    leaderboard.Open();
+    playerName = std::getenv("SNAKE_PLAYER");
+    if (!playerName) playerName = "player";
+    
+    // Recording stops before a replay outgrows this, so ticks never allocate
+    replayWriter.Reserve(LEADERBOARD_MAX_REPLAY_BYTES);
+    replayBytes.reserve(LEADERBOARD_MAX_REPLAY_BYTES);
+    
+    // SNAKE_TRACE=trace.json records a Chrome trace of every frame
+    if (const char* tracePath = std::getenv("SNAKE_TRACE")) {
+        if (Tracer::Get().Start(tracePath)) {
+            Tracer::Get().SetThreadName("Main");
+        }
+    }
+    
+    CreateEntities();
+    soundManager = memory.New<SoundManager>();
     
     soundManager->Initialize();
     soundManager->PlayBackgroundMusic();
-    
-    food->Spawn(snake->GetBody());
 }
 
 Game::~Game() {
-    delete snake;
-    delete food;
-    delete powerUp;
-    delete soundManager;
+#ifdef SNAKE_PROFILE_ALLOCS
+    AllocProfiler::Report(stdout);
+    printf("tick latency (ns): count %llu  p50 %llu  p99 %llu  p99.9 %llu  max %llu\n",
+           (unsigned long long)tickLatency.Count(),
+           (unsigned long long)tickLatency.ValueAtPercentile(50.0),
+           (unsigned long long)tickLatency.ValueAtPercentile(99.0),
+           (unsigned long long)tickLatency.ValueAtPercentile(99.9),
+           (unsigned long long)tickLatency.Max());
+#endif
+#ifdef SNAKE_PERF_COUNTERS
+    PerfRegions::Report(stdout);
+#endif
+    if (gameOver) {
+        RecordGame();
+    }
+    DestroyEntities();
+    memory.Delete(soundManager);
+    Tracer::Get().Stop();
+    profilerOverlay.Shutdown();
     CloseWindow();
 }
 
+// Snake, food and power-up live in the game's own pool, and so do their
+// containers: a Reset() reuses the blocks the previous round gave back
+void Game::CreateEntities() {
+    std::pmr::memory_resource* resource = memory.Resource();
+    
+    Vector2 startPos = {(float)(screenWidth/2), (float)(screenHeight/2)};
+    snake = memory.New<Snake>(startPos, cellSize, resource);
+    food = memory.New<Food>(cellSize, screenWidth, screenHeight, resource);
+    powerUp = memory.New<PowerUp>(cellSize, screenWidth, screenHeight, resource);
+    
+    food->Spawn(snake->GetBody());
+    BeginRecording();
+}
+
+void Game::DestroyEntities() {
+    memory.Delete(snake);
+    memory.Delete(food);
+    memory.Delete(powerUp);
+}
+
 void Game::Run() {
     while (!WindowShouldClose() && isRunning) {
+        TRACE_SCOPE("Frame");
         HandleInput();
         Update();
         Draw();
+        FrameProfiler::Get().EndFrame();
     }
 }
 
 void Game::HandleInput() {
+    PROFILE_SCOPE(PROFILE_HANDLE_INPUT);
+    
     if (IsKeyPressed(KEY_M)) {
         soundManager->ToggleMute();
     }
     
-    if (gameOver && IsKeyPressed(KEY_SPACE)) {
+    if (IsKeyPressed(KEY_F3)) {
+        profilerOverlay.Toggle();
+    }
+    
+    // Hold R to step back through the last moves, even from the game over screen
+    rewinding = IsKeyDown(KEY_R) && rewind.Size() > 0;
+    if (!rewinding) {
+        rewindTimer = REWIND_STEP_SECONDS;  // first step lands on the press
+    }
+    
+    if (gameOver && !rewinding && IsKeyPressed(KEY_SPACE)) {
         Reset();
     }
     
-    if (!gameOver) {
+    if (!gameOver && !rewinding) {
         if (IsKeyPressed(KEY_UP) || IsKeyPressed(KEY_W)) {
             snake->SetDirection(UP);
         }
@@ -64,14 +146,33 @@ void Game::HandleInput() {
 }
 
 void Game::Update() {
+    Update(GetFrameTime());
+}
+
+void Game::Update(float deltaTime) {
+    PROFILE_SCOPE(PROFILE_UPDATE);
+    TRACE_SCOPE("Update");
+    
+    if (rewinding) {
+        UpdateRewind(deltaTime);
+        return;
+    }
     if (gameOver) return;
     
-    float deltaTime = GetFrameTime();
+    // Every container a tick touches lives in 'memory', which takes its
+    // blocks from the heap while the entities are created, not per tick
+    PROFILE_ALLOCS(ALLOC_UPDATE);
+    ASSERT_NO_ALLOCS();
+#ifdef SNAKE_PROFILE_ALLOCS
+    ScopedLatency latency(tickLatency);
+#endif
     
     soundManager->UpdateMusic();
     
     powerUp->Update(deltaTime);
-    powerUp->Spawn(snake->GetBody());
+    if (!recording) {
+        powerUp->Spawn(snake->GetBody());
+    }
     
     UpdatePowerUpEffects();
     
@@ -79,9 +180,203 @@ void Game::Update() {
     
     if (moveTimer >= currentMoveInterval) {
         moveTimer = 0.0f;
-        snake->Move();
-        CheckCollisions();
+        RecordMove();
+        if (recording) {
+            StepSimulation();
+        } else {
+            snake->Move();
+            CheckCollisions();
+        }
+    }
+}
+
+// Only the 40x30 grid matches ClassicSimulation; other sizes play unranked
+void Game::BeginRecording() {
+    recording = screenWidth / cellSize == tickSim.GetBoard().Width() &&
+                screenHeight / cellSize == tickSim.GetBoard().Height();
+    if (!recording) return;
+    
+    // Not GetRandomValue(): Food reseeds rand() from the clock's seconds on
+    // every round, so rounds started within a second would share a seed
+    uint64_t seed = (uint64_t)std::chrono::high_resolution_clock::now().time_since_epoch().count();
+    replayWriter.Begin(seed, playerName);
+    SyncFromSimulation();
+}
+
+// The snake moves itself; whether it ate, collected or died is read off
+// the simulation, as are the new food and power-up
+void Game::StepSimulation() {
+    int foodCell = tickSim.GetFoodCell();
+    int powerUpCell = tickSim.GetPowerUpCell();
+    bool alive = replayWriter.Step(snake->GetNextDirection());
+    snake->Move();
+    if (!alive) {
+        EndGame();
+        return;
+    }
+    
+    int head = tickSim.GetHeadCell();
+    snake->SetHeadPosition(CellPosition(head));
+    if (head == foodCell) {
+        snake->Grow();
+        soundManager->PlayEatSound();
+    }
+    if (head == powerUpCell) {
+        soundManager->PlayPowerUpSound();
     }
+    score = tickSim.GetScore();
+    SyncFromSimulation();
+    
+    // A replay too long to submit plays on unrecorded, and unranked
+    if (replayWriter.GetEncodedBytes() + replayWriter.GetMaxStepBytes() > LEADERBOARD_MAX_REPLAY_BYTES) {
+        recording = false;
+    }
+}
+
+// Power-up timers come across at the base move interval per tick, the
+// rate the simulation converts them at
+void Game::SyncFromSimulation() {
+    if (tickSim.GetFoodCell() >= 0) {
+        food->SetPosition(CellPosition(tickSim.GetFoodCell()));
+    }
+    
+    PowerUpState state;
+    powerUp->SaveState(state);
+    state.isActive = tickSim.GetPowerUpCell() >= 0;
+    if (state.isActive) {
+        state.position = CellPosition(tickSim.GetPowerUpCell());
+        state.type = tickSim.GetPowerUpType();
+    }
+    state.spawnTimer = 0.0f;
+    state.activeCount = 0;
+    for (int type = 0; type < POWERUP_TYPE_COUNT; type++) {
+        int ticks = tickSim.GetPowerUpTicksRemaining(static_cast<PowerUpType>(type));
+        if (ticks > 0) {
+            state.active[state.activeCount++] = {static_cast<PowerUpType>(type), ticks * baseMoveInterval};
+        }
+    }
+    std::sort(state.active, state.active + state.activeCount);
+    powerUp->RestoreState(state);
+    UpdatePowerUpEffects();
+}
+
+Vector2 Game::CellPosition(int cell) const {
+    return {(float)(tickSim.GetBoard().X(cell) * cellSize), (float)(tickSim.GetBoard().Y(cell) * cellSize)};
+}
+
+// Greedy: the legal direction that stays on the board and off the body
+// and gets closest to the food; straight on if none is safe
+Direction Game::AutopilotDirection() const {
+    Vector2 head = snake->GetHeadPosition();
+    Vector2 target = food->GetPosition();
+    Direction best = snake->GetDirection();
+    float bestDistance = -1.0f;
+    
+    for (int d = 0; d < 4; d++) {
+        Direction dir = static_cast<Direction>(d);
+        if ((snake->GetDirection() ^ dir) == 1) continue;
+        
+        Vector2 next = head;
+        if (dir == UP) next.y -= cellSize;
+        if (dir == DOWN) next.y += cellSize;
+        if (dir == LEFT) next.x -= cellSize;
+        if (dir == RIGHT) next.x += cellSize;
+        if (next.x < 0 || next.x >= screenWidth || next.y < 0 || next.y >= screenHeight) continue;
+        
+        bool blocked = false;
+        for (const auto& segment : snake->GetBody()) {
+            if (segment.x == next.x && segment.y == next.y) {
+                blocked = true;
+                break;
+            }
+        }
+        if (blocked) continue;
+        
+        float distance = std::abs(next.x - target.x) + std::abs(next.y - target.y);
+        if (bestDistance < 0.0f || distance < bestDistance) {
+            best = dir;
+            bestDistance = distance;
+        }
+    }
+    return best;
+}
+
+#ifdef SNAKE_PROFILE_ALLOCS
+bool Game::Soak(int rounds, int maxMovesPerRound) {
+    size_t warmAllocations = 0;
+    
+    for (int round = 0; round < rounds; round++) {
+        for (int move = 0; move < maxMovesPerRound && !gameOver; move++) {
+            snake->SetDirection(AutopilotDirection());
+            Update(currentMoveInterval);
+        }
+        
+        // Not a real game: clear gameOver so Reset() does not record it
+        gameOver = false;
+        Reset();
+        
+        if (round == 0) {
+            warmAllocations = GetHeapAllocations();
+        } else if (GetHeapAllocations() != warmAllocations) {
+            printf("soak: round %d reached the heap (%zu allocations, %zu after warm-up)\n",
+                   round, GetHeapAllocations(), warmAllocations);
+            return false;
+        }
+    }
+    printf("soak: %d rounds, %zu heap allocations, none after warm-up\n", rounds, warmAllocations);
+    return true;
+}
+#endif
+
+// Called right before Move(): everything the move and CheckCollisions may
+// change, as it is now
+void Game::RecordMove() {
+    const SnakeBody& body = snake->GetBody();
+    RewindEntry& entry = rewind.Push();
+    entry.removedTail = body.back();
+    entry.foodPosition = food->GetPosition();
+    entry.bodySize = (uint32_t)body.size();
+    entry.score = score;
+    entry.direction = snake->GetDirection();
+    entry.nextDirection = snake->GetNextDirection();
+    powerUp->SaveState(entry.powerUp);
+}
+
+void Game::StepBack() {
+    const RewindEntry* entry = rewind.Pop();
+    if (!entry) return;
+    
+    // The replay cannot take moves back, so a rewound round finishes unranked
+    recording = false;
+    
+    if (snake->GetBody().size() > entry->bodySize) {
+        snake->Shrink();
+    }
+    snake->Unmove(entry->removedTail, entry->direction, entry->nextDirection);
+    food->SetPosition(entry->foodPosition);
+    powerUp->RestoreState(entry->powerUp);
+    score = entry->score;
+    UpdatePowerUpEffects();
+}
+
+// Rewinds at twice the base move rate. Stepping back past a death resumes
+// the game; the death was not recorded yet (see EndGame).
+void Game::UpdateRewind(float deltaTime) {
+    TRACE_SCOPE("Rewind");
+    PROFILE_ALLOCS(ALLOC_UPDATE);
+    
+    soundManager->UpdateMusic();
+    rewindTimer += deltaTime;
+    while (rewindTimer >= REWIND_STEP_SECONDS && rewind.Size() > 0) {
+        rewindTimer -= REWIND_STEP_SECONDS;
+        StepBack();
+        
+        if (gameOver) {
+            gameOver = false;
+            soundManager->PlayBackgroundMusic();
+        }
+    }
+    moveTimer = 0.0f;
 }
 
 void Game::UpdatePowerUpEffects() {
@@ -93,21 +388,20 @@ void Game::UpdatePowerUpEffects() {
 }
 
 void Game::CheckCollisions() {
+    PROFILE_SCOPE(PROFILE_COLLISIONS);
+    TRACE_SCOPE("CheckCollisions");
+    
     Vector2 head = snake->GetHeadPosition();
     
     if (!powerUp->HasActivePowerUp(INVINCIBILITY)) {
         if (head.x < 0 || head.x >= screenWidth || 
             head.y < 0 || head.y >= screenHeight) {
-            gameOver = true;
-            soundManager->PlayGameOverSound();
-            soundManager->StopBackgroundMusic();
+            EndGame();
             return;
         }
         
         if (snake->CheckSelfCollision()) {
-            gameOver = true;
-            soundManager->PlayGameOverSound();
-            soundManager->StopBackgroundMusic();
+            EndGame();
             return;
         }
     }
@@ -136,7 +430,28 @@ void Game::CheckCollisions() {
     }
 }
 
+// The game over screen can still be rewound, so the result is only
+// recorded once the player moves on (Reset) or quits from it
+void Game::EndGame() {
+    gameOver = true;
+    soundManager->PlayGameOverSound();
+    soundManager->StopBackgroundMusic();
+}
+
+// Recording is a few stores into the mapped stats file, so the frame that
+// records never waits on disk. Only a recorded round goes to the
+// leaderboard, as its replay, which the service verifies before ranking.
+void Game::RecordGame() {
+    stats.RecordGame(STATS_VARIANT, score);
+    if (recording && replayWriter.Encode(replayBytes)) {
+        leaderboard.Submit(replayBytes.data(), replayBytes.size());
+    }
+}
+
 void Game::Reset() {
+    if (gameOver) {
+        RecordGame();
+    }
     gameOver = false;
     
     if (score > highScore) {
@@ -144,22 +459,17 @@ void Game::Reset() {
     }
     
     score = 0;
+    rewind.Clear();
     
-    delete snake;
-    delete food;
-    delete powerUp;
-    
-    Vector2 startPos = {(float)(screenWidth/2), (float)(screenHeight/2)};
-    snake = new Snake(startPos, cellSize);
-    food = new Food(cellSize, screenWidth, screenHeight);
-    powerUp = new PowerUp(cellSize, screenWidth, screenHeight);
-    
-    food->Spawn(snake->GetBody());
+    DestroyEntities();
+    CreateEntities();
     
     soundManager->PlayBackgroundMusic();
 }
 
 void Game::DrawGrid() const {
+    PROFILE_SCOPE(PROFILE_DRAW_GRID);
+    
     for (int i = 0; i < screenWidth; i += cellSize) {
         DrawLine(i, 0, i, screenHeight, Fade(DARKGRAY, 0.3f));
     }
@@ -169,14 +479,22 @@ void Game::DrawGrid() const {
 }
 
 void Game::DrawHUD() const {
+    PROFILE_SCOPE(PROFILE_DRAW_HUD);
+    
     DrawText(TextFormat("Score: %d", score), 10, 10, 20, YELLOW);
     DrawText(TextFormat("High Score: %d", highScore), 10, 35, 20, GOLD);
     
     DrawText("WASD/Arrows: Move", screenWidth - 200, 10, 16, LIGHTGRAY);
-    DrawText("M: Mute", screenWidth - 200, 30, 16, LIGHTGRAY);
+    DrawText("M: Mute  F3: Profiler", screenWidth - 200, 30, 16, LIGHTGRAY);
+    DrawText("Hold R: Rewind", screenWidth - 200, 50, 16, LIGHTGRAY);
+    
+    if (rewinding) {
+        DrawText(TextFormat("<< REWIND  %u moves left", rewind.Size()),
+                 screenWidth/2 - 110, 10, 20, SKYBLUE);
+    }
     
     if (soundManager->IsMuted()) {
-        DrawText("[MUTED]", screenWidth - 90, 50, 16, RED);
+        DrawText("[MUTED]", screenWidth - 90, 70, 16, RED);
     }
     
     // Developer credit
@@ -184,6 +502,8 @@ void Game::DrawHUD() const {
 }
 
 void Game::DrawGameOver() const {
+    PROFILE_SCOPE(PROFILE_DRAW_GAME_OVER);
+    
     DrawRectangle(0, 0, screenWidth, screenHeight, Fade(BLACK, 0.7f));
     
     const char* gameOverText = "GAME OVER!";
@@ -212,7 +532,7 @@ void Game::DrawGameOver() const {
                  screenHeight/2 + 40, 20, LIGHTGRAY);
     }
     
-    const char* restartText = "Press SPACE to Restart";
+    const char* restartText = "Press SPACE to Restart  -  Hold R to Rewind";
     textWidth = MeasureText(restartText, 25);
     DrawText(restartText, 
              screenWidth/2 - textWidth/2, 
@@ -228,6 +548,9 @@ void Game::DrawGameOver() const {
     
 
 void Game::Draw() {
+    PROFILE_ALLOCS(ALLOC_DRAW);
+    TRACE_SCOPE("Draw");
+    PERF_SCOPE(PERF_REGION_RENDER);
     BeginDrawing();
     ClearBackground(BLACK);
     
@@ -250,5 +573,8 @@ void Game::Draw() {
         DrawGameOver();
     }
     
+    profilerOverlay.CaptureBatchStats();
+    profilerOverlay.Draw(screenWidth);
+    
     EndDrawing();
 }
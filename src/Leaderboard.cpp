@@ -0,0 +1,206 @@
+#include "Leaderboard.h"
+#include <cstdio>
+#include <cstring>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+static const uint32_t SNAPSHOT_MAGIC = 0x534E4B4C;  // "SNKL"
+
+Leaderboard::Leaderboard(uint32_t capacity)
+    : pool(new Node[capacity]), capacity(capacity), used(0), nextSequence(0), rejected(0),
+      rankTree(new std::atomic<uint32_t>[MAX_SCORE + 1]) {
+    std::memset(&head.entry, 0, sizeof(head.entry));
+    head.height = MAX_LEVEL;
+    for (int i = 0; i < MAX_LEVEL; i++) {
+        head.next[i].store(nullptr, std::memory_order_relaxed);
+    }
+    for (int32_t i = 0; i <= MAX_SCORE; i++) {
+        rankTree[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+int Leaderboard::RandomHeight() {
+    static thread_local uint32_t state = 0;
+    if (state == 0) {
+        state = (uint32_t)(uintptr_t)&state | 1;
+    }
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+
+    int height = 1;
+    uint32_t bits = state;
+    while (height < MAX_LEVEL && (bits & 3) == 0) {
+        height++;
+        bits >>= 2;
+    }
+    return height;
+}
+
+int32_t Leaderboard::RankSlot(int32_t score) {
+    if (score < 0) return 0;
+    return score >= MAX_SCORE ? MAX_SCORE - 1 : score;
+}
+
+// preds[i] is the last node at level i ordered before 'entry', succs[i] the
+// first one after it
+void Leaderboard::Find(const LeaderboardEntry& entry, Node** preds, Node** succs) {
+    Node* pred = &head;
+    for (int level = MAX_LEVEL - 1; level >= 0; level--) {
+        Node* current = pred->next[level].load(std::memory_order_acquire);
+        while (current && Before(current->entry, entry)) {
+            pred = current;
+            current = current->next[level].load(std::memory_order_acquire);
+        }
+        preds[level] = pred;
+        succs[level] = current;
+    }
+}
+
+bool Leaderboard::Insert(const LeaderboardEntry& entry) {
+    uint32_t slot = used.fetch_add(1, std::memory_order_relaxed);
+    if (slot >= capacity) {
+        used.fetch_sub(1, std::memory_order_relaxed);
+        rejected.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    Node* node = &pool[slot];
+    node->entry = entry;
+    node->height = RandomHeight();
+
+    Node* preds[MAX_LEVEL];
+    Node* succs[MAX_LEVEL];
+    Find(entry, preds, succs);
+
+    // Level 0 decides membership; the upper levels are only shortcuts
+    for (;;) {
+        node->next[0].store(succs[0], std::memory_order_relaxed);
+        Node* expected = succs[0];
+        if (preds[0]->next[0].compare_exchange_strong(expected, node, std::memory_order_release,
+                                                      std::memory_order_relaxed)) {
+            break;
+        }
+        Find(entry, preds, succs);
+    }
+
+    for (int level = 1; level < node->height; level++) {
+        for (;;) {
+            node->next[level].store(succs[level], std::memory_order_relaxed);
+            Node* expected = succs[level];
+            if (preds[level]->next[level].compare_exchange_strong(expected, node, std::memory_order_release,
+                                                                  std::memory_order_relaxed)) {
+                break;
+            }
+            Find(entry, preds, succs);
+        }
+    }
+
+    for (int32_t i = RankSlot(entry.score) + 1; i <= MAX_SCORE; i += i & -i) {
+        rankTree[i].fetch_add(1, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+bool Leaderboard::Submit(const char* player, int32_t score) {
+    LeaderboardEntry entry;
+    std::memset(&entry, 0, sizeof(entry));
+    entry.score = score;
+    entry.sequence = nextSequence.fetch_add(1, std::memory_order_relaxed);
+    std::strncpy(entry.player, player, LEADERBOARD_NAME_LENGTH - 1);
+    return Insert(entry);
+}
+
+int Leaderboard::Top(LeaderboardEntry* out, int count) const {
+    int found = 0;
+    const Node* node = head.next[0].load(std::memory_order_acquire);
+    while (node && found < count) {
+        out[found++] = node->entry;
+        node = node->next[0].load(std::memory_order_acquire);
+    }
+    return found;
+}
+
+uint32_t Leaderboard::CountAtMost(int32_t score) const {
+    uint32_t total = 0;
+    for (int32_t i = RankSlot(score) + 1; i > 0; i -= i & -i) {
+        total += rankTree[i].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint32_t Leaderboard::Rank(int32_t score) const {
+    return 1 + (CountAtMost(MAX_SCORE) - CountAtMost(score));
+}
+
+uint32_t Leaderboard::Size() const {
+    return CountAtMost(MAX_SCORE);
+}
+
+bool Leaderboard::SaveSnapshot(const char* path) const {
+    char tempPath[512];
+    std::snprintf(tempPath, sizeof(tempPath), "%s.tmp", path);
+
+    FILE* out = std::fopen(tempPath, "wb");
+    if (!out) return false;
+
+    uint32_t header[2] = {SNAPSHOT_MAGIC, 0};
+    bool ok = std::fwrite(header, sizeof(header), 1, out) == 1;
+
+    uint32_t count = 0;
+    for (const Node* node = head.next[0].load(std::memory_order_acquire); node && ok;
+         node = node->next[0].load(std::memory_order_acquire)) {
+        ok = std::fwrite(&node->entry, sizeof(LeaderboardEntry), 1, out) == 1;
+        count++;
+    }
+
+    header[1] = count;
+    ok = ok && std::fseek(out, 0, SEEK_SET) == 0;
+    ok = ok && std::fwrite(header, sizeof(header), 1, out) == 1;
+    ok = ok && std::fflush(out) == 0;
+
+    // The data must be on disk before the rename makes it the snapshot,
+    // or a crash can leave a renamed but empty file
+#if defined(_WIN32)
+    ok = ok && _commit(_fileno(out)) == 0;
+#else
+    ok = ok && fsync(fileno(out)) == 0;
+#endif
+    ok = std::fclose(out) == 0 && ok;
+    if (!ok) {
+        std::remove(tempPath);
+        return false;
+    }
+
+#if defined(_WIN32)
+    std::remove(path);  // rename() does not replace on Windows
+#endif
+    return std::rename(tempPath, path) == 0;
+}
+
+bool Leaderboard::LoadSnapshot(const char* path) {
+    FILE* in = std::fopen(path, "rb");
+    if (!in) return false;
+
+    uint32_t header[2];
+    if (std::fread(header, sizeof(header), 1, in) != 1 || header[0] != SNAPSHOT_MAGIC) {
+        std::fclose(in);
+        return false;
+    }
+
+    uint32_t maxSequence = nextSequence.load(std::memory_order_relaxed);
+    LeaderboardEntry entry;
+    for (uint32_t i = 0; i < header[1] && std::fread(&entry, sizeof(entry), 1, in) == 1; i++) {
+        entry.player[LEADERBOARD_NAME_LENGTH - 1] = '\0';
+        if (!Insert(entry)) break;
+        if (entry.sequence + 1 > maxSequence) maxSequence = entry.sequence + 1;
+    }
+    nextSequence.store(maxSequence, std::memory_order_relaxed);
+
+    std::fclose(in);
+    return true;
+}
@@ -0,0 +1,254 @@
+#include "LeaderboardClient.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <cerrno>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#if defined(_WIN32)
+
+typedef SOCKET NativeSocket;
+
+static intptr_t OpenSocket(int family) {
+    SOCKET handle = socket(family, SOCK_DGRAM, 0);
+    return handle == INVALID_SOCKET ? -1 : (intptr_t)handle;
+}
+
+static void CloseSocket(intptr_t fd) { closesocket((SOCKET)fd); }
+
+static void ConfigureSocket(intptr_t fd, int timeoutMilliseconds, int sendBufferBytes) {
+    DWORD timeout = (DWORD)timeoutMilliseconds;
+    setsockopt((SOCKET)fd, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+    setsockopt((SOCKET)fd, SOL_SOCKET, SO_SNDBUF, reinterpret_cast<const char*>(&sendBufferBytes),
+               sizeof(sendBufferBytes));
+}
+
+// UDP sends to the loopback do not block, so 'wait' needs no flag here
+static bool SendAll(intptr_t fd, const void* data, size_t size, bool) {
+    return send((SOCKET)fd, static_cast<const char*>(data), (int)size, 0) == (int)size;
+}
+
+static long Receive(intptr_t fd, void* data, size_t size) {
+    return recv((SOCKET)fd, static_cast<char*>(data), (int)size, 0);
+}
+
+// WSAECONNRESET: an earlier datagram hit a closed port (service down)
+static bool ShouldReconnect() {
+    int error = WSAGetLastError();
+    return error == WSAECONNRESET || error == WSAENOTCONN;
+}
+
+#else
+
+typedef int NativeSocket;
+
+static intptr_t OpenSocket(int family) { return socket(family, SOCK_DGRAM, 0); }
+
+static void CloseSocket(intptr_t fd) { close((int)fd); }
+
+// The send buffer also caps a datagram's size on UNIX sockets (2 KB by
+// default on macOS), which a submitted replay would exceed
+static void ConfigureSocket(intptr_t fd, int timeoutMilliseconds, int sendBufferBytes) {
+    timeval timeout = {timeoutMilliseconds / 1000, (timeoutMilliseconds % 1000) * 1000};
+    setsockopt((int)fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt((int)fd, SOL_SOCKET, SO_SNDBUF, &sendBufferBytes, sizeof(sendBufferBytes));
+}
+
+static bool SendAll(intptr_t fd, const void* data, size_t size, bool wait) {
+    return send((int)fd, data, size, wait ? 0 : MSG_DONTWAIT) == (ssize_t)size;
+}
+
+static long Receive(intptr_t fd, void* data, size_t size) {
+    return (long)recv((int)fd, data, size, 0);
+}
+
+// ECONNREFUSED: the service went away (a restarted one binds a new socket
+// file); ENOENT: it was never there when we connected
+static bool ShouldReconnect() {
+    return errno == ECONNREFUSED || errno == ENOENT || errno == ENOTCONN;
+}
+
+#endif
+
+static const int QUERY_TIMEOUT_MS = 500;
+// Room for two submissions queued behind each other
+static const int SEND_BUFFER_BYTES = (int)(2 * (sizeof(LeaderboardRequest) + LEADERBOARD_MAX_REPLAY_BYTES));
+
+LeaderboardClient::LeaderboardClient() : fd(-1), port(0), lastRequestId(0) {
+    socketPath[0] = '\0';
+#if defined(_WIN32)
+    WSADATA data;
+    WSAStartup(MAKEWORD(2, 2), &data);
+#endif
+}
+
+LeaderboardClient::~LeaderboardClient() {
+    Close();
+#if defined(_WIN32)
+    WSACleanup();
+#endif
+}
+
+bool LeaderboardClient::Open() {
+#if defined(_WIN32)
+    return OpenLoopback(LEADERBOARD_PORT);
+#else
+    return Open(LEADERBOARD_SOCKET);
+#endif
+}
+
+bool LeaderboardClient::Open(const char* path) {
+#if defined(_WIN32)
+    (void)path;
+    return false;
+#else
+    std::strncpy(socketPath, path, sizeof(socketPath) - 1);
+    socketPath[sizeof(socketPath) - 1] = '\0';
+    port = 0;
+    return Connect();
+#endif
+}
+
+bool LeaderboardClient::OpenLoopback(uint16_t loopbackPort) {
+    socketPath[0] = '\0';
+    port = loopbackPort;
+    return Connect();
+}
+
+bool LeaderboardClient::Connect() {
+    Close();
+    intptr_t handle = -1;
+
+    if (port != 0) {
+        handle = OpenSocket(AF_INET);
+        if (handle < 0) return false;
+
+        sockaddr_in server;
+        std::memset(&server, 0, sizeof(server));
+        server.sin_family = AF_INET;
+        server.sin_port = htons(port);
+        server.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (connect((NativeSocket)handle, reinterpret_cast<sockaddr*>(&server), sizeof(server)) != 0) {
+            CloseSocket(handle);
+            return false;
+        }
+    } else {
+#if defined(_WIN32)
+        return false;
+#else
+        if (socketPath[0] == '\0') return false;
+        handle = OpenSocket(AF_UNIX);
+        if (handle < 0) return false;
+
+        // Bind to an autogenerated address so the server has somewhere to reply
+        sockaddr_un local;
+        std::memset(&local, 0, sizeof(local));
+        local.sun_family = AF_UNIX;
+#if defined(__linux__)
+        bind((NativeSocket)handle, reinterpret_cast<sockaddr*>(&local), sizeof(sa_family_t));
+#endif
+
+        sockaddr_un server;
+        std::memset(&server, 0, sizeof(server));
+        server.sun_family = AF_UNIX;
+        std::snprintf(server.sun_path, sizeof(server.sun_path), "%s", socketPath);
+        if (connect((NativeSocket)handle, reinterpret_cast<sockaddr*>(&server), sizeof(server)) != 0) {
+            CloseSocket(handle);
+            return false;
+        }
+#endif
+    }
+
+    ConfigureSocket(handle, QUERY_TIMEOUT_MS, SEND_BUFFER_BYTES);
+    fd = handle;
+    return true;
+}
+
+void LeaderboardClient::Close() {
+    if (fd < 0) return;
+    CloseSocket(fd);
+    fd = -1;
+}
+
+bool LeaderboardClient::Send(const void* data, size_t size, bool wait) {
+    if (fd >= 0) {
+        if (SendAll(fd, data, size, wait)) return true;
+        if (!ShouldReconnect()) return false;
+    }
+    return Connect() && SendAll(fd, data, size, wait);
+}
+
+// Player and score travel inside the replay, where the service reads them
+bool LeaderboardClient::Submit(const uint8_t* replay, size_t bytes) {
+    if (bytes > LEADERBOARD_MAX_REPLAY_BYTES) return false;
+
+    LeaderboardRequest request;
+    std::memset(&request, 0, sizeof(request));
+    request.magic = LEADERBOARD_MAGIC;
+    request.op = LEADERBOARD_SUBMIT;
+    request.count = (uint32_t)bytes;
+
+    const uint8_t* raw = reinterpret_cast<const uint8_t*>(&request);
+    submission.assign(raw, raw + sizeof(request));
+    submission.insert(submission.end(), replay, replay + bytes);
+    return Send(submission.data(), submission.size(), false);
+}
+
+// Replies to queries that already timed out may still be queued on the
+// socket; they carry an older id and are read past until ours arrives
+bool LeaderboardClient::Query(LeaderboardRequest& request, LeaderboardReply& reply) {
+    request.id = ++lastRequestId;
+    if (!Send(&request, sizeof(request), true)) return false;
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(QUERY_TIMEOUT_MS);
+    do {
+        long received = Receive(fd, &reply, sizeof(reply));
+        if (received < 0) return false;
+        if (received >= (long)offsetof(LeaderboardReply, entries) && reply.magic == LEADERBOARD_MAGIC &&
+            reply.id == request.id) {
+            return true;
+        }
+    } while (std::chrono::steady_clock::now() < deadline);
+    return false;
+}
+
+int LeaderboardClient::Top(LeaderboardEntry* out, int count) {
+    LeaderboardRequest request;
+    std::memset(&request, 0, sizeof(request));
+    request.magic = LEADERBOARD_MAGIC;
+    request.op = LEADERBOARD_TOP;
+    request.count = (uint32_t)(count < LEADERBOARD_MAX_TOP ? count : LEADERBOARD_MAX_TOP);
+
+    LeaderboardReply reply;
+    if (!Query(request, reply)) return -1;
+
+    int found = (int)(reply.count < request.count ? reply.count : request.count);
+    std::memcpy(out, reply.entries, found * sizeof(LeaderboardEntry));
+    return found;
+}
+
+uint32_t LeaderboardClient::Rank(int score, uint32_t* total) {
+    LeaderboardRequest request;
+    std::memset(&request, 0, sizeof(request));
+    request.magic = LEADERBOARD_MAGIC;
+    request.op = LEADERBOARD_RANK;
+    request.score = score;
+
+    LeaderboardReply reply;
+    if (!Query(request, reply)) return 0;
+    if (total) *total = reply.total;
+    return reply.rank;
+}
@@ -0,0 +1,128 @@
+#include "PerfCounters.h"
+#include <atomic>
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+static int OpenCounter(uint64_t config, int groupFd) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = groupFd == -1 ? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0);
+}
+#endif
+
+PerfCounters::PerfCounters() : available(false) {
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        fds[i] = -1;
+    }
+
+#if defined(__linux__)
+    static const uint64_t CONFIGS[PERF_COUNTER_COUNT] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+    };
+
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        fds[i] = OpenCounter(CONFIGS[i], i == 0 ? -1 : fds[0]);
+        if (fds[i] < 0) return;
+    }
+    ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    available = true;
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#if defined(__linux__)
+    for (int i = PERF_COUNTER_COUNT - 1; i >= 0; i--) {
+        if (fds[i] >= 0) close(fds[i]);
+    }
+#endif
+}
+
+PerfCounters& PerfCounters::ForThread() {
+    static thread_local PerfCounters counters;
+    return counters;
+}
+
+PerfSample PerfCounters::Read() const {
+    PerfSample sample;
+    std::memset(&sample, 0, sizeof(sample));
+
+#if defined(__linux__)
+    if (!available) return sample;
+
+    // nr, time_enabled, time_running, then one value per counter
+    uint64_t data[3 + PERF_COUNTER_COUNT];
+    if (read(fds[0], data, sizeof(data)) != (ssize_t)sizeof(data)) return sample;
+
+    double scale = data[2] > 0 && data[2] < data[1] ? (double)data[1] / data[2] : 1.0;
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        sample.values[i] = (uint64_t)(data[3 + i] * scale);
+    }
+#endif
+    return sample;
+}
+
+void PerfCounters::PrintPer(FILE* out, const PerfSample& delta, uint64_t count, const char* unit) {
+    double per = count ? 1.0 / count : 0.0;
+    fprintf(out, "IPC %.2f  cycles/%s %.1f  cache-miss/%s %.3f  branch-miss/%s %.3f",
+            delta.Ipc(), unit, delta.values[PERF_CYCLES] * per,
+            unit, delta.values[PERF_CACHE_MISSES] * per, unit, delta.values[PERF_BRANCH_MISSES] * per);
+}
+
+#ifdef SNAKE_PERF_COUNTERS
+
+// Relaxed atomic adds: worker threads record into the same totals
+struct PerfRegionStats {
+    std::atomic<uint64_t> calls;
+    std::atomic<uint64_t> total[PERF_COUNTER_COUNT];
+};
+
+static PerfRegionStats regionStats[PERF_REGION_COUNT];
+
+static const char* const REGION_NAMES[PERF_REGION_COUNT] = {
+    "Snake::Move", "CheckSelfCollision", "Food::Spawn", "Render",
+    "Simulation::Step", "BatchSimulation::Step", "VecEnv::StepRange"
+};
+
+void PerfRegions::Record(PerfRegionId id, const PerfSample& delta) {
+    regionStats[id].calls.fetch_add(1, std::memory_order_relaxed);
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        regionStats[id].total[i].fetch_add(delta.values[i], std::memory_order_relaxed);
+    }
+}
+
+void PerfRegions::Report(FILE* out) {
+    if (!PerfCounters::ForThread().IsAvailable()) {
+        fprintf(out, "perf counters unavailable\n");
+        return;
+    }
+    for (int i = 0; i < PERF_REGION_COUNT; i++) {
+        uint64_t calls = regionStats[i].calls.load(std::memory_order_relaxed);
+        if (calls == 0) continue;
+
+        PerfSample total;
+        for (int k = 0; k < PERF_COUNTER_COUNT; k++) {
+            total.values[k] = regionStats[i].total[k].load(std::memory_order_relaxed);
+        }
+        fprintf(out, "%-22s %10llu calls  ", REGION_NAMES[i], (unsigned long long)calls);
+        PerfCounters::PrintPer(out, total, calls, "call");
+        fprintf(out, "\n");
+    }
+}
+
+#endif
@@ -1,12 +1,19 @@
 #include "PowerUp.h"
+#include "AllocProfiler.h"
+#include "FrameProfiler.h"
+#include "Tracer.h"
+#include <algorithm>
 #include <cstdlib>
 #include <cmath>
 
-PowerUp::PowerUp(int cellSize, int screenWidth, int screenHeight) 
-    : cellSize(cellSize), isActive(false), spawnTimer(0.0f), spawnInterval(10.0f) {
+PowerUp::PowerUp(int cellSize, int screenWidth, int screenHeight, std::pmr::memory_resource* memory)
+    : cellSize(cellSize), isActive(false), spawnTimer(0.0f), spawnInterval(10.0f),
+      activePowerUps(memory), validPositions(memory) {
     
     gridWidth = screenWidth / cellSize;
     gridHeight = screenHeight / cellSize;
+    validPositions.reserve(gridWidth * gridHeight);
+    activePowerUps.reserve(POWERUP_TYPE_COUNT * 2);
     
     position = {0, 0};
     type = SPEED_BOOST;
@@ -14,29 +21,23 @@ PowerUp::PowerUp(int cellSize, int screenWidth, int screenHeight)
 }
 
 void PowerUp::Update(float deltaTime) {
+    PROFILE_ALLOCS(ALLOC_POWERUP);
     if (!isActive) {
         spawnTimer += deltaTime;
         return;
     }
     
-    std::priority_queue<ActivePowerUp> updatedQueue;
-    
-    while (!activePowerUps.empty()) {
-        ActivePowerUp current = activePowerUps.top();
-        activePowerUps.pop();
-        
+    for (ActivePowerUp& current : activePowerUps) {
         current.remainingTime -= deltaTime;
-        
-        if (current.remainingTime > 0) {
-            updatedQueue.push(current);
-        }
     }
     
-    activePowerUps = updatedQueue;
+    while (!activePowerUps.empty() && activePowerUps.back().remainingTime <= 0) {
+        activePowerUps.pop_back();
+    }
 }
 
-std::vector<Vector2> PowerUp::GetValidPositions(const std::deque<Vector2>& snakeBody) {
-    std::vector<Vector2> validPositions;
+const std::pmr::vector<Vector2>& PowerUp::GetValidPositions(const SnakeBody& snakeBody) {
+    validPositions.clear();
     
     for (int x = 0; x < gridWidth; x++) {
         for (int y = 0; y < gridHeight; y++) {
@@ -59,10 +60,13 @@ std::vector<Vector2> PowerUp::GetValidPositions(const std::deque<Vector2>& snake
     return validPositions;
 }
 
-void PowerUp::Spawn(const std::deque<Vector2>& snakeBody) {
+void PowerUp::Spawn(const SnakeBody& snakeBody) {
+    PROFILE_SCOPE(PROFILE_SPAWN);
+    PROFILE_ALLOCS(ALLOC_POWERUP);
     if (spawnTimer < spawnInterval) return;
     
-    std::vector<Vector2> validPositions = GetValidPositions(snakeBody);
+    TRACE_SCOPE("PowerUp::Spawn");
+    GetValidPositions(snakeBody);
     
     if (!validPositions.empty()) {
         int randomIndex = std::rand() % validPositions.size();
@@ -77,6 +81,7 @@ void PowerUp::Spawn(const std::deque<Vector2>& snakeBody) {
 }
 
 void PowerUp::Collect(PowerUpType type, float duration) {
+    PROFILE_ALLOCS(ALLOC_POWERUP);
     isActive = false;
     spawnTimer = 0.0f;
     
@@ -84,30 +89,47 @@ void PowerUp::Collect(PowerUpType type, float duration) {
     newPowerUp.type = type;
     newPowerUp.remainingTime = duration;
     
-    activePowerUps.push(newPowerUp);
+    // operator< ranks longer timers first, so this keeps the soonest at the back
+    activePowerUps.insert(std::upper_bound(activePowerUps.begin(), activePowerUps.end(), newPowerUp),
+                          newPowerUp);
+}
+
+void PowerUp::SaveState(PowerUpState& state) const {
+    state.position = position;
+    state.type = type;
+    state.isActive = isActive;
+    state.spawnTimer = spawnTimer;
+    state.activeCount = std::min((int)activePowerUps.size(), POWERUP_STATE_MAX_ACTIVE);
+    std::copy(activePowerUps.begin(), activePowerUps.begin() + state.activeCount, state.active);
+}
+
+// Stays within the capacity reserved up front, so it never allocates
+void PowerUp::RestoreState(const PowerUpState& state) {
+    PROFILE_ALLOCS(ALLOC_POWERUP);
+    position = state.position;
+    type = state.type;
+    powerUpColor = GetPowerUpColor(type);
+    isActive = state.isActive;
+    spawnTimer = state.spawnTimer;
+    activePowerUps.assign(state.active, state.active + state.activeCount);
 }
 
 bool PowerUp::HasActivePowerUp(PowerUpType type) const {
-    std::priority_queue<ActivePowerUp> tempQueue = activePowerUps;
-    
-    while (!tempQueue.empty()) {
-        if (tempQueue.top().type == type) {
+    PROFILE_ALLOCS(ALLOC_POWERUP);
+    for (const ActivePowerUp& current : activePowerUps) {
+        if (current.type == type) {
             return true;
         }
-        tempQueue.pop();
     }
     
     return false;
 }
 
 float PowerUp::GetPowerUpTimeRemaining(PowerUpType type) const {
-    std::priority_queue<ActivePowerUp> tempQueue = activePowerUps;
-    
-    while (!tempQueue.empty()) {
-        if (tempQueue.top().type == type) {
-            return tempQueue.top().remainingTime;
+    for (auto it = activePowerUps.rbegin(); it != activePowerUps.rend(); ++it) {
+        if (it->type == type) {
+            return it->remainingTime;
         }
-        tempQueue.pop();
     }
     
     return 0.0f;
@@ -132,6 +154,8 @@ const char* PowerUp::GetPowerUpName(PowerUpType type) const {
 }
 
 void PowerUp::Draw() const {
+    PROFILE_SCOPE(PROFILE_DRAW_POWERUP);
+    PROFILE_ALLOCS(ALLOC_POWERUP);
     if (!isActive) return;
     
     static float pulse = 0.0f;
@@ -155,14 +179,13 @@ void PowerUp::Draw() const {
 }
 
 void PowerUp::DrawActivePowerUps(int screenHeight) const {
-    std::priority_queue<ActivePowerUp> tempQueue = activePowerUps;
-    
+    PROFILE_SCOPE(PROFILE_DRAW_ACTIVE_POWERUPS);
+    PROFILE_ALLOCS(ALLOC_POWERUP);
     int yOffset = screenHeight - 80;
     int index = 0;
     
-    while (!tempQueue.empty()) {
-        ActivePowerUp current = tempQueue.top();
-        tempQueue.pop();
+    for (auto it = activePowerUps.rbegin(); it != activePowerUps.rend(); ++it) {
+        const ActivePowerUp& current = *it;
         
         Color color = GetPowerUpColor(current.type);
         const char* name = GetPowerUpName(current.type);
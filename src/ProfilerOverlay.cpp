@@ -0,0 +1,77 @@
+#include "ProfilerOverlay.h"
+
+ProfilerOverlay::ProfilerOverlay()
+    : batch(), batchLoaded(false), visible(false), drawCalls(0), vertices(0) {}
+
+void ProfilerOverlay::Initialize() {
+    batch = rlLoadRenderBatch(1, RL_DEFAULT_BATCH_BUFFER_ELEMENTS);
+    rlSetRenderBatchActive(&batch);
+    batchLoaded = true;
+}
+
+void ProfilerOverlay::Shutdown() {
+    if (!batchLoaded) return;
+    rlSetRenderBatchActive(nullptr);
+    rlUnloadRenderBatch(batch);
+    batchLoaded = false;
+}
+
+void ProfilerOverlay::Toggle() {
+    visible = !visible;
+    FrameProfiler::Get().SetEnabled(visible);
+}
+
+// Only sees draws since the batch was last flushed; a 2D frame is flushed
+// once, by EndDrawing(), unless it overflows the batch
+void ProfilerOverlay::CaptureBatchStats() {
+    drawCalls = 0;
+    vertices = 0;
+    if (!batchLoaded) return;
+
+    for (int i = 0; i < batch.drawCounter; i++) {
+        if (batch.draws[i].vertexCount > 0) {
+            drawCalls++;
+            vertices += batch.draws[i].vertexCount;
+        }
+    }
+}
+
+void ProfilerOverlay::Draw(int screenWidth) const {
+    if (!visible) return;
+
+    const FrameProfiler& profiler = FrameProfiler::Get();
+    const int rowHeight = 28;
+    const int graphWidth = FrameProfiler::HISTORY;
+    const int panelWidth = 340;
+    const int x = screenWidth - panelWidth - 10;
+    const int y = 70;
+
+    DrawRectangle(x, y, panelWidth, 40 + PROFILE_SECTION_COUNT * rowHeight, Fade(BLACK, 0.75f));
+    DrawText(TextFormat("Draw calls: %d  Vertices: %d", drawCalls, vertices), x + 8, y + 6, 14, WHITE);
+    DrawText(TextFormat("FPS: %d  Dropped samples: %u", GetFPS(), profiler.GetDroppedSamples()),
+             x + 8, y + 22, 12, LIGHTGRAY);
+
+    for (int s = 0; s < PROFILE_SECTION_COUNT; s++) {
+        ProfileSection section = static_cast<ProfileSection>(s);
+        int rowY = y + 40 + s * rowHeight;
+        int graphX = x + panelWidth - graphWidth - 8;
+
+        DrawText(profiler.GetSectionName(section), x + 8, rowY + 2, 12, LIGHTGRAY);
+        DrawText(TextFormat("%.1f us  avg %.1f", profiler.GetLatest(section), profiler.GetAverage(section)),
+                 x + 8, rowY + 14, 10, GRAY);
+
+        float peak = 1.0f;
+        for (int i = 0; i < graphWidth; i++) {
+            float sample = profiler.GetSample(section, i);
+            if (sample > peak) peak = sample;
+        }
+
+        Vector2 points[FrameProfiler::HISTORY];
+        for (int i = 0; i < graphWidth; i++) {
+            float height = profiler.GetSample(section, i) / peak * (rowHeight - 6);
+            points[i] = {(float)(graphX + i), (float)(rowY + rowHeight - 3) - height};
+        }
+        DrawRectangleLines(graphX, rowY + 2, graphWidth, rowHeight - 4, Fade(DARKGRAY, 0.6f));
+        DrawLineStrip(points, graphWidth, LIME);
+    }
+}
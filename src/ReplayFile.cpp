@@ -0,0 +1,212 @@
+#include "ReplayFile.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+ReplayReader::ReplayReader() : data(nullptr), size(0), header(nullptr), index(nullptr), mapped(false) {
+#if defined(_WIN32)
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+#else
+    fd = -1;
+#endif
+}
+
+ReplayReader::~ReplayReader() {
+    Close();
+}
+
+bool ReplayReader::Open(const char* path) {
+    Close();
+    if (!Map(path)) return false;
+    mapped = true;
+
+    if (!Validate()) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+bool ReplayReader::Open(const uint8_t* bytes, size_t byteCount) {
+    Close();
+    if (!bytes || reinterpret_cast<uintptr_t>(bytes) % 8 != 0) return false;
+    data = bytes;
+    size = byteCount;
+
+    if (!Validate()) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void ReplayReader::Close() {
+    if (!data) return;
+    if (mapped) Unmap();
+    mapped = false;
+    data = nullptr;
+    size = 0;
+    header = nullptr;
+    index = nullptr;
+}
+
+// Everything a player will later touch must lie inside the mapping
+bool ReplayReader::Validate() {
+    if (size < sizeof(ReplayFileHeader)) return false;
+    const ReplayFileHeader* candidate = reinterpret_cast<const ReplayFileHeader*>(data);
+    if (candidate->magic != REPLAY_FILE_MAGIC || candidate->version != REPLAY_FILE_VERSION) return false;
+    if (candidate->keyframeInterval == 0 || candidate->keyframeInterval > REPLAY_MAX_KEYFRAME_INTERVAL ||
+        candidate->keyframeCount == 0) {
+        return false;
+    }
+    // The writer keyframes every interval while the game runs, so a longer
+    // recording than that is corrupt
+    if (candidate->tickCount > REPLAY_MAX_TICKS ||
+        candidate->tickCount > (uint64_t)candidate->keyframeCount * candidate->keyframeInterval) {
+        return false;
+    }
+    if (candidate->player[REPLAY_PLAYER_LENGTH - 1] != '\0') return false;
+    if (candidate->boardWidth < 1 || candidate->boardWidth > REPLAY_MAX_BOARD_SIDE ||
+        candidate->boardHeight < 1 || candidate->boardHeight > REPLAY_MAX_BOARD_SIDE) {
+        return false;
+    }
+
+    if (candidate->inputOffset > size || candidate->inputBytes > size - candidate->inputOffset) return false;
+    uint64_t indexBytes = (uint64_t)candidate->keyframeCount * sizeof(ReplayIndexEntry);
+    if (candidate->indexOffset % 8 != 0 || candidate->indexOffset > size ||
+        indexBytes > size - candidate->indexOffset) {
+        return false;
+    }
+
+    // Keyframes are written one after another, so each entry owns distinct
+    // bytes and the keyframe count (and with it the ticks) grows with the file
+    const ReplayIndexEntry* entries = reinterpret_cast<const ReplayIndexEntry*>(data + candidate->indexOffset);
+    uint64_t keyframeEnd = sizeof(ReplayFileHeader);
+    for (uint32_t i = 0; i < candidate->keyframeCount; i++) {
+        const ReplayIndexEntry& entry = entries[i];
+        if (entry.tick != (uint64_t)i * candidate->keyframeInterval ||
+            entry.keyframeOffset < keyframeEnd || entry.keyframeBytes < sizeof(SimulationKeyframe) ||
+            entry.keyframeOffset > size || entry.keyframeBytes > size - entry.keyframeOffset ||
+            entry.inputOffset > candidate->inputBytes) {
+            return false;
+        }
+        keyframeEnd = entry.keyframeOffset + entry.keyframeBytes;
+    }
+
+    header = candidate;
+    index = entries;
+    return true;
+}
+
+const ReplayIndexEntry& ReplayReader::FindKeyframe(uint64_t tick) const {
+    uint64_t slot = tick / header->keyframeInterval;
+    return index[slot < header->keyframeCount ? slot : header->keyframeCount - 1];
+}
+
+bool ReplayReader::ReadReplay(Replay& replay) const {
+    replay.seed = header->seed;
+    replay.score = header->score;
+    replay.stateHash = header->stateHash;
+    std::memcpy(replay.player, header->player, sizeof(replay.player));
+    replay.player[REPLAY_PLAYER_LENGTH - 1] = '\0';
+    replay.actions.resize(header->tickCount);
+
+    // Each action runs until the next change, so every tick is written once
+    uint8_t* actions = replay.actions.data();
+    const uint8_t* cursor = GetInputBegin();
+    const uint8_t* end = GetInputEnd();
+    uint64_t changeTick = 0;
+    uint8_t action = RIGHT;
+    uint64_t value;
+    while (cursor < end) {
+        if (!ReadVarint(cursor, end, value)) return false;
+        uint64_t delta = value >> 2;
+        if (delta >= header->tickCount - changeTick) return false;
+        std::memset(actions + changeTick, action, delta);
+        changeTick += delta;
+        action = (uint8_t)(value & 3);
+    }
+    std::memset(actions + changeTick, action, header->tickCount - changeTick);
+    return true;
+}
+
+#if defined(_WIN32)
+
+bool ReplayReader::Map(const char* path) {
+    HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(handle, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(handle);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        CloseHandle(handle);
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(handle);
+        return false;
+    }
+
+    fileHandle = handle;
+    mappingHandle = mapping;
+    data = static_cast<const uint8_t*>(view);
+    size = (size_t)fileSize.QuadPart;
+    return true;
+}
+
+void ReplayReader::Unmap() {
+    UnmapViewOfFile(data);
+    CloseHandle((HANDLE)mappingHandle);
+    CloseHandle((HANDLE)fileHandle);
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+}
+
+#else
+
+bool ReplayReader::Map(const char* path) {
+    int handle = open(path, O_RDONLY);
+    if (handle < 0) return false;
+
+    struct stat info;
+    if (fstat(handle, &info) != 0 || info.st_size == 0) {
+        close(handle);
+        return false;
+    }
+
+    void* view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, handle, 0);
+    if (view == MAP_FAILED) {
+        close(handle);
+        return false;
+    }
+
+    fd = handle;
+    data = static_cast<const uint8_t*>(view);
+    size = (size_t)info.st_size;
+    return true;
+}
+
+void ReplayReader::Unmap() {
+    munmap(const_cast<uint8_t*>(data), size);
+    close(fd);
+    fd = -1;
+}
+
+#endif
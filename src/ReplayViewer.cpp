@@ -0,0 +1,234 @@
+#include "ReplayViewer.h"
+#include "Tracer.h"
+#include <algorithm>
+
+static const float BASE_TICK_SECONDS = 0.15f;  // Game's base move interval
+static const int SPEEDS[] = {1, 2, 5, 10, 25, 50, 100, 250, 500, 1000};
+static const int SPEED_COUNT = sizeof(SPEEDS) / sizeof(SPEEDS[0]);
+static const int HUD_HEIGHT = 60;
+
+ReplayViewer::ReplayViewer(int width, int height, const char* title)
+    : screenWidth(width), screenHeight(height), cellSize(1), boardArea{0, 0, 0, 0},
+      boardTexture{}, gridTexture{}, texturesLoaded(false), boardDirty(true),
+      speedIndex(0), paused(false), dragging(false), ticksOwed(0.0) {
+    InitWindow(screenWidth, screenHeight, title);
+    SetTargetFPS(60);
+}
+
+ReplayViewer::~ReplayViewer() {
+    UnloadTextures();
+    CloseWindow();
+}
+
+bool ReplayViewer::Load(const char* path) {
+    player.reset();
+    UnloadTextures();
+    if (!reader.Open(path)) return false;
+
+    // Replays from any board size play on a runtime-sized board; the
+    // reader has already bounded it by REPLAY_MAX_BOARD_SIDE
+    const ReplayFileHeader& header = reader.GetHeader();
+    player.reset(new Player(reader, RuntimeSimulation(1, DynamicBoard(header.boardWidth, header.boardHeight))));
+    if (!player->Seek(0)) {
+        player.reset();
+        return false;
+    }
+
+    LoadTextures(header.boardWidth, header.boardHeight);
+    ticksOwed = 0.0;
+    paused = false;
+    return true;
+}
+
+void ReplayViewer::LoadTextures(int boardWidth, int boardHeight) {
+    // Whole pixels per cell where the board fits, shrunk to fit where it does not
+    float scale = std::min((float)screenWidth / boardWidth, (float)(screenHeight - HUD_HEIGHT) / boardHeight);
+    if (scale >= 1.0f) scale = (float)(int)scale;
+    cellSize = (int)scale;
+    float width = boardWidth * scale;
+    float height = boardHeight * scale;
+    boardArea = {(screenWidth - width) / 2, (float)HUD_HEIGHT + (screenHeight - HUD_HEIGHT - height) / 2,
+                 width, height};
+
+    pixels.assign((size_t)boardWidth * boardHeight, BLANK);
+    Image image = GenImageColor(boardWidth, boardHeight, BLANK);
+    boardTexture = LoadTextureFromImage(image);
+    UnloadImage(image);
+    SetTextureFilter(boardTexture, TEXTURE_FILTER_POINT);
+
+    // Lines closer than 4 px would only grey out the board
+    gridTexture = LoadRenderTexture((int)width, (int)height);
+    BeginTextureMode(gridTexture);
+    ClearBackground(BLANK);
+    if (cellSize >= 4) {
+        for (int x = 0; x <= (int)width; x += cellSize) {
+            DrawLine(x, 0, x, (int)height, Fade(DARKGRAY, 0.3f));
+        }
+        for (int y = 0; y <= (int)height; y += cellSize) {
+            DrawLine(0, y, (int)width, y, Fade(DARKGRAY, 0.3f));
+        }
+    }
+    EndTextureMode();
+
+    texturesLoaded = true;
+    boardDirty = true;
+}
+
+void ReplayViewer::UnloadTextures() {
+    if (!texturesLoaded) return;
+    UnloadTexture(boardTexture);
+    UnloadRenderTexture(gridTexture);
+    texturesLoaded = false;
+}
+
+void ReplayViewer::Run() {
+    while (!WindowShouldClose()) {
+        TRACE_SCOPE("Frame");
+        HandleInput();
+        Update();
+        Draw();
+    }
+}
+
+Rectangle ReplayViewer::GetProgressBar() const {
+    return {10.0f, 40.0f, (float)screenWidth - 20.0f, 10.0f};
+}
+
+void ReplayViewer::Seek(uint64_t tick) {
+    player->Seek(tick);
+    ticksOwed = 0.0;
+    boardDirty = true;
+}
+
+void ReplayViewer::HandleInput() {
+    if (!player) return;
+
+    if (IsKeyPressed(KEY_SPACE)) {
+        paused = !paused;
+    }
+    if (IsKeyPressed(KEY_UP) || IsKeyPressed(KEY_W)) {
+        speedIndex = std::min(speedIndex + 1, SPEED_COUNT - 1);
+    }
+    if (IsKeyPressed(KEY_DOWN) || IsKeyPressed(KEY_S)) {
+        speedIndex = std::max(speedIndex - 1, 0);
+    }
+
+    // One keyframe interval per press: each jump is a keyframe load
+    // plus less than an interval of ticks
+    uint64_t interval = reader.GetHeader().keyframeInterval;
+    uint64_t tick = player->GetTick();
+    if (IsKeyPressed(KEY_RIGHT) || IsKeyPressed(KEY_D)) {
+        Seek(tick + interval);
+    }
+    if (IsKeyPressed(KEY_LEFT) || IsKeyPressed(KEY_A)) {
+        Seek(tick > interval ? tick - interval : 0);
+    }
+    if (IsKeyPressed(KEY_HOME)) {
+        Seek(0);
+    }
+
+    Rectangle bar = GetProgressBar();
+    Vector2 mouse = GetMousePosition();
+    if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) && CheckCollisionPointRec(mouse, bar)) {
+        dragging = true;
+    }
+    if (IsMouseButtonReleased(MOUSE_BUTTON_LEFT)) {
+        dragging = false;
+    }
+    if (dragging) {
+        float fraction = std::min(std::max((mouse.x - bar.x) / bar.width, 0.0f), 1.0f);
+        uint64_t target = (uint64_t)(fraction * (double)reader.GetTickCount());
+        if (target != player->GetTick()) Seek(target);
+    }
+}
+
+void ReplayViewer::Update() {
+    TRACE_SCOPE("Update");
+    if (!player || paused || dragging || player->AtEnd()) {
+        ticksOwed = 0.0;
+        return;
+    }
+
+    // A stalled frame must not turn into a burst of catch-up ticks
+    float deltaTime = std::min(GetFrameTime(), 0.1f);
+    ticksOwed += deltaTime / BASE_TICK_SECONDS * SPEEDS[speedIndex];
+
+    int steps = (int)ticksOwed;
+    ticksOwed -= steps;
+    for (int i = 0; i < steps && player->Step(); i++) {
+    }
+    boardDirty = boardDirty || steps > 0;
+}
+
+// Rebuilt from the simulation rather than patched per tick: a turbo frame
+// or a seek moves the snake arbitrarily far anyway
+void ReplayViewer::UpdateBoardTexture() {
+    if (!boardDirty) return;
+    TRACE_SCOPE("UpdateBoardTexture");
+
+    // Every cell id and the power-up type were range-checked when the
+    // keyframe was loaded, and stepping keeps them on the board
+    const RuntimeSimulation& sim = player->GetSimulation();
+    std::fill(pixels.begin(), pixels.end(), BLANK);
+    for (int i = sim.GetBodySize() - 1; i >= 0; i--) {
+        pixels[sim.GetBodyCell(i)] = i == 0 ? DARKGREEN : GREEN;
+    }
+    if (sim.GetFoodCell() >= 0) {
+        pixels[sim.GetFoodCell()] = RED;
+    }
+    if (sim.GetPowerUpCell() >= 0) {
+        static const Color POWERUP_COLORS[POWERUP_TYPE_COUNT] = {BLUE, GOLD, PURPLE};
+        pixels[sim.GetPowerUpCell()] = POWERUP_COLORS[sim.GetPowerUpType()];
+    }
+
+    UpdateTexture(boardTexture, pixels.data());
+    boardDirty = false;
+}
+
+void ReplayViewer::DrawHUD() const {
+    const ReplayFileHeader& header = reader.GetHeader();
+    const RuntimeSimulation& sim = player->GetSimulation();
+    uint64_t tick = player->GetTick();
+
+    DrawText(TextFormat("%s  Score: %d  Length: %d", header.player, sim.GetScore(), sim.GetLength()),
+             10, 10, 20, YELLOW);
+    DrawText(TextFormat("Tick %llu / %llu  %dx%s", (unsigned long long)tick,
+                        (unsigned long long)header.tickCount, SPEEDS[speedIndex], paused ? "  [PAUSED]" : ""),
+             screenWidth - 330, 10, 16, LIGHTGRAY);
+    DrawText("SPACE: Pause  W/S: Speed  A/D: Seek", screenWidth - 330, 26, 12, GRAY);
+
+    Rectangle bar = GetProgressBar();
+    float fraction = header.tickCount > 0 ? (float)((double)tick / header.tickCount) : 1.0f;
+    DrawRectangleRec(bar, Fade(DARKGRAY, 0.5f));
+    DrawRectangle((int)bar.x, (int)bar.y, (int)(bar.width * fraction), (int)bar.height, GREEN);
+
+    if (player->AtEnd()) {
+        const char* endText = sim.IsAlive() ? "END OF REPLAY" : "GAME OVER";
+        int textWidth = MeasureText(endText, 40);
+        DrawText(endText, screenWidth / 2 - textWidth / 2, screenHeight / 2 - 20, 40, RED);
+    }
+}
+
+void ReplayViewer::Draw() {
+    TRACE_SCOPE("Draw");
+    if (player) UpdateBoardTexture();
+
+    BeginDrawing();
+    ClearBackground(BLACK);
+
+    if (player) {
+        Rectangle source = {0, 0, (float)boardTexture.width, (float)boardTexture.height};
+        DrawTexturePro(boardTexture, source, boardArea, {0, 0}, 0.0f, WHITE);
+
+        // Render textures are stored upside down
+        Rectangle gridSource = {0, 0, (float)gridTexture.texture.width, -(float)gridTexture.texture.height};
+        DrawTextureRec(gridTexture.texture, gridSource, {boardArea.x, boardArea.y}, WHITE);
+        DrawRectangleLinesEx(boardArea, 1.0f, DARKGRAY);
+
+        DrawHUD();
+    } else {
+        DrawText("No replay loaded", 10, 10, 20, RED);
+    }
+
+    EndDrawing();
+}
@@ -0,0 +1,23 @@
+#include "RunLengthRenderer.h"
+#include <algorithm>
+#include <cstdlib>
+
+void DrawRunLengthSnake(const RunLengthSnake& snake, int cellSize, Color bodyColor, Color headColor) {
+    for (const auto& run : snake.GetRuns()) {
+        GridCell tail = run.start;
+        switch (run.direction) {
+            case UP:    tail.y += run.length - 1; break;
+            case DOWN:  tail.y -= run.length - 1; break;
+            case LEFT:  tail.x += run.length - 1; break;
+            case RIGHT: tail.x -= run.length - 1; break;
+        }
+        int x = std::min(run.start.x, tail.x);
+        int y = std::min(run.start.y, tail.y);
+        int w = std::abs(run.start.x - tail.x) + 1;
+        int h = std::abs(run.start.y - tail.y) + 1;
+        DrawRectangle(x * cellSize, y * cellSize, w * cellSize, h * cellSize, bodyColor);
+    }
+
+    GridCell head = snake.GetHeadCell();
+    DrawRectangle(head.x * cellSize, head.y * cellSize, cellSize, cellSize, headColor);
+}
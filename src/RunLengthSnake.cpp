@@ -0,0 +1,133 @@
+#include "RunLengthSnake.h"
+#include <algorithm>
+
+RunLengthSnake::RunLengthSnake(GridCell startCell)
+    : frontSerial(0), currentDirection(RIGHT), nextDirection(RIGHT), length(3), pendingGrowth(0), collided(false) {
+    runs.push_back({startCell, RIGHT, length});
+    Index(runs.front(), frontSerial);
+}
+
+GridCell RunLengthSnake::Step(GridCell cell, Direction dir, int count) {
+    switch (dir) {
+        case UP:    cell.y -= count; break;
+        case DOWN:  cell.y += count; break;
+        case LEFT:  cell.x -= count; break;
+        case RIGHT: cell.x += count; break;
+    }
+    return cell;
+}
+
+// Interval test: a run is a horizontal or vertical segment, so membership is
+// one equality plus one range check
+bool RunLengthSnake::RunContains(const BodyRun& run, GridCell cell) {
+    GridCell tail = Step(run.start, run.direction, -(run.length - 1));
+
+    if (run.direction == LEFT || run.direction == RIGHT) {
+        return cell.y == run.start.y &&
+               cell.x >= std::min(run.start.x, tail.x) &&
+               cell.x <= std::max(run.start.x, tail.x);
+    }
+    return cell.x == run.start.x &&
+           cell.y >= std::min(run.start.y, tail.y) &&
+           cell.y <= std::max(run.start.y, tail.y);
+}
+
+int RunLengthSnake::Low(const BodyRun& run) {
+    GridCell tail = Step(run.start, run.direction, -(run.length - 1));
+    return IsHorizontal(run.direction) ? std::min(run.start.x, tail.x) : std::min(run.start.y, tail.y);
+}
+
+void RunLengthSnake::Index(const BodyRun& run, int64_t serial) {
+    LineIndex& line = IsHorizontal(run.direction) ? rows[run.start.y] : columns[run.start.x];
+    line.emplace(Low(run), serial);
+}
+
+void RunLengthSnake::Unindex(const BodyRun& run, int64_t serial) {
+    std::unordered_map<int, LineIndex>& lines = IsHorizontal(run.direction) ? rows : columns;
+    auto found = lines.find(IsHorizontal(run.direction) ? run.start.y : run.start.x);
+    if (found == lines.end()) return;
+
+    auto range = found->second.equal_range(Low(run));
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == serial) {
+            found->second.erase(it);
+            break;
+        }
+    }
+    // Drop empty lines so the index stays proportional to the runs
+    if (found->second.empty()) lines.erase(found);
+}
+
+bool RunLengthSnake::LineOccupies(const std::unordered_map<int, LineIndex>& lines, int line, int position,
+                                  GridCell cell) const {
+    auto found = lines.find(line);
+    if (found == lines.end()) return false;
+
+    auto it = found->second.upper_bound(position);
+    if (it == found->second.begin()) return false;
+    --it;
+    return RunContains(runs[(size_t)(frontSerial - it->second)], cell);
+}
+
+void RunLengthSnake::SetDirection(Direction dir) {
+    if ((currentDirection == UP && dir == DOWN) ||
+        (currentDirection == DOWN && dir == UP) ||
+        (currentDirection == LEFT && dir == RIGHT) ||
+        (currentDirection == RIGHT && dir == LEFT)) {
+        return;
+    }
+    nextDirection = dir;
+}
+
+// Only the head and tail runs change: the tail run shrinks (and is dropped
+// when empty) and the head run extends (or a new run starts on a turn). A
+// run is re-keyed only when its lowest coordinate moves.
+void RunLengthSnake::Move() {
+    currentDirection = nextDirection;
+    GridCell newHead = Step(runs.front().start, currentDirection, 1);
+
+    // Vacate the tail first: the head may move into the cell it leaves
+    if (pendingGrowth > 0) {
+        pendingGrowth--;
+    } else {
+        BodyRun& tail = runs.back();
+        int64_t tailSerial = frontSerial - (int64_t)(runs.size() - 1);
+        bool rekey = tail.length == 1 || tail.direction == RIGHT || tail.direction == DOWN;
+        if (rekey) Unindex(tail, tailSerial);
+        tail.length--;
+        if (tail.length == 0) {
+            runs.pop_back();
+        } else if (rekey) {
+            Index(tail, tailSerial);
+        }
+    }
+
+    collided = Occupies(newHead);
+
+    BodyRun& head = runs.front();
+    if (head.direction == currentDirection) {
+        bool rekey = currentDirection == LEFT || currentDirection == UP;
+        if (rekey) Unindex(head, frontSerial);
+        head.start = newHead;
+        head.length++;
+        if (rekey) Index(head, frontSerial);
+    } else {
+        runs.push_front({newHead, currentDirection, 1});
+        frontSerial++;
+        Index(runs.front(), frontSerial);
+    }
+}
+
+void RunLengthSnake::Grow() {
+    pendingGrowth++;
+    length++;
+}
+
+bool RunLengthSnake::Occupies(GridCell cell) const {
+    return LineOccupies(rows, cell.y, cell.x, cell) || LineOccupies(columns, cell.x, cell.y, cell);
+}
+
+GridCell RunLengthSnake::GetTailCell() const {
+    const BodyRun& tail = runs.back();
+    return Step(tail.start, tail.direction, -(tail.length - 1));
+}
@@ -1,7 +1,10 @@
 #include "Snake.h"
+#include "AllocProfiler.h"
+#include "FrameProfiler.h"
+#include "PerfCounters.h"
 
-Snake::Snake(Vector2 startPosition, int size) 
-    : currentDirection(RIGHT), nextDirection(RIGHT), cellSize(size), snakeColor(GREEN) {
+Snake::Snake(Vector2 startPosition, int size, std::pmr::memory_resource* memory)
+    : body(memory), currentDirection(RIGHT), nextDirection(RIGHT), cellSize(size), snakeColor(GREEN) {
     body.push_back(startPosition);
     body.push_back({startPosition.x - cellSize, startPosition.y});
     body.push_back({startPosition.x - 2 * cellSize, startPosition.y});
@@ -18,6 +21,8 @@ void Snake::SetDirection(Direction dir) {
 }
 
 void Snake::Move() {
+    PROFILE_ALLOCS(ALLOC_SNAKE);
+    PERF_SCOPE(PERF_REGION_SNAKE_MOVE);
     currentDirection = nextDirection;
     Vector2 newHead = body.front();
     
@@ -33,11 +38,25 @@ void Snake::Move() {
 }
 
 void Snake::Grow() {
+    PROFILE_ALLOCS(ALLOC_SNAKE);
     Vector2 tail = body.back();
     body.push_back(tail);
 }
 
+void Snake::Unmove(Vector2 removedTail, Direction current, Direction next) {
+    PROFILE_ALLOCS(ALLOC_SNAKE);
+    body.pop_front();
+    body.push_back(removedTail);
+    currentDirection = current;
+    nextDirection = next;
+}
+
+void Snake::Shrink() {
+    body.pop_back();
+}
+
 bool Snake::CheckSelfCollision() const {
+    PERF_SCOPE(PERF_REGION_SELF_COLLISION);
     Vector2 head = body.front();
     for (size_t i = 1; i < body.size(); i++) {
         if (head.x == body[i].x && head.y == body[i].y) {
@@ -52,6 +71,8 @@ Vector2 Snake::GetHeadPosition() const {
 }
 
 void Snake::Draw() const {
+    PROFILE_SCOPE(PROFILE_DRAW_SNAKE);
+    PROFILE_ALLOCS(ALLOC_SNAKE);
     for (size_t i = 0; i < body.size(); i++) {
         Color segmentColor = (i == 0) ? DARKGREEN : snakeColor;
         DrawRectangle(body[i].x, body[i].y, cellSize, cellSize, segmentColor);
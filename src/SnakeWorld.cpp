@@ -0,0 +1,230 @@
+#include "SnakeWorld.h"
+
+SnakeWorld::SnakeWorld(int width, int height, int maxSnakes, int foodCount, uint64_t seed)
+    : board(width, height), snakes(maxSnakes), bodies((size_t)maxSnakes * WORLD_MAX_LENGTH),
+      occupancy(width * height, 0), foodAt(width * height, -1), claimTick(width * height, 0),
+      claimOwner(width * height, -1), foodCells(foodCount, -1), powerUpCell(-1),
+      powerUpType(SPEED_BOOST), powerUpSpawnTimer(0), tick(0), activeCount(0) {
+    rng.Seed(seed);
+    for (SnakeState& snake : snakes) {
+        snake = SnakeState();
+        snake.direction = RIGHT;
+        snake.nextDirection = RIGHT;
+        snake.target = -1;
+    }
+    for (int i = 0; i < foodCount; i++) {
+        foodCells[i] = RandomFreeCell();
+        if (foodCells[i] >= 0) foodAt[foodCells[i]] = (int16_t)i;
+    }
+}
+
+int& SnakeWorld::BodyAt(int id, int i) {
+    int index = snakes[id].headIndex + i;
+    if (index >= WORLD_MAX_LENGTH) index -= WORLD_MAX_LENGTH;
+    return bodies[(size_t)id * WORLD_MAX_LENGTH + index];
+}
+
+int SnakeWorld::GetBodyCell(int id, int i) const {
+    int index = snakes[id].headIndex + i;
+    if (index >= WORLD_MAX_LENGTH) index -= WORLD_MAX_LENGTH;
+    return bodies[(size_t)id * WORLD_MAX_LENGTH + index];
+}
+
+bool SnakeWorld::IsFree(int cell) const {
+    return occupancy[cell] == 0 && foodAt[cell] < 0 && cell != powerUpCell;
+}
+
+// Rejection sampling only: a shared board that is too crowded to place
+// something just tries again on the next tick
+int SnakeWorld::RandomFreeCell() {
+    int cells = board.Cells();
+    for (int attempt = 0; attempt < 32; attempt++) {
+        int cell = (int)RandomBelow(rng.Next(), (uint32_t)cells);
+        if (IsFree(cell)) return cell;
+    }
+    return -1;
+}
+
+void SnakeWorld::PushHead(int id, int cell) {
+    SnakeState& snake = snakes[id];
+    snake.headIndex = snake.headIndex == 0 ? WORLD_MAX_LENGTH - 1 : snake.headIndex - 1;
+    snake.length++;
+    BodyAt(id, 0) = cell;
+    occupancy[cell]++;
+}
+
+void SnakeWorld::PopTail(int id) {
+    SnakeState& snake = snakes[id];
+    int tail = BodyAt(id, snake.length - 1);
+    snake.length--;
+    occupancy[tail]--;
+}
+
+// Same layout as Game: three cells heading right
+bool SnakeWorld::TrySpawn(int id) {
+    int width = board.Width();
+    for (int attempt = 0; attempt < 32; attempt++) {
+        int head = (int)RandomBelow(rng.Next(), (uint32_t)board.Cells());
+        // Room to the right too, so the first move is not straight into something
+        int x = board.X(head);
+        if (x < WORLD_SPAWN_LENGTH - 1 || x >= width - 2) continue;
+
+        bool clear = true;
+        for (int i = -1; i < WORLD_SPAWN_LENGTH && clear; i++) {
+            clear = IsFree(head - i);
+        }
+        if (!clear) continue;
+
+        SnakeState& snake = snakes[id];
+        snake.headIndex = 0;
+        snake.length = 0;
+        snake.pendingGrowth = 0;
+        snake.score = 0;
+        snake.direction = RIGHT;
+        snake.nextDirection = RIGHT;
+        snake.alive = true;
+        snake.spawned = true;
+        for (int i = 0; i < POWERUP_TYPE_COUNT; i++) snake.activeTicks[i] = 0;
+        for (int i = WORLD_SPAWN_LENGTH - 1; i >= 0; i--) {
+            PushHead(id, head - i);
+        }
+        return true;
+    }
+    return false;
+}
+
+void SnakeWorld::Kill(int id) {
+    SnakeState& snake = snakes[id];
+    while (snake.length > 0) {
+        PopTail(id);
+    }
+    snake.alive = false;
+    snake.respawnTimer = RESPAWN_TICKS;
+}
+
+int SnakeWorld::AddSnake() {
+    for (int id = 0; id < (int)snakes.size(); id++) {
+        if (snakes[id].active) continue;
+        snakes[id].active = true;
+        snakes[id].alive = false;
+        snakes[id].length = 0;
+        snakes[id].score = 0;
+        snakes[id].respawnTimer = 0;  // enters on the next Step()
+        activeCount++;
+        return id;
+    }
+    return -1;
+}
+
+void SnakeWorld::RemoveSnake(int id) {
+    if (!snakes[id].active) return;
+    Kill(id);
+    snakes[id].active = false;
+    activeCount--;
+}
+
+void SnakeWorld::SetDirection(int id, Direction dir) {
+    SnakeState& snake = snakes[id];
+    if ((snake.direction ^ dir) == 1) return;  // UP/DOWN and LEFT/RIGHT differ in bit 0 only
+    snake.nextDirection = dir;
+}
+
+void SnakeWorld::Step() {
+    tick++;
+    uint32_t stamp = (uint32_t)tick;
+    int count = (int)snakes.size();
+
+    // Targets first, and every tail leaves before any head arrives
+    for (int id = 0; id < count; id++) {
+        SnakeState& snake = snakes[id];
+        snake.spawned = false;
+        if (!snake.alive) continue;
+
+        snake.direction = snake.nextDirection;
+        bool invincible = snake.activeTicks[INVINCIBILITY] > 0;
+        snake.target = Walls::Next(board, BodyAt(id, 0), snake.direction, invincible);
+        snake.nextDirection = snake.direction;
+
+        if (snake.pendingGrowth > 0 && snake.length < WORLD_MAX_LENGTH) {
+            snake.pendingGrowth--;
+        } else {
+            PopTail(id);
+        }
+    }
+
+    // Two heads in one cell: both die (invincible ones survive)
+    for (int id = 0; id < count; id++) {
+        SnakeState& snake = snakes[id];
+        if (!snake.alive || snake.target < 0) continue;
+
+        int cell = snake.target;
+        if (claimTick[cell] == stamp) {
+            int other = claimOwner[cell];
+            if (snakes[other].activeTicks[INVINCIBILITY] == 0) snakes[other].target = -1;
+            if (snake.activeTicks[INVINCIBILITY] == 0) snake.target = -1;
+        } else {
+            claimTick[cell] = stamp;
+            claimOwner[cell] = id;
+        }
+    }
+
+    for (int id = 0; id < count; id++) {
+        SnakeState& snake = snakes[id];
+        if (!snake.alive) continue;
+
+        bool invincible = snake.activeTicks[INVINCIBILITY] > 0;
+        if (snake.target < 0 || (occupancy[snake.target] > 0 && !invincible)) {
+            snake.target = -1;
+        }
+    }
+
+    for (int id = 0; id < count; id++) {
+        SnakeState& snake = snakes[id];
+        if (!snake.alive) continue;
+        if (snake.target < 0) {
+            Kill(id);
+            continue;
+        }
+
+        int next = snake.target;
+        PushHead(id, next);
+
+        for (int i = 0; i < POWERUP_TYPE_COUNT; i++) {
+            snake.activeTicks[i] -= snake.activeTicks[i] > 0;
+        }
+        bool boosted = snake.activeTicks[SCORE_MULTIPLIER] > 0;
+
+        int food = foodAt[next];
+        if (food >= 0) {
+            snake.pendingGrowth += ClassicRules::Growth::AMOUNT;
+            snake.score += ClassicRules::Scoring::Points(boosted);
+            foodAt[next] = -1;
+            foodCells[food] = -1;
+        }
+
+        if (next == powerUpCell) {
+            snake.activeTicks[powerUpType] = POWERUP_DURATION_TICKS;
+            powerUpCell = -1;
+            powerUpSpawnTimer = 0;
+        }
+    }
+
+    for (int id = 0; id < count; id++) {
+        SnakeState& snake = snakes[id];
+        if (snake.active && !snake.alive && --snake.respawnTimer <= 0) {
+            TrySpawn(id);
+        }
+    }
+
+    for (int i = 0; i < (int)foodCells.size(); i++) {
+        if (foodCells[i] >= 0) continue;
+        foodCells[i] = RandomFreeCell();
+        if (foodCells[i] >= 0) foodAt[foodCells[i]] = (int16_t)i;
+    }
+
+    if (powerUpCell < 0 && ++powerUpSpawnTimer >= POWERUP_SPAWN_TICKS) {
+        powerUpCell = RandomFreeCell();
+        powerUpType = PowerUps::Pick(RandomBelow(rng.Next(), PowerUps::COUNT));
+        powerUpSpawnTimer = 0;
+    }
+}
@@ -1,4 +1,7 @@
 #include "SoundManager.h"
+#include "AllocProfiler.h"
+#include "FrameProfiler.h"
+#include "Tracer.h"
 #include <cmath>
 #include <cstdlib>
 
@@ -126,24 +129,32 @@ void SoundManager::GenerateBackgroundMusic() {
 }
 
 void SoundManager::PlayEatSound() {
+    PROFILE_ALLOCS(ALLOC_SOUND);
+    TRACE_INSTANT("PlayEatSound");
     if (!isMuted) {
         PlaySound(eatSound);
     }
 }
 
 void SoundManager::PlayGameOverSound() {
+    PROFILE_ALLOCS(ALLOC_SOUND);
+    TRACE_INSTANT("PlayGameOverSound");
     if (!isMuted) {
         PlaySound(gameOverSound);
     }
 }
 
 void SoundManager::PlayPowerUpSound() {
+    PROFILE_ALLOCS(ALLOC_SOUND);
+    TRACE_INSTANT("PlayPowerUpSound");
     if (!isMuted) {
         PlaySound(powerUpSound);
     }
 }
 
 void SoundManager::PlayBackgroundMusic() {
+    PROFILE_ALLOCS(ALLOC_SOUND);
+    TRACE_INSTANT("PlayBackgroundMusic");
     if (!isMuted) {
         PlayMusicStream(backgroundMusic);
     }
@@ -154,6 +165,8 @@ void SoundManager::StopBackgroundMusic() {
 }
 
 void SoundManager::UpdateMusic() {
+    PROFILE_SCOPE(PROFILE_MUSIC);
+    PROFILE_ALLOCS(ALLOC_SOUND);
     if (!isMuted) {
         UpdateMusicStream(backgroundMusic);
         
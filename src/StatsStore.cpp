@@ -0,0 +1,249 @@
+#include "StatsStore.h"
+#include <atomic>
+#include <cstring>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const uint32_t STATS_MAGIC = 0x534E4B53;  // "SNKS"
+static const uint32_t STATS_VERSION = 1;
+
+StatsStore::StatsStore() : file(&fallback), active(0), persistent(false) {
+#if defined(_WIN32)
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+#else
+    fd = -1;
+#endif
+    Initialize();
+}
+
+StatsStore::~StatsStore() {
+    Close();
+}
+
+// FNV-1a over everything in the slot after the checksum field
+uint32_t StatsStore::Checksum(const StatsSlot& slot) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&slot);
+    size_t begin = offsetof(StatsSlot, variantCount);
+    uint32_t hash = 2166136261u;
+    for (size_t i = begin; i < sizeof(StatsSlot); i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    hash = (hash ^ (uint32_t)slot.sequence) * 16777619u;
+    return (hash ^ (uint32_t)(slot.sequence >> 32)) * 16777619u;
+}
+
+void StatsStore::Initialize() {
+    std::memset(file, 0, sizeof(StatsFile));
+    file->magic = STATS_MAGIC;
+    file->version = STATS_VERSION;
+    file->slots[0].checksum = Checksum(file->slots[0]);
+    active = 0;
+}
+
+int StatsStore::FindNewestSlot() const {
+    int newest = -1;
+    for (int i = 0; i < 2; i++) {
+        const StatsSlot& slot = file->slots[i];
+        if (slot.checksum != Checksum(slot) || slot.variantCount > (uint32_t)STATS_MAX_VARIANTS) continue;
+        if (newest < 0 || slot.sequence > file->slots[newest].sequence) newest = i;
+    }
+    return newest;
+}
+
+bool StatsStore::Open(const char* path) {
+    Close();
+    if (!Map(path)) {
+        file = &fallback;
+        Initialize();
+        return false;
+    }
+    persistent = true;
+
+    Lock();
+    int newest = file->magic == STATS_MAGIC && file->version == STATS_VERSION ? FindNewestSlot() : -1;
+    if (newest < 0) {
+        Initialize();
+    } else {
+        active = newest;
+    }
+    Unlock();
+    return true;
+}
+
+void StatsStore::Close() {
+    if (!persistent) return;
+    Unmap();
+    persistent = false;
+    file = &fallback;
+    Initialize();
+}
+
+#if defined(_WIN32)
+
+bool StatsStore::Map(const char* path) {
+    // Shared for writing too: every running game maps the same file
+    HANDLE handle = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                                OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) return false;
+
+    // Mapping a larger size than the file grows it, zero-filled
+    HANDLE mapping = CreateFileMappingA(handle, nullptr, PAGE_READWRITE, 0, (DWORD)sizeof(StatsFile), nullptr);
+    if (!mapping) {
+        CloseHandle(handle);
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(StatsFile));
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(handle);
+        return false;
+    }
+
+    fileHandle = handle;
+    mappingHandle = mapping;
+    file = static_cast<StatsFile*>(view);
+    return true;
+}
+
+void StatsStore::Unmap() {
+    FlushViewOfFile(file, sizeof(StatsFile));
+    UnmapViewOfFile(file);
+    CloseHandle((HANDLE)mappingHandle);
+    CloseHandle((HANDLE)fileHandle);
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+}
+
+void StatsStore::Lock() {
+    if (!persistent) return;
+    OVERLAPPED overlapped = {};
+    LockFileEx((HANDLE)fileHandle, LOCKFILE_EXCLUSIVE_LOCK, 0, (DWORD)sizeof(StatsFile), 0, &overlapped);
+}
+
+void StatsStore::Unlock() {
+    if (!persistent) return;
+    OVERLAPPED overlapped = {};
+    UnlockFileEx((HANDLE)fileHandle, 0, (DWORD)sizeof(StatsFile), 0, &overlapped);
+}
+
+#else
+
+bool StatsStore::Map(const char* path) {
+    int handle = open(path, O_RDWR | O_CREAT, 0644);
+    if (handle < 0) return false;
+
+    struct stat info;
+    if (fstat(handle, &info) != 0 ||
+        ((size_t)info.st_size < sizeof(StatsFile) && ftruncate(handle, sizeof(StatsFile)) != 0)) {
+        close(handle);
+        return false;
+    }
+
+    void* view = mmap(nullptr, sizeof(StatsFile), PROT_READ | PROT_WRITE, MAP_SHARED, handle, 0);
+    if (view == MAP_FAILED) {
+        close(handle);
+        return false;
+    }
+
+    fd = handle;
+    file = static_cast<StatsFile*>(view);
+    return true;
+}
+
+void StatsStore::Unmap() {
+    msync(file, sizeof(StatsFile), MS_SYNC);
+    munmap(file, sizeof(StatsFile));
+    close(fd);
+    fd = -1;
+}
+
+void StatsStore::Lock() {
+    if (persistent) flock(fd, LOCK_EX);
+}
+
+void StatsStore::Unlock() {
+    if (persistent) flock(fd, LOCK_UN);
+}
+
+#endif
+
+int StatsStore::FindVariant(const char* name) const {
+    const StatsSlot& slot = file->slots[active];
+    for (uint32_t i = 0; i < slot.variantCount; i++) {
+        if (std::strncmp(slot.variants[i].name, name, STATS_NAME_LENGTH) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+void StatsStore::RecordGame(const char* variant, int score) {
+    Lock();
+
+    // Another game may have written since our last look
+    int newest = FindNewestSlot();
+    if (newest >= 0) active = newest;
+
+    const StatsSlot& current = file->slots[active];
+    StatsSlot& next = file->slots[active ^ 1];
+    next = current;
+
+    int index = FindVariant(variant);
+    if (index < 0) {
+        if (next.variantCount == (uint32_t)STATS_MAX_VARIANTS) {
+            Unlock();
+            return;
+        }
+        index = (int)next.variantCount++;
+        StatsVariant& added = next.variants[index];
+        std::memset(&added, 0, sizeof(added));
+        std::strncpy(added.name, variant, STATS_NAME_LENGTH - 1);
+    }
+
+    StatsVariant& stats = next.variants[index];
+    if (score > stats.highScore) stats.highScore = score;
+    stats.gamesPlayed++;
+    stats.totalScore += (uint64_t)(score > 0 ? score : 0);
+
+    int bucket = score / STATS_HISTOGRAM_WIDTH;
+    if (bucket < 0) bucket = 0;
+    if (bucket >= STATS_HISTOGRAM_BUCKETS) bucket = STATS_HISTOGRAM_BUCKETS - 1;
+    stats.scoreHistogram[bucket]++;
+
+    next.sequence = current.sequence + 1;
+    uint32_t checksum = Checksum(next);
+    std::atomic_thread_fence(std::memory_order_release);  // data before checksum
+    next.checksum = checksum;
+    active ^= 1;
+
+    // Schedules write-back and returns at once
+    if (persistent) {
+#if defined(_WIN32)
+        FlushViewOfFile(file, sizeof(StatsFile));
+#else
+        msync(file, sizeof(StatsFile), MS_ASYNC);
+#endif
+    }
+    Unlock();
+}
+
+int StatsStore::GetHighScore(const char* variant) const {
+    const StatsVariant* stats = GetVariant(variant);
+    return stats ? stats->highScore : 0;
+}
+
+const StatsVariant* StatsStore::GetVariant(const char* variant) const {
+    int index = FindVariant(variant);
+    return index < 0 ? nullptr : &file->slots[active].variants[index];
+}
@@ -0,0 +1,167 @@
+#include "ThreadPool.h"
+#include "CpuTopology.h"
+
+static thread_local int currentWorker = -1;
+
+// The last decrement happens under the mutex: once Wait() can see zero it
+// may destroy the group, so nothing may touch it after the lock is released
+void TaskGroup::Finish() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        done.notify_all();
+    }
+}
+
+void TaskGroup::Wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return IsDone(); });
+}
+
+ThreadPool::ThreadPool(int threadCount, bool pinThreads)
+    : pinThreads(pinThreads), queued(0), stopping(false), nextQueue(0), steals(0) {
+    if (threadCount < 1) threadCount = 1;
+    for (int i = 0; i < threadCount; i++) {
+        queues.emplace_back(new WorkerQueue());
+    }
+
+    const CpuTopology& topology = CpuTopology::Get();
+    std::vector<int> cpus;
+    for (int i = 0; i < threadCount; i++) {
+        int node = 0;
+        int cpu = topology.CpuForWorker(i, node);
+        cpus.push_back(cpu);
+        workerNodes.push_back(pinThreads ? node : 0);
+
+        // Node ids can be sparse; queues are grouped by first appearance
+        int index = 0;
+        while (index < (int)nodeWorkers.size() && workerNodes[nodeWorkers[index][0]] != workerNodes[i]) index++;
+        if (index == (int)nodeWorkers.size()) nodeWorkers.emplace_back();
+        nodeWorkers[index].push_back(i);
+        workerNodeIndex.push_back(index);
+    }
+    nodeQueued.reset(new std::atomic<int>[nodeWorkers.size()]);
+    for (size_t node = 0; node < nodeWorkers.size(); node++) {
+        nodeQueued[node].store(0);
+    }
+    for (int i = 0; i < threadCount; i++) {
+        workers.emplace_back(&ThreadPool::WorkerLoop, this, i, pinThreads ? cpus[i] : -1);
+    }
+}
+
+int ThreadPool::CurrentWorker() {
+    return currentWorker;
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+bool ThreadPool::PopLocal(int index, Task& task) {
+    WorkerQueue& queue = *queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) return false;
+    task = queue.tasks.back();
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::StealFrom(int victim, int thief, Task& task) {
+    WorkerQueue& queue = *queues[victim];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) return false;
+    const Task& front = queue.tasks.front();
+    if (front.node >= 0 && front.node != workerNodeIndex[thief]) return false;
+    task = front;
+    queue.tasks.pop_front();
+    steals.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+// Workers on the thief's own node first, so node-bound work balances
+// inside its node before any thief looks across the interconnect
+bool ThreadPool::Steal(int thief, Task& task) {
+    int count = (int)queues.size();
+    for (int pass = 0; pass < 2; pass++) {
+        for (int offset = 1; offset < count; offset++) {
+            int victim = (thief + offset) % count;
+            bool sameNode = workerNodeIndex[victim] == workerNodeIndex[thief];
+            if (sameNode == (pass == 0) && StealFrom(victim, thief, task)) return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::WorkerLoop(int index, int cpu) {
+    currentWorker = index;
+    if (cpu >= 0) {
+        CpuTopology::PinCurrentThread(cpu);
+    }
+
+    while (true) {
+        Task task;
+        if (PopLocal(index, task) || Steal(index, task)) {
+            Counter(task.node).fetch_sub(1, std::memory_order_relaxed);
+            task.run(task.context, task.begin, task.end);
+            task.group->Finish();
+            continue;
+        }
+
+        // Work bound to another node is no reason to wake up
+        std::atomic<int>& local = nodeQueued[workerNodeIndex[index]];
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this, &local] { return stopping || queued.load() > 0 || local.load() > 0; });
+        if (stopping && queued.load() == 0 && local.load() == 0) return;
+    }
+}
+
+void ThreadPool::Push(int worker, const Task& task) {
+    WorkerQueue& queue = *queues[worker];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(task);
+    }
+    Counter(task.node).fetch_add(1, std::memory_order_release);
+}
+
+void ThreadPool::ParallelFor(TaskGroup& group, int count, int chunk,
+                             void (*run)(void* context, int begin, int end), void* context) {
+    if (chunk < 1) chunk = 1;
+    int tasks = (count + chunk - 1) / chunk;
+    if (tasks == 0) return;
+
+    group.Add(tasks);
+    int queueCount = (int)queues.size();
+    for (int begin = 0; begin < count; begin += chunk) {
+        int end = begin + chunk < count ? begin + chunk : count;
+        Push(nextQueue.fetch_add(1, std::memory_order_relaxed) % queueCount, {run, context, begin, end, &group, -1});
+    }
+
+    // Taking the lock orders the wake-up after any worker's predicate check
+    { std::lock_guard<std::mutex> lock(sleepMutex); }
+    wake.notify_all();
+}
+
+void ThreadPool::ParallelForNode(TaskGroup& group, int node, int count, int chunk,
+                                 void (*run)(void* context, int begin, int end), void* context) {
+    if (chunk < 1) chunk = 1;
+    int tasks = (count + chunk - 1) / chunk;
+    if (tasks == 0) return;
+
+    group.Add(tasks);
+    const std::vector<int>& local = nodeWorkers[node];
+    int k = 0;
+    for (int begin = 0; begin < count; begin += chunk, k++) {
+        int end = begin + chunk < count ? begin + chunk : count;
+        Push(local[k % local.size()], {run, context, begin, end, &group, node});
+    }
+
+    { std::lock_guard<std::mutex> lock(sleepMutex); }
+    wake.notify_all();
+}
@@ -0,0 +1,435 @@
+#include "TickServer.h"
+#include <chrono>
+#include <cstring>
+
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
+
+static const int RECEIVE_BATCH = 64;
+static const int SEND_BATCH = 1024;    // UIO_MAXIOV
+static const int MAX_CATCH_UP_TICKS = 5;
+
+// Worst case for one full keyframe: every slot alive at full length, and
+// each part wasting up to one snake of space at its end. Bounds are loose
+// (every varint at its widest).
+static int KeyframeParts(const TickServerConfig& config) {
+    size_t snakeBytes = 16 + (WORLD_MAX_LENGTH + 2) / 4;
+    size_t usable = TICK_MAX_DATAGRAM - 32 - config.foodCount * 3 - snakeBytes;
+    size_t total = (size_t)config.maxSessions * snakeBytes;
+    int parts = (int)((total + usable - 1) / usable) + 1;
+    return parts < 255 ? parts : 255;
+}
+
+#if defined(__linux__)
+
+struct TickServer::IoState {
+    std::vector<sockaddr_in> addresses;   // per session
+    std::vector<mmsghdr> sendHeaders;
+    std::vector<iovec> sendVectors;
+    int sendCount;
+
+    mmsghdr receiveHeaders[RECEIVE_BATCH];
+    iovec receiveVectors[RECEIVE_BATCH];
+    sockaddr_in receiveAddresses[RECEIVE_BATCH];
+    TickClientMessage receiveBuffers[RECEIVE_BATCH];
+};
+
+#else
+
+struct TickServer::IoState {
+};
+
+#endif
+
+TickServer::TickServer(const TickServerConfig& config)
+    : config(config),
+      world(config.width, config.height, config.maxSessions, config.foodCount,
+            (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count()),
+      encoder(config.maxSessions), sessions(config.maxSessions), poolMessages(1 + KeyframeParts(config)),
+      io(new IoState()), socketFd(-1), epollFd(-1), timerFd(-1), boundPort(0), tokenState(0), cookieKey(0) {
+    pool.resize((size_t)poolMessages * TICK_MAX_DATAGRAM);
+    for (Session& session : sessions) {
+        std::memset(&session, 0, sizeof(session));
+    }
+    tokenState = (uint32_t)std::chrono::system_clock::now().time_since_epoch().count() | 1;
+    uint64_t keySeed = (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count() ^ tokenState;
+    cookieKey = SplitMix64(keySeed);
+
+#if defined(__linux__)
+    // Every session can get the delta and a full keyframe in the same tick
+    size_t maxSends = (size_t)config.maxSessions * poolMessages;
+    io->addresses.resize(config.maxSessions);
+    io->sendHeaders.resize(maxSends);
+    io->sendVectors.resize(maxSends);
+    io->sendCount = 0;
+    for (int i = 0; i < RECEIVE_BATCH; i++) {
+        io->receiveVectors[i].iov_base = &io->receiveBuffers[i];
+        io->receiveVectors[i].iov_len = sizeof(TickClientMessage);
+    }
+#endif
+}
+
+TickServer::~TickServer() {
+    Close();
+}
+
+#if defined(__linux__)
+
+bool TickServer::Open() {
+    socketFd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+    if (socketFd < 0) return false;
+
+    // A tick goes out as one burst; let it queue rather than drop
+    int bufferBytes = 8 << 20;
+    setsockopt(socketFd, SOL_SOCKET, SO_SNDBUF, &bufferBytes, sizeof(bufferBytes));
+    setsockopt(socketFd, SOL_SOCKET, SO_RCVBUF, &bufferBytes, sizeof(bufferBytes));
+
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(config.port);
+    socklen_t length = sizeof(address);
+    if (bind(socketFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        getsockname(socketFd, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        Close();
+        return false;
+    }
+    boundPort = ntohs(address.sin_port);
+
+    timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+    epollFd = epoll_create1(0);
+    if (timerFd < 0 || epollFd < 0) {
+        Close();
+        return false;
+    }
+
+    long interval = 1000000000L / (config.tickRate > 0 ? config.tickRate : 1);
+    itimerspec spec;
+    spec.it_interval.tv_sec = interval / 1000000000L;
+    spec.it_interval.tv_nsec = interval % 1000000000L;
+    spec.it_value = spec.it_interval;
+    timerfd_settime(timerFd, 0, &spec, nullptr);
+
+    epoll_event event;
+    event.events = EPOLLIN;
+    event.data.fd = socketFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, socketFd, &event);
+    event.data.fd = timerFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, timerFd, &event);
+    return true;
+}
+
+void TickServer::Close() {
+    if (epollFd >= 0) close(epollFd);
+    if (timerFd >= 0) close(timerFd);
+    if (socketFd >= 0) close(socketFd);
+    epollFd = timerFd = socketFd = -1;
+}
+
+void TickServer::Poll(int timeoutMs) {
+    if (epollFd < 0) return;
+
+    epoll_event events[2];
+    int ready = epoll_wait(epollFd, events, 2, timeoutMs);
+    for (int i = 0; i < ready; i++) {
+        if (events[i].data.fd == socketFd) {
+            Receive();
+        } else if (events[i].data.fd == timerFd) {
+            uint64_t expirations = 0;
+            if (read(timerFd, &expirations, sizeof(expirations)) != (ssize_t)sizeof(expirations)) continue;
+            // After a stall, catch up a little but do not spiral
+            int due = expirations < (uint64_t)MAX_CATCH_UP_TICKS ? (int)expirations : MAX_CATCH_UP_TICKS;
+            for (int t = 0; t < due; t++) {
+                Tick();
+            }
+        }
+    }
+}
+
+void TickServer::Receive() {
+    for (;;) {
+        for (int i = 0; i < RECEIVE_BATCH; i++) {
+            mmsghdr& header = io->receiveHeaders[i];
+            std::memset(&header, 0, sizeof(header));
+            header.msg_hdr.msg_name = &io->receiveAddresses[i];
+            header.msg_hdr.msg_namelen = sizeof(sockaddr_in);
+            header.msg_hdr.msg_iov = &io->receiveVectors[i];
+            header.msg_hdr.msg_iovlen = 1;
+        }
+
+        int received = recvmmsg(socketFd, io->receiveHeaders, RECEIVE_BATCH, MSG_DONTWAIT, nullptr);
+        if (received <= 0) break;
+        stats.datagramsIn += received;
+
+        for (int i = 0; i < received; i++) {
+            const TickClientMessage& message = io->receiveBuffers[i];
+            if (io->receiveHeaders[i].msg_len != sizeof(TickClientMessage) || message.magic != TICK_MAGIC) continue;
+            const sockaddr_in& from = io->receiveAddresses[i];
+            Handle(message, from.sin_addr.s_addr, from.sin_port);
+        }
+
+        if (received < RECEIVE_BATCH) break;
+    }
+}
+
+void TickServer::QueueSend(int session, const uint8_t* data, size_t size) {
+    if (io->sendCount == (int)io->sendHeaders.size()) return;
+
+    int index = io->sendCount++;
+    iovec& vector = io->sendVectors[index];
+    vector.iov_base = const_cast<uint8_t*>(data);
+    vector.iov_len = size;
+
+    mmsghdr& header = io->sendHeaders[index];
+    std::memset(&header, 0, sizeof(header));
+    header.msg_hdr.msg_name = &io->addresses[session];
+    header.msg_hdr.msg_namelen = sizeof(sockaddr_in);
+    header.msg_hdr.msg_iov = &vector;
+    header.msg_hdr.msg_iovlen = 1;
+}
+
+void TickServer::FlushSends() {
+    int sent = 0;
+    while (sent < io->sendCount) {
+        int batch = io->sendCount - sent < SEND_BATCH ? io->sendCount - sent : SEND_BATCH;
+        int result = sendmmsg(socketFd, io->sendHeaders.data() + sent, batch, MSG_DONTWAIT);
+        if (result <= 0) {
+            // Socket buffer full: state is resent every tick anyway
+            stats.sendDrops += io->sendCount - sent;
+            break;
+        }
+        for (int i = 0; i < result; i++) {
+            stats.bytesOut += io->sendHeaders[sent + i].msg_len;
+        }
+        stats.datagramsOut += result;
+        sent += result;
+    }
+    io->sendCount = 0;
+}
+
+// Keyed hash of the source address; never 0, the token of a first JOIN
+uint32_t TickServer::Cookie(uint32_t address, uint16_t port) const {
+    uint64_t state = cookieKey ^ ((uint64_t)address << 16 | port);
+    return (uint32_t)SplitMix64(state) | 1;
+}
+
+void TickServer::SendWelcome(uint8_t type, int id, uint32_t token, uint32_t address, uint16_t port) {
+    TickWelcome welcome;
+    std::memset(&welcome, 0, sizeof(welcome));
+    welcome.magic = TICK_MAGIC;
+    welcome.type = type;
+    welcome.snakeId = (uint16_t)(id >= 0 ? id : 0);
+    welcome.tickRate = (uint16_t)config.tickRate;
+    welcome.width = (uint16_t)config.width;
+    welcome.height = (uint16_t)config.height;
+    welcome.token = token;
+
+    sockaddr_in target;
+    std::memset(&target, 0, sizeof(target));
+    target.sin_family = AF_INET;
+    target.sin_addr.s_addr = address;
+    target.sin_port = port;
+    if (sendto(socketFd, &welcome, sizeof(welcome), MSG_DONTWAIT,
+               reinterpret_cast<sockaddr*>(&target), sizeof(target)) == (ssize_t)sizeof(welcome)) {
+        stats.datagramsOut++;
+        stats.bytesOut += sizeof(welcome);
+    }
+}
+
+void TickServer::Join(uint32_t address, uint16_t port, uint32_t token) {
+    // Only a sender that can receive at its address learns the cookie
+    if (token != Cookie(address, port)) {
+        SendWelcome(TICK_CHALLENGE, -1, Cookie(address, port), address, port);
+        stats.challenges++;
+        return;
+    }
+
+    // A retransmitted JOIN gets the same session back
+    int id = -1;
+    for (int i = 0; i < (int)sessions.size(); i++) {
+        if (sessions[i].active && sessions[i].address == address && sessions[i].port == port) {
+            id = i;
+            break;
+        }
+    }
+
+    if (id < 0) {
+        id = world.AddSnake();
+        if (id >= 0) {
+            Session& session = sessions[id];
+            std::memset(&session, 0, sizeof(session));
+            session.active = true;
+            session.address = address;
+            session.port = port;
+            tokenState ^= tokenState << 13;
+            tokenState ^= tokenState >> 17;
+            tokenState ^= tokenState << 5;
+            session.token = tokenState;
+            session.lastHeard = world.GetTick();
+            session.needsKeyframe = true;
+
+            sockaddr_in& target = io->addresses[id];
+            std::memset(&target, 0, sizeof(target));
+            target.sin_family = AF_INET;
+            target.sin_addr.s_addr = address;
+            target.sin_port = port;
+            stats.joins++;
+        }
+    }
+
+    if (id >= 0) {
+        SendWelcome(TICK_WELCOME, id, sessions[id].token, address, port);
+    } else {
+        SendWelcome(TICK_FULL, -1, 0, address, port);
+    }
+}
+
+#else
+
+bool TickServer::Open() {
+    return false;
+}
+
+void TickServer::Close() {
+}
+
+void TickServer::Poll(int) {
+}
+
+void TickServer::Receive() {
+}
+
+void TickServer::QueueSend(int, const uint8_t*, size_t) {
+}
+
+void TickServer::FlushSends() {
+}
+
+uint32_t TickServer::Cookie(uint32_t, uint16_t) const {
+    return 1;
+}
+
+void TickServer::SendWelcome(uint8_t, int, uint32_t, uint32_t, uint16_t) {
+}
+
+void TickServer::Join(uint32_t, uint16_t, uint32_t) {
+}
+
+#endif
+
+void TickServer::Handle(const TickClientMessage& message, uint32_t address, uint16_t port) {
+    if (message.type == TICK_JOIN) {
+        Join(address, port, message.token);
+        return;
+    }
+
+    // Everything else must come from the session's own address with its token
+    int id = message.snakeId;
+    if (id >= (int)sessions.size()) return;
+    Session& session = sessions[id];
+    if (!session.active || session.token != message.token ||
+        session.address != address || session.port != port) return;
+
+    session.lastHeard = world.GetTick();
+    if (message.type == TICK_LEAVE) {
+        EndSession(id);
+        return;
+    }
+    if (message.type != TICK_INPUT) return;
+
+    if (message.flags & TICK_NEED_KEYFRAME) session.needsKeyframe = true;
+
+    // The batch repeats recent directions; queue only the ones not seen yet
+    int count = message.count < TICK_INPUT_BATCH ? message.count : TICK_INPUT_BATCH;
+    uint32_t first = message.lastSequence - (uint32_t)count + 1;
+    for (int i = 0; i < count; i++) {
+        uint32_t sequence = first + (uint32_t)i;
+        if ((int32_t)(sequence - session.lastSequence) <= 0) continue;
+
+        if (session.queueCount == TICK_INPUT_BATCH) {
+            session.queueHead = (session.queueHead + 1) % TICK_INPUT_BATCH;
+            session.queueCount--;
+        }
+        session.queue[(session.queueHead + session.queueCount) % TICK_INPUT_BATCH] = message.directions[i] & 3;
+        session.queueCount++;
+        session.lastSequence = sequence;
+    }
+}
+
+void TickServer::EndSession(int id) {
+    world.RemoveSnake(id);
+    sessions[id].active = false;
+}
+
+void TickServer::Tick() {
+    auto start = std::chrono::steady_clock::now();
+
+    uint64_t now = world.GetTick();
+    bool keyframeWanted = false;
+    for (int id = 0; id < (int)sessions.size(); id++) {
+        Session& session = sessions[id];
+        if (!session.active) continue;
+        if (now - session.lastHeard > (uint64_t)config.timeoutTicks) {
+            EndSession(id);
+            stats.timeouts++;
+            continue;
+        }
+        // One turn per tick, like the single-player input buffer
+        if (session.queueCount > 0) {
+            world.SetDirection(id, (Direction)session.queue[session.queueHead]);
+            session.queueHead = (session.queueHead + 1) % TICK_INPUT_BATCH;
+            session.queueCount--;
+        }
+        keyframeWanted |= session.needsKeyframe;
+    }
+
+    world.Step();
+
+    size_t deltaSize = encoder.EncodeDelta(world, PoolMessage(0), TICK_MAX_DATAGRAM);
+    if (deltaSize == 0) {
+        // Too much changed for one datagram: everyone starts over from a keyframe
+        for (Session& session : sessions) {
+            session.needsKeyframe = session.active;
+        }
+        keyframeWanted = true;
+    }
+    int keyframeParts = 0;
+    size_t keyframeSizes[256];
+    if (keyframeWanted) {
+        int nextSnake = 0;
+        while (keyframeParts < poolMessages - 1) {
+            size_t size = EncodeWorldKeyframe(world, nextSnake, (uint8_t)keyframeParts,
+                                              PoolMessage(1 + keyframeParts), TICK_MAX_DATAGRAM);
+            if (size == 0) break;
+            keyframeSizes[keyframeParts++] = size;
+            if (nextSnake >= world.GetMaxSnakes()) break;
+        }
+    }
+
+    for (int id = 0; id < (int)sessions.size(); id++) {
+        Session& session = sessions[id];
+        if (!session.active) continue;
+        if (deltaSize > 0) QueueSend(id, PoolMessage(0), deltaSize);
+        if (session.needsKeyframe && keyframeParts > 0) {
+            for (int part = 0; part < keyframeParts; part++) {
+                QueueSend(id, PoolMessage(1 + part), keyframeSizes[part]);
+            }
+            session.needsKeyframe = false;
+            stats.keyframeSends++;
+        }
+    }
+    FlushSends();
+
+    uint64_t elapsed = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    stats.ticks++;
+    stats.tickNanos += elapsed;
+    if (elapsed > stats.maxTickNanos) stats.maxTickNanos = elapsed;
+}
@@ -0,0 +1,122 @@
+#include "Tracer.h"
+#include <chrono>
+
+static thread_local TraceBuffer* threadBuffer = nullptr;
+
+Tracer::Tracer()
+    : active(false), file(nullptr), firstEvent(true), startTime(0), stopping(false) {}
+
+Tracer::~Tracer() {
+    Stop();
+}
+
+Tracer& Tracer::Get() {
+    static Tracer tracer;
+    return tracer;
+}
+
+uint64_t Tracer::Now() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Written in the JSON array format, which the trace viewers accept without
+// the closing bracket - a kiosk that crashes still leaves a loadable file
+bool Tracer::Start(const char* path) {
+    if (file) return false;
+
+    file = std::fopen(path, "w");
+    if (!file) return false;
+
+    std::fputs("[\n", file);
+    firstEvent = true;
+    startTime = Now();
+    stopping = false;
+    flusher = std::thread(&Tracer::FlushLoop, this);
+    active.store(true, std::memory_order_release);
+    return true;
+}
+
+void Tracer::Stop() {
+    if (!file) return;
+
+    active.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(flushMutex);
+        stopping = true;
+    }
+    flushWake.notify_one();
+    flusher.join();
+
+    Flush();
+
+    uint32_t dropped = 0;
+    for (const auto& buffer : buffers) {
+        dropped += buffer->GetDropped();
+    }
+    if (dropped > 0) {
+        std::fprintf(file, "%s{\"name\":\"dropped_events\",\"ph\":\"M\",\"pid\":1,\"args\":{\"count\":%u}}",
+                     firstEvent ? "" : ",\n", dropped);
+    }
+    std::fputs("\n]\n", file);
+    std::fclose(file);
+    file = nullptr;
+}
+
+TraceBuffer* Tracer::RegisterThread() {
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    buffers.emplace_back(new TraceBuffer((int)buffers.size()));
+    return buffers.back().get();
+}
+
+void Tracer::Record(const char* name, uint64_t start, uint64_t duration) {
+    if (!threadBuffer) {
+        threadBuffer = RegisterThread();
+    }
+    threadBuffer->Push({name, start, duration});
+}
+
+void Tracer::SetThreadName(const char* name) {
+    if (!threadBuffer) {
+        threadBuffer = RegisterThread();
+    }
+    threadBuffer->SetName(name);
+}
+
+void Tracer::FlushLoop() {
+    std::unique_lock<std::mutex> lock(flushMutex);
+    while (!stopping) {
+        flushWake.wait_for(lock, std::chrono::milliseconds(100));
+        lock.unlock();
+        Flush();
+        lock.lock();
+    }
+}
+
+void Tracer::Flush() {
+    std::lock_guard<std::mutex> lock(buffersMutex);
+
+    for (const auto& buffer : buffers) {
+        int tid = buffer->GetThreadId();
+
+        if (const char* name = buffer->TakeNewName()) {
+            std::fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                         firstEvent ? "" : ",\n", tid, name);
+            firstEvent = false;
+        }
+
+        buffer->Drain([&](const TraceEvent& event) {
+            double ts = (double)(int64_t)(event.start - startTime) / 1000.0;
+            const char* separator = firstEvent ? "" : ",\n";
+            if (event.duration == INSTANT) {
+                std::fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":1,\"tid\":%d}",
+                             separator, event.name, ts, tid);
+            } else {
+                std::fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}",
+                             separator, event.name, ts, event.duration / 1000.0, tid);
+            }
+            firstEvent = false;
+        });
+    }
+    std::fflush(file);
+}
@@ -0,0 +1,574 @@
+#include "WorldView.h"
+#include "ReplayFile.h"
+#include <cstring>
+
+// Bounded writer: past the end it only records the overflow, so encoders
+// can finish updating their baseline and fail once at the end
+struct ByteWriter {
+    uint8_t* cursor;
+    const uint8_t* end;
+    bool overflow;
+
+    ByteWriter(uint8_t* out, size_t capacity) : cursor(out), end(out + capacity), overflow(false) {}
+
+    void Byte(uint8_t value) {
+        if (cursor < end) {
+            *cursor++ = value;
+        } else {
+            overflow = true;
+        }
+    }
+
+    void Varint(uint64_t value) {
+        while (value >= 0x80) {
+            Byte((uint8_t)(value | 0x80));
+            value >>= 7;
+        }
+        Byte((uint8_t)value);
+    }
+
+    void Magic(uint8_t type) {
+        for (int i = 0; i < 4; i++) {
+            Byte((uint8_t)(TICK_MAGIC >> (i * 8)));
+        }
+        Byte(type);
+    }
+};
+
+static uint64_t ZigZag(int64_t value) {
+    return (uint64_t)(value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static int64_t UnZigZag(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+static bool ReadByte(const uint8_t*& cursor, const uint8_t* end, uint8_t& value) {
+    if (cursor >= end) return false;
+    value = *cursor++;
+    return true;
+}
+
+static bool ReadMagic(const uint8_t*& cursor, const uint8_t* end, uint8_t& type) {
+    uint32_t magic = 0;
+    for (int i = 0; i < 4; i++) {
+        uint8_t byte;
+        if (!ReadByte(cursor, end, byte)) return false;
+        magic |= (uint32_t)byte << (i * 8);
+    }
+    return magic == TICK_MAGIC && ReadByte(cursor, end, type);
+}
+
+// Cells travel as cell + 1 so that "none" is 0
+static uint64_t WireCell(int cell) {
+    return cell < 0 ? 0 : (uint64_t)cell + 1;
+}
+
+static uint16_t ViewCell(uint64_t wire) {
+    return wire == 0 ? TICK_NO_CELL : (uint16_t)(wire - 1);
+}
+
+static void WriteBody(ByteWriter& writer, const SnakeWorld& world, int id) {
+    const DynamicBoard& board = world.GetBoard();
+    int length = world.GetBodySize(id);
+    int previous = world.GetHeadCell(id);
+    writer.Varint((uint64_t)length);
+    writer.Varint((uint64_t)previous);
+
+    uint8_t packed = 0;
+    for (int i = 1; i < length; i++) {
+        int cell = world.GetBodyCell(id, i);
+        packed |= StepDirection(board, previous, cell) << (((i - 1) & 3) * 2);
+        if (((i - 1) & 3) == 3 || i == length - 1) {
+            writer.Byte(packed);
+            packed = 0;
+        }
+        previous = cell;
+    }
+}
+
+// Direction of a one-cell move, or false if 'to' is not next to 'from'.
+// Plain moves are a difference of 1 or width; only wraps need X/Y.
+static bool StepBetween(const DynamicBoard& board, int from, int to, uint8_t& dir) {
+    int step = to - from;
+    if (step == 1) dir = RIGHT;
+    else if (step == -1) dir = LEFT;
+    else if (step == board.Width()) dir = DOWN;
+    else if (step == -board.Width()) dir = UP;
+    else {
+        dir = StepDirection(board, from, to);
+        return StepCell(board, from, dir) == to;
+    }
+    return true;
+}
+
+bool ReadStateTick(const uint8_t* data, size_t size, uint32_t& tick) {
+    const uint8_t* cursor = data;
+    const uint8_t* end = data + size;
+    uint8_t type;
+    uint64_t value;
+    if (!ReadMagic(cursor, end, type) || (type != TICK_DELTA && type != TICK_KEYFRAME) ||
+        !ReadVarint(cursor, end, value)) return false;
+    tick = (uint32_t)value;
+    return true;
+}
+
+WorldDeltaEncoder::WorldDeltaEncoder(int maxSnakes)
+    : snakes(maxSnakes), powerUpCell(-1), powerUpType(0) {
+    for (SnakeBaseline& snake : snakes) {
+        snake.active = false;
+        snake.alive = false;
+        snake.head = -1;
+        snake.length = 0;
+        snake.score = 0;
+    }
+}
+
+size_t WorldDeltaEncoder::EncodeDelta(const SnakeWorld& world, uint8_t* out, size_t capacity) {
+    ByteWriter writer(out, capacity);
+    writer.Magic(TICK_DELTA);
+    writer.Varint((uint32_t)world.GetTick());
+
+    int foodCount = world.GetFoodCount();
+    if ((int)foodCells.size() != foodCount) foodCells.assign(foodCount, -1);
+    int foodChanges = 0;
+    for (int i = 0; i < foodCount; i++) {
+        foodChanges += foodCells[i] != world.GetFoodCell(i);
+    }
+    bool powerUpChanged = powerUpCell != world.GetPowerUpCell() || powerUpType != (int)world.GetPowerUpType();
+
+    writer.Byte((uint8_t)((foodChanges > 0 ? TICK_DIFF_FOOD : 0) | (powerUpChanged ? TICK_DIFF_POWERUP : 0)));
+    if (foodChanges > 0) {
+        writer.Varint((uint64_t)foodChanges);
+        int nextSlot = 0;
+        for (int i = 0; i < foodCount; i++) {
+            int cell = world.GetFoodCell(i);
+            if (foodCells[i] == cell) continue;
+            writer.Varint((uint64_t)(i - nextSlot));
+            writer.Varint(WireCell(cell));
+            foodCells[i] = cell;
+            nextSlot = i + 1;
+        }
+    }
+    if (powerUpChanged) {
+        powerUpCell = world.GetPowerUpCell();
+        powerUpType = (int)world.GetPowerUpType();
+        writer.Varint(WireCell(powerUpCell));
+        writer.Byte((uint8_t)powerUpType);
+    }
+
+    const DynamicBoard& board = world.GetBoard();
+    int previousId = 0;
+    auto record = [&writer, &previousId](int id, int op) {
+        writer.Varint((uint64_t)(id - previousId));
+        writer.Byte((uint8_t)op);
+        previousId = id;
+    };
+
+    for (int id = 0; id < (int)snakes.size(); id++) {
+        SnakeBaseline& base = snakes[id];
+        bool active = world.IsActive(id);
+        if (active != base.active) {
+            record(id, TICK_OP_SLOT | (active ? TICK_OP_ACTIVE : 0));
+            base.active = active;
+            base.alive = false;
+            base.length = 0;
+            if (!active) base.score = 0;
+        }
+        if (!active) continue;
+
+        bool alive = world.IsAlive(id);
+        int score = world.GetScore(id);
+        int scoreBit = score != base.score ? TICK_OP_SCORE : 0;
+
+        if (alive) {
+            int head = world.GetHeadCell(id);
+            int length = world.GetBodySize(id);
+            uint8_t dir = 0;
+            bool moved = base.alive && !world.WasSpawned(id) && StepBetween(board, base.head, head, dir) &&
+                         (length == base.length || length == base.length + 1);
+
+            if (moved) {
+                record(id, TICK_OP_MOVE | dir << TICK_OP_DIRECTION_SHIFT |
+                           (length == base.length ? TICK_OP_TAIL : 0) | scoreBit);
+                if (scoreBit) writer.Varint(ZigZag((int64_t)score - base.score));
+            } else {
+                // Spawned, or anything a single step cannot describe
+                record(id, TICK_OP_SPAWN | world.GetDirection(id) << TICK_OP_DIRECTION_SHIFT);
+                writer.Varint((uint32_t)score);
+                WriteBody(writer, world, id);
+            }
+            base.head = head;
+            base.length = length;
+        } else if (base.alive || scoreBit) {
+            record(id, TICK_OP_OFF | scoreBit);
+            if (scoreBit) writer.Varint(ZigZag((int64_t)score - base.score));
+            base.length = 0;
+        }
+        base.alive = alive;
+        base.score = score;
+    }
+
+    return writer.overflow ? 0 : (size_t)(writer.cursor - out);
+}
+
+size_t EncodeWorldKeyframe(const SnakeWorld& world, int& nextSnake, uint8_t part,
+                           uint8_t* out, size_t capacity) {
+    ByteWriter writer(out, capacity);
+    writer.Magic(TICK_KEYFRAME);
+    writer.Varint((uint32_t)world.GetTick());
+    writer.Byte(part);
+    uint8_t* flags = writer.cursor;
+    writer.Byte(0);
+    writer.Varint((uint64_t)world.GetBoard().Width());
+    writer.Varint((uint64_t)world.GetBoard().Height());
+    writer.Varint((uint64_t)world.GetFoodCount());
+    for (int i = 0; i < world.GetFoodCount(); i++) {
+        writer.Varint(WireCell(world.GetFoodCell(i)));
+    }
+    writer.Varint(WireCell(world.GetPowerUpCell()));
+    writer.Byte((uint8_t)world.GetPowerUpType());
+    if (writer.overflow) return 0;
+
+    int written = 0;
+    int previousId = 0;
+    int id = nextSnake;
+    for (; id < world.GetMaxSnakes(); id++) {
+        if (!world.IsActive(id)) continue;
+
+        uint8_t* recordStart = writer.cursor;
+        writer.Varint((uint64_t)(id - previousId));
+        int score = world.GetScore(id);
+        if (world.IsAlive(id)) {
+            writer.Byte((uint8_t)(TICK_OP_SPAWN | world.GetDirection(id) << TICK_OP_DIRECTION_SHIFT));
+            writer.Varint((uint32_t)score);
+            WriteBody(writer, world, id);
+        } else {
+            writer.Byte((uint8_t)(TICK_OP_OFF | TICK_OP_SCORE));
+            writer.Varint(ZigZag(score));
+        }
+        if (writer.overflow) {
+            writer.cursor = recordStart;
+            break;
+        }
+        previousId = id;
+        written++;
+    }
+
+    // Not even one snake fits: the caller's buffer is too small
+    if (written == 0 && id < world.GetMaxSnakes()) return 0;
+
+    nextSnake = id;
+    *flags = id >= world.GetMaxSnakes() ? TICK_LAST_PART : 0;
+    return (size_t)(writer.cursor - out);
+}
+
+WorldStreamWriter::WorldStreamWriter(int maxSnakes, uint32_t keyframeInterval)
+    : encoder(maxSnakes), keyframeInterval(keyframeInterval), scratch(TICK_MAX_DATAGRAM) {
+}
+
+void WorldStreamWriter::AppendFrame(std::vector<uint8_t>& out, size_t size) {
+    AppendVarint(out, size);
+    out.insert(out.end(), scratch.begin(), scratch.begin() + size);
+}
+
+void WorldStreamWriter::Append(const SnakeWorld& world, std::vector<uint8_t>& out) {
+    // Frames are not bound by a datagram: grow until the message fits
+    size_t size;
+    while ((size = encoder.EncodeDelta(world, scratch.data(), scratch.size())) == 0) {
+        scratch.resize(scratch.size() * 2);
+    }
+    AppendFrame(out, size);
+
+    if (keyframeInterval == 0 || world.GetTick() % keyframeInterval != 0) return;
+    for (;;) {
+        int nextSnake = 0;
+        size = EncodeWorldKeyframe(world, nextSnake, 0, scratch.data(), scratch.size());
+        if (size > 0 && nextSnake >= world.GetMaxSnakes()) break;
+        scratch.resize(scratch.size() * 2);
+    }
+    AppendFrame(out, size);
+}
+
+WorldView::WorldView(int maxSnakes)
+    : board(1, 1), maxSnakes(maxSnakes), snakes(maxSnakes + 1),
+      bodies((size_t)(maxSnakes + 1) * WORLD_MAX_LENGTH), powerUpCell(TICK_NO_CELL), powerUpType(SPEED_BOOST),
+      tick(0), synced(false), keyframeTick(0), expectedPart(-1), keyframeNextId(0),
+      keyframeCompare(false), keyframeDiffers(false), keyframeMismatches(0) {
+    for (int id = 0; id <= maxSnakes; id++) {
+        ClearSnake(id);
+    }
+}
+
+uint16_t& WorldView::BodyAt(int id, int i) {
+    int index = snakes[id].headIndex + i;
+    if (index >= WORLD_MAX_LENGTH) index -= WORLD_MAX_LENGTH;
+    return bodies[(size_t)id * WORLD_MAX_LENGTH + index];
+}
+
+int WorldView::GetBodyCell(int id, int i) const {
+    int index = snakes[id].headIndex + i;
+    if (index >= WORLD_MAX_LENGTH) index -= WORLD_MAX_LENGTH;
+    return bodies[(size_t)id * WORLD_MAX_LENGTH + index];
+}
+
+void WorldView::PushHead(int id, uint16_t cell) {
+    SnakeView& snake = snakes[id];
+    snake.headIndex = snake.headIndex == 0 ? WORLD_MAX_LENGTH - 1 : snake.headIndex - 1;
+    if (snake.length < WORLD_MAX_LENGTH) snake.length++;
+    BodyAt(id, 0) = cell;
+}
+
+void WorldView::ClearSnake(int id) {
+    SnakeView& snake = snakes[id];
+    snake.headIndex = 0;
+    snake.length = 0;
+    snake.score = 0;
+    snake.direction = RIGHT;
+    snake.active = false;
+    snake.alive = false;
+}
+
+// Shared by deltas and keyframes (which decode into the scratch slot)
+bool WorldView::ApplyRecord(int id, uint8_t op, const uint8_t*& cursor, const uint8_t* end) {
+    SnakeView& snake = snakes[id];
+    Direction dir = static_cast<Direction>((op >> TICK_OP_DIRECTION_SHIFT) & 3);
+    uint64_t value;
+
+    switch (op & TICK_OP_KIND) {
+        case TICK_OP_MOVE: {
+            if (!snake.alive || snake.length == 0) return false;
+            uint16_t head = (uint16_t)StepCell(board, BodyAt(id, 0), dir);
+            // Tail first, as in SnakeWorld::Step: at full length the ring
+            // slot it frees is the one the head takes
+            if (op & TICK_OP_TAIL) snake.length--;
+            PushHead(id, head);
+            snake.direction = dir;
+            break;
+        }
+        case TICK_OP_SPAWN: {
+            uint64_t length;
+            uint64_t head;
+            if (!ReadVarint(cursor, end, value) || !ReadVarint(cursor, end, length) ||
+                !ReadVarint(cursor, end, head) || length == 0 || length > (uint64_t)WORLD_MAX_LENGTH ||
+                head >= (uint64_t)board.Cells() || (uint64_t)(end - cursor) < (length + 2) / 4) return false;
+
+            uint16_t* body = &bodies[(size_t)id * WORLD_MAX_LENGTH];
+            body[0] = (uint16_t)head;
+            for (int i = 1; i < (int)length; i++) {
+                int shift = ((i - 1) & 3) * 2;
+                body[i] = (uint16_t)StepCell(board, body[i - 1], (uint8_t)((*cursor >> shift) & 3));
+                if (shift == 6 || i == (int)length - 1) cursor++;
+            }
+            snake.headIndex = 0;
+            snake.length = (int)length;
+            snake.score = (int)value;
+            snake.direction = dir;
+            snake.active = true;
+            snake.alive = true;
+            break;
+        }
+        case TICK_OP_OFF:
+            snake.active = true;
+            snake.alive = false;
+            snake.length = 0;
+            break;
+        default:
+            if (op & TICK_OP_ACTIVE) {
+                snake.active = true;
+                snake.alive = false;
+                snake.length = 0;
+            } else {
+                ClearSnake(id);
+            }
+            break;
+    }
+
+    if (op & TICK_OP_SCORE) {
+        if (!ReadVarint(cursor, end, value)) return false;
+        snake.score += (int)UnZigZag(value);
+    }
+    return true;
+}
+
+bool WorldView::ApplyDelta(const uint8_t* data, size_t size) {
+    const uint8_t* cursor = data;
+    const uint8_t* end = data + size;
+    uint8_t type;
+    uint64_t value;
+    if (!synced || !ReadMagic(cursor, end, type) || type != TICK_DELTA || !ReadVarint(cursor, end, value)) {
+        return false;
+    }
+    if ((uint32_t)value != tick + 1) {
+        synced = false;
+        return false;
+    }
+    expectedPart = -1;  // a keyframe in progress is now stale
+
+    uint8_t flags;
+    bool ok = ReadByte(cursor, end, flags);
+    if (ok && (flags & TICK_DIFF_FOOD)) {
+        uint64_t changes;
+        uint64_t slot = 0;
+        ok = ReadVarint(cursor, end, changes);
+        for (uint64_t c = 0; ok && c < changes; c++) {
+            uint64_t gap;
+            ok = ReadVarint(cursor, end, gap) && ReadVarint(cursor, end, value) &&
+                 (slot += gap) < foodCells.size() && value <= (uint64_t)board.Cells();
+            if (ok) foodCells[slot++] = ViewCell(value);
+        }
+    }
+    if (ok && (flags & TICK_DIFF_POWERUP)) {
+        uint8_t kind;
+        ok = ReadVarint(cursor, end, value) && ReadByte(cursor, end, kind) && value <= (uint64_t)board.Cells();
+        if (ok) {
+            powerUpCell = ViewCell(value);
+            powerUpType = static_cast<PowerUpType>(kind % POWERUP_TYPE_COUNT);
+        }
+    }
+
+    uint64_t id = 0;
+    while (ok && cursor < end) {
+        uint64_t gap;
+        uint8_t op;
+        ok = ReadVarint(cursor, end, gap) && (id += gap) < (uint64_t)maxSnakes && ReadByte(cursor, end, op) &&
+             ApplyRecord((int)id, op, cursor, end);
+    }
+
+    if (!ok) {
+        synced = false;
+        return false;
+    }
+    tick++;
+    return true;
+}
+
+bool WorldView::SnakesMatch(int a, int b) const {
+    const SnakeView& x = snakes[a];
+    const SnakeView& y = snakes[b];
+    if (x.active != y.active || x.alive != y.alive || x.score != y.score || x.length != y.length) return false;
+    for (int i = 0; i < x.length; i++) {
+        if (GetBodyCell(a, i) != GetBodyCell(b, i)) return false;
+    }
+    return true;
+}
+
+void WorldView::CopySnake(int from, int to) {
+    snakes[to] = snakes[from];
+    snakes[to].headIndex = 0;
+    for (int i = 0; i < snakes[from].length; i++) {
+        bodies[(size_t)to * WORLD_MAX_LENGTH + i] = (uint16_t)GetBodyCell(from, i);
+    }
+}
+
+void WorldView::EndKeyframe() {
+    for (; keyframeNextId < maxSnakes; keyframeNextId++) {
+        keyframeDiffers = keyframeDiffers || (keyframeCompare && snakes[keyframeNextId].active);
+        ClearSnake(keyframeNextId);
+    }
+    keyframeMismatches += keyframeDiffers;
+    tick = keyframeTick;
+    synced = true;
+    expectedPart = -1;
+}
+
+bool WorldView::ApplyKeyframe(const uint8_t* data, size_t size) {
+    const uint8_t* cursor = data;
+    const uint8_t* end = data + size;
+    uint8_t type;
+    uint8_t part;
+    uint8_t flags;
+    uint64_t frameTick;
+    uint64_t width;
+    uint64_t height;
+    uint64_t foodCount;
+    if (!ReadMagic(cursor, end, type) || type != TICK_KEYFRAME || !ReadVarint(cursor, end, frameTick) ||
+        !ReadByte(cursor, end, part) || !ReadByte(cursor, end, flags) || !ReadVarint(cursor, end, width) ||
+        !ReadVarint(cursor, end, height) || !ReadVarint(cursor, end, foodCount) || width == 0 || height == 0 ||
+        width * height > TICK_NO_CELL || foodCount > width * height) return false;
+
+    if (part == 0) {
+        keyframeTick = (uint32_t)frameTick;
+        expectedPart = 0;
+        keyframeNextId = 0;
+        keyframeCompare = synced && tick == keyframeTick;
+        keyframeDiffers = false;
+    }
+    if (part != expectedPart || (uint32_t)frameTick != keyframeTick) {
+        expectedPart = -1;
+        return false;
+    }
+    if ((int)width != board.Width() || (int)height != board.Height()) {
+        if (part != 0) {
+            expectedPart = -1;
+            return false;
+        }
+        board = DynamicBoard((int)width, (int)height);
+        keyframeCompare = false;
+    }
+
+    // Every part repeats food and power-up
+    foodCells.resize(foodCount);
+    uint64_t value;
+    for (uint64_t i = 0; i < foodCount; i++) {
+        if (!ReadVarint(cursor, end, value) || value > width * height) {
+            expectedPart = -1;
+            return false;
+        }
+        keyframeDiffers = keyframeDiffers || (keyframeCompare && foodCells[i] != ViewCell(value));
+        foodCells[i] = ViewCell(value);
+    }
+    uint8_t kind;
+    if (!ReadVarint(cursor, end, value) || !ReadByte(cursor, end, kind) || value > width * height) {
+        expectedPart = -1;
+        return false;
+    }
+    powerUpCell = ViewCell(value);
+    powerUpType = static_cast<PowerUpType>(kind % POWERUP_TYPE_COUNT);
+
+    // Each record is decoded into the scratch slot, checked against the
+    // view when it already had this tick, then copied over
+    uint64_t id = 0;
+    while (cursor < end) {
+        uint64_t gap;
+        uint8_t op;
+        ClearSnake(maxSnakes);
+        if (!ReadVarint(cursor, end, gap) || (id += gap) >= (uint64_t)maxSnakes || (int)id < keyframeNextId ||
+            !ReadByte(cursor, end, op) ||
+            ((op & TICK_OP_KIND) != TICK_OP_SPAWN && (op & TICK_OP_KIND) != TICK_OP_OFF) ||
+            !ApplyRecord(maxSnakes, op, cursor, end)) {
+            expectedPart = -1;
+            return false;
+        }
+
+        for (; keyframeNextId < (int)id; keyframeNextId++) {
+            keyframeDiffers = keyframeDiffers || (keyframeCompare && snakes[keyframeNextId].active);
+            ClearSnake(keyframeNextId);
+        }
+        keyframeNextId = (int)id + 1;
+
+        keyframeDiffers = keyframeDiffers || (keyframeCompare && !SnakesMatch((int)id, maxSnakes));
+        CopySnake(maxSnakes, (int)id);
+    }
+
+    expectedPart++;
+    if (flags & TICK_LAST_PART) EndKeyframe();
+    return true;
+}
+
+bool WorldView::ApplyFrame(const uint8_t*& cursor, const uint8_t* end) {
+    uint64_t size;
+    if (!ReadVarint(cursor, end, size) || size > (uint64_t)(end - cursor)) return false;
+    const uint8_t* frame = cursor;
+    cursor += size;
+
+    uint8_t type;
+    const uint8_t* peek = frame;
+    if (!ReadMagic(peek, frame + size, type)) return true;
+    if (type == TICK_KEYFRAME) {
+        ApplyKeyframe(frame, (size_t)size);
+    } else if (synced) {
+        ApplyDelta(frame, (size_t)size);
+    }
+    return true;
+}
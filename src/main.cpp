@@ -1,6 +1,29 @@
 #include "Game.h"
+#include "ReplayViewer.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char** argv) {
+#ifdef SNAKE_PROFILE_ALLOCS
+    // snake --soak [rounds]: exits 1 if a tick or restart reaches the heap
+    if (argc > 1 && std::strcmp(argv[1], "--soak") == 0) {
+        Game game(800, 600, "Snake Game - Allocation Soak");
+        return game.Soak(argc > 2 ? std::atoi(argv[2]) : 200, 5000) ? 0 : 1;
+    }
+#endif
+
+    // snake <replay.snkp> opens the replay viewer instead of a game
+    if (argc > 1) {
+        ReplayViewer viewer(800, 600, "Snake Game - Replay Viewer");
+        if (!viewer.Load(argv[1])) {
+            fprintf(stderr, "Cannot open replay '%s'\n", argv[1]);
+            return 1;
+        }
+        viewer.Run();
+        return 0;
+    }
 
-int main() {
     Game game(800, 600, "Snake Game - Step 4: Power-Ups & Sound!");
     game.Run();
     return 0;